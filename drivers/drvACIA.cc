@@ -44,17 +44,71 @@
   */
 //-------------------------------------------------------------------------
 
+#ifndef ETUDIANTS_TP
 DriverACIA::DriverACIA() {
   printf("**** Warning: contructor of the ACIA driver not implemented yet\n");
   exit(ERROR);
 }
+#endif
+#ifdef ETUDIANTS_TP
+DriverACIA::DriverACIA() {
+  ind_send = 0;
+  ind_rec = 0;
+  send_count = 0;
+  rec_count = 0;
+  send_busy = false;
+  send_waiting = false;
+  rec_overflows = 0;
+  send_lock = NULL;
+
+  if (g_cfg->ACIA == ACIA_INTERRUPT) {
+    // send_sema is only taken by a sender waiting for room in the
+    // emission ring, receive_sema counts the complete messages
+    // waiting in the reception ring.
+    send_sema = new Semaphore((char *) "ACIA send", 0);
+    receive_sema = new Semaphore((char *) "ACIA receive", 0);
+    send_lock = new Lock((char *) "ACIA send lock");
+    // Reception interrupts stay enabled so that bytes arriving while no
+    // thread is inside TtyReceive are kept in the ring.
+    g_machine->acia->SetWorkingMode(REC_INTERRUPT | SEND_INTERRUPT);
+  } else {
+    // In busy waiting mode the semaphores are simple mutexes.
+    send_sema = new Semaphore((char *) "ACIA send", 1);
+    receive_sema = new Semaphore((char *) "ACIA receive", 1);
+    g_machine->acia->SetWorkingMode(BUSY_WAITING);
+  }
+}
+#endif
+
+//-------------------------------------------------------------------------
+// DriverACIA::~DriverACIA()
+/*! Destructor. De-allocate the synchronization objects of the driver.
+ */
+//-------------------------------------------------------------------------
+
+DriverACIA::~DriverACIA() {
+  if (rec_overflows != 0)
+    DEBUG('d', (char *) "ACIA: %d bytes lost on reception ring overflow\n",
+          rec_overflows);
+  delete send_sema;
+  delete receive_sema;
+  delete send_lock;
+}
 
 //-------------------------------------------------------------------------
 // DriverACIA::TtySend(char* buff)
 /*! Routine to send a message through the ACIA (Busy Waiting or Interrupt mode)
+//
+//  In Interrupt mode the message (with its final '\0') is only copied
+//  into the emission ring: the emission interrupt handler transmits the
+//  bytes back-to-back, and the sender only sleeps when the ring is full.
+//
+//  \param buff is the '\0'-terminated message to send
+//  \return the number of characters of the message sent
  */
 //-------------------------------------------------------------------------
 
+#ifndef ETUDIANTS_TP
 int
 DriverACIA::TtySend(char *buff) {
   printf(
@@ -62,14 +116,61 @@ DriverACIA::TtySend(char *buff) {
   exit(ERROR);
   return 0;
 }
+#endif
+#ifdef ETUDIANTS_TP
+int
+DriverACIA::TtySend(char *buff) {
+  int len = strlen(buff);
+
+  if (g_cfg->ACIA == ACIA_BUSY_WAITING) {
+    send_sema->P();
+    for (int i = 0; i <= len; i++) {
+      while (g_machine->acia->GetOutputStateReg() == FULL)
+        ;
+      g_machine->acia->PutChar(buff[i]);
+    }
+    send_sema->V();
+    return len;
+  }
+
+  send_lock->Acquire();
+  IntStatus old_status = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+  for (int i = 0; i <= len; i++) {
+    while (send_count == BUFFER_SIZE) {
+      send_waiting = true;
+      send_sema->P();
+    }
+    send_buffer[(ind_send + send_count) % BUFFER_SIZE] = buff[i];
+    send_count++;
+    if (!send_busy) {
+      // The transmitter is idle: start it, InterruptSend keeps it busy.
+      send_busy = true;
+      g_machine->acia->PutChar(send_buffer[ind_send]);
+    }
+  }
+  g_machine->interrupt->SetStatus(old_status);
+  send_lock->Release();
+  DEBUG('d', (char *) "ACIA: queued a %d bytes message\n", len + 1);
+  return len;
+}
+#endif
 
 //-------------------------------------------------------------------------
 // DriverACIA::TtyReceive(char* buff,int length)
 /*! Routine to reveive a message through the ACIA
 //  (Busy Waiting and Interrupt mode).
+//
+//  In Interrupt mode the caller sleeps until a complete message is in
+//  the reception ring, then the whole message is copied at once.
+//  Characters exceeding the buffer length are discarded.
+//
+//  \param buff is the buffer receiving the message, of size lg + 1
+//  \param lg is the maximum number of characters to receive
+//  \return the number of characters received
   */
 //-------------------------------------------------------------------------
 
+#ifndef ETUDIANTS_TP
 int
 DriverACIA::TtyReceive(char *buff, int lg) {
   printf("**** Warning: method Tty_Receive of the ACIA driver not implemented "
@@ -77,34 +178,116 @@ DriverACIA::TtyReceive(char *buff, int lg) {
   exit(ERROR);
   return 0;
 }
+#endif
+#ifdef ETUDIANTS_TP
+int
+DriverACIA::TtyReceive(char *buff, int lg) {
+  int i = 0;
+  char c;
+
+  if (g_cfg->ACIA == ACIA_BUSY_WAITING) {
+    receive_sema->P();
+    do {
+      while (g_machine->acia->GetInputStateReg() == EMPTY)
+        ;
+      c = g_machine->acia->GetChar();
+      if ((c != '\0') && (i < lg))
+        buff[i++] = c;
+    } while (c != '\0');
+    buff[i] = '\0';
+    receive_sema->V();
+    return i;
+  }
+
+  receive_sema->P();
+  IntStatus old_status = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+  do {
+    ASSERT(rec_count > 0);
+    c = receive_buffer[ind_rec];
+    ind_rec = (ind_rec + 1) % BUFFER_SIZE;
+    rec_count--;
+    if ((c != '\0') && (i < lg))
+      buff[i++] = c;
+  } while (c != '\0');
+  buff[i] = '\0';
+  g_machine->interrupt->SetStatus(old_status);
+  DEBUG('d', (char *) "ACIA: received a %d bytes message\n", i + 1);
+  return i;
+}
+#endif
 
 //-------------------------------------------------------------------------
 // DriverACIA::InterruptSend()
 /*! Emission interrupt handler.
   Used in the ACIA Interrupt mode only.
-  Detects when it's the end of the message (if so, releases the send_sema
-  semaphore), else sends the next character according to index ind_send.
+  Drops the byte just transmitted from the emission ring and sends the
+  next one, if any. A sender waiting for room is only woken up when
+  half of the ring is free again, not after every byte.
   */
 //-------------------------------------------------------------------------
 
+#ifndef ETUDIANTS_TP
 void
 DriverACIA::InterruptSend() {
   printf("**** Warning: send interrupt handler not implemented yet\n");
   exit(ERROR);
 }
+#endif
+#ifdef ETUDIANTS_TP
+void
+DriverACIA::InterruptSend() {
+  ASSERT(send_busy && (send_count > 0));
+  ind_send = (ind_send + 1) % BUFFER_SIZE;
+  send_count--;
+
+  if (send_count > 0)
+    g_machine->acia->PutChar(send_buffer[ind_send]);
+  else
+    send_busy = false;
+
+  if (send_waiting && (BUFFER_SIZE - send_count >= BUFFER_SIZE / 2)) {
+    send_waiting = false;
+    send_sema->V();
+  }
+}
+#endif
 
 //-------------------------------------------------------------------------
 // DriverACIA::Interrupt_receive()
 /*! Reception interrupt handler.
-  Used in the ACIA Interrupt mode only. Reveices a character through the ACIA.
-  Releases the receive_sema semaphore and disables reception
-  interrupts when the last character of the message is received
-  (character '\0').
+  Used in the ACIA Interrupt mode only. Stores the received character
+  in the reception ring and releases the receive_sema semaphore once
+  per complete message (character '\0'). When the ring is full the
+  character is dropped, and the pending message is truncated so that
+  the message boundaries are kept.
   */
 //-------------------------------------------------------------------------
 
+#ifndef ETUDIANTS_TP
 void
 DriverACIA::InterruptReceive() {
   printf("**** Warning: receive interrupt handler not implemented yet\n");
   exit(ERROR);
 }
+#endif
+#ifdef ETUDIANTS_TP
+void
+DriverACIA::InterruptReceive() {
+  char c = g_machine->acia->GetChar();
+
+  if (rec_count == BUFFER_SIZE) {
+    int last = (ind_rec + rec_count - 1) % BUFFER_SIZE;
+    rec_overflows++;
+    if ((c == '\0') && (receive_buffer[last] != '\0')) {
+      receive_buffer[last] = '\0';
+      receive_sema->V();
+    }
+    return;
+  }
+
+  receive_buffer[(ind_rec + rec_count) % BUFFER_SIZE] = c;
+  rec_count++;
+  if (c == '\0')
+    receive_sema->V();
+}
+#endif
@@ -54,10 +54,22 @@ private:
   int ind_send;   //!< index in the emission buffer
   int ind_rec;    //!< index in the reception buffer
 
+  // Interrupt mode only: both buffers are used as rings whose first
+  // valid byte is at ind_send (resp. ind_rec).
+  Lock *send_lock;     //!< serializes senders so messages never interleave
+  int send_count;      //!< number of bytes queued in the emission ring
+  int rec_count;       //!< number of bytes queued in the reception ring
+  bool send_busy;      //!< true while the ACIA is transmitting a ring byte
+  bool send_waiting;   //!< true when a sender sleeps on a full ring
+  int rec_overflows;   //!< bytes dropped because the reception ring was full
+
 public:
   //! Constructor. Driver initialization.
   DriverACIA();
 
+  //! Destructor. Frees the synchronization objects.
+  ~DriverACIA();
+
   //! Send a message through the ACIA
   int TtySend(char *buff);
 
@@ -69,5 +81,10 @@ public:
 
   //! Reception interrupt handler. Used in the ACIA Interrupt mode only
   void InterruptReceive();
+  //! Is a complete message waiting to be received? Interrupt mode only
+  bool MessageReady() { return receive_sema->IsPositive(); }
+  //! Wake up w when a message arrives (WaitAny). Interrupt mode only
+  void AddWaiter(Waiter *w) { receive_sema->AddWaiter(w); }
+  void RemoveWaiter(Waiter *w) { receive_sema->RemoveWaiter(w); }
 };
 #endif   // _ACIA_HDL
@@ -64,6 +64,10 @@ DriverConsole::DriverConsole() {
   put = new Semaphore((char *) "put", 0);
   mutexget = new Lock((char *) "mutex get");
   mutexput = new Lock((char *) "mutex put");
+  inHead = inCount = inReady = 0;
+  inputOn = false;
+  inputEnded = false;
+  listening = false;
 }
 
 //-----------------------------------------------------------------
@@ -120,7 +124,7 @@ DriverConsole::PutString(char *buffer, int nbcar) {
 
 //-----------------------------------------------------------------
 // DriverConsole::GetAChar
-/*!     Operate a V on the "read" semaphore to signal a char is read.
+/*!     Store the character just arrived in the input ring.
 //      The method is called by the interrupt handler ConsoleGet.
 */
 //-----------------------------------------------------------------
@@ -128,37 +132,178 @@ void
 DriverConsole::GetAChar() {
 
   IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
-  get->V();
+  if (g_machine->console->InputClosed()) {
+    // End of the input: the line being typed is complete, and the
+    // readers will get 0 characters from now on
+    inputEnded = true;
+    inReady = inCount;
+    get->V();
+  } else if (inCount < CONSOLE_BUFFER_SIZE) {
+    // No room: the character is left in the device until a line is read
+    ReceiveChar(g_machine->console->GetChar());
+  }
+  UpdateListening();
   (void) g_machine->interrupt->SetStatus(oldLevel);
 }
 
 //-----------------------------------------------------------------
-// DriverConsole::GetString
-/*!     Receive a string from the console device using a lock to
-//      prevent from concurrent accesses. The method returns when
-//      all characters has been received.
+// DriverConsole::ReceiveChar
+/*!     Line discipline: put a character in the input ring, or edit
+//      the line being typed. A reader is woken up when the line is
+//      complete, or when it fills the ring. Interrupts must be
+//      disabled.
 //
-//      \param buffer is the structure to fill
-/       \param size is the number max of char to be received
+//      \param c the character received
+*/
+//-----------------------------------------------------------------
+void
+DriverConsole::ReceiveChar(char c) {
+  switch (c) {
+  case '\b':
+  case 0x7f:   // erase the last character of the line
+    if (inCount > inReady)
+      inCount--;
+    return;
+  case 0x15:   // ^U, erase the line
+    inCount = inReady;
+    return;
+  case '\r':
+    c = '\n';
+    break;
+  }
+
+  input[(inHead + inCount) % CONSOLE_BUFFER_SIZE] = c;
+  inCount++;
+  if ((c == '\n') || ((inCount == CONSOLE_BUFFER_SIZE) && (inReady == 0))) {
+    inReady = inCount;
+    get->V();
+  }
+}
+
+//-----------------------------------------------------------------
+// DriverConsole::StartInput
+/*!     Start buffering the console input, if not already done.
+*/
+//-----------------------------------------------------------------
+void
+DriverConsole::StartInput() {
+  IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+  inputOn = true;
+  UpdateListening();
+  (void) g_machine->interrupt->SetStatus(oldLevel);
+}
+
+//-----------------------------------------------------------------
+// DriverConsole::StopInput
+/*!     Stop buffering the console input, when no thread is left to
+//      read it, so that the machine can halt.
+*/
+//-----------------------------------------------------------------
+void
+DriverConsole::StopInput() {
+  IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+  inputOn = false;
+  UpdateListening();
+  (void) g_machine->interrupt->SetStatus(oldLevel);
+}
+
+//-----------------------------------------------------------------
+// DriverConsole::UpdateListening
+/*!     Enable the console input interrupts while the input is
+//      buffered and there is room in the ring, disable them
+//      otherwise. Interrupts must be disabled.
 */
 //-----------------------------------------------------------------
 void
+DriverConsole::UpdateListening() {
+  bool listen = inputOn && !inputEnded && (inCount < CONSOLE_BUFFER_SIZE);
+
+  if (listen == listening)
+    return;
+  listening = listen;
+  if (listening) {
+    // A character may have been left in the device while the ring was
+    // full
+    char c = g_machine->console->GetChar();
+    if (c != EOF)
+      ReceiveChar(c);
+    g_machine->console->EnableInterrupt();
+  } else
+    g_machine->console->DisableInterrupt();
+}
+
+//-----------------------------------------------------------------
+// DriverConsole::GetString
+/*!     Receive a line from the console device using a lock to
+//      prevent from concurrent accesses. The method returns when a
+//      complete line is in the input ring; it is copied at once, up
+//      to nbcar - 1 characters, the rest of the line being left for
+//      the next read.
+//
+//      \param buffer is the structure to fill, with a '\0' at the end
+//      \param nbcar is the size of the buffer
+//      \return the number of characters read, 0 at the end of the input
+*/
+//-----------------------------------------------------------------
+int
 DriverConsole::GetString(char *buffer, int nbcar) {
 
   char c = 0;
-  int i;
+  int i = 0;
+
+  if (nbcar <= 0)
+    return 0;
 
   mutexget->Acquire();
-  g_machine->console->EnableInterrupt();
+  StartInput();
+  get->P();
 
-  for (i = 0; ((i < nbcar) && (c != '\n')); i++) {
-    g_current_thread->GetProcessOwner()->stat->incrNumCharRead();
-    get->P();
-    c = g_machine->console->GetChar();
-    buffer[i] = c;
+  IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+  while ((i < nbcar - 1) && (inReady > 0) && (c != '\n')) {
+    c = input[inHead];
+    inHead = (inHead + 1) % CONSOLE_BUFFER_SIZE;
+    inCount--;
+    inReady--;
+    buffer[i++] = c;
   }
   buffer[i] = 0;
+  // Part of the line is left in the ring, or the end of the input is
+  // reached and the next readers must not wait either
+  if (((c != '\n') && (inReady > 0)) || (inputEnded && (inReady == 0)))
+    get->V();
+  UpdateListening();
+  (void) g_machine->interrupt->SetStatus(oldLevel);
 
-  g_machine->console->DisableInterrupt();
+  for (int j = 0; j < i; j++)
+    g_current_thread->GetProcessOwner()->stat->incrNumCharRead();
   mutexget->Release();
+  return i;
+}
+
+//-----------------------------------------------------------------
+// DriverConsole::AddWaiter
+/*!     Wake up a thread in WaitAny when a line is in the input ring.
+//      Interrupts must be disabled.
+//
+//      \param w the waiter of the thread
+*/
+//-----------------------------------------------------------------
+void
+DriverConsole::AddWaiter(Waiter *w) {
+  get->AddWaiter(w);
+  inputOn = true;
+  UpdateListening();
+}
+
+//-----------------------------------------------------------------
+// DriverConsole::RemoveWaiter
+/*!     Remove a thread in WaitAny from the waiters of the input.
+//      Interrupts must be disabled.
+//
+//      \param w the waiter of the thread
+*/
+//-----------------------------------------------------------------
+void
+DriverConsole::RemoveWaiter(Waiter *w) {
+  get->RemoveWaiter(w);
 }
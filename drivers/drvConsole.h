@@ -29,6 +29,8 @@ class DriverConsole;
 #include "machine/console.h"
 #include "utility/utility.h"
 
+#define CONSOLE_BUFFER_SIZE 256   //!< size of the console input ring
+
 /*! \brief Defines a "synchronous" console abstraction.
 //
 // As with other I/O devices, the console is an asynchronous device.
@@ -37,6 +39,12 @@ class DriverConsole;
 // writes a string to the console and the second one reads a string from
 // the console. They return only when the read or write operation is
 // completed.
+//
+// Once the console has been read for the first time, the characters
+// typed are stored by the read interrupt handler in an input ring,
+// whether a thread is reading or not, until no thread is left. The
+// handler does the line editing (backspace erases the last character,
+// ^U the whole line), and a reader is woken up once per complete line.
 */
 class DriverConsole {
 public:
@@ -44,16 +52,38 @@ public:
   ~DriverConsole();   // Destructor. Data de-allocation
   void PutString(char *buffer, int nbcar);
   // Write a buffer on the console
-  void GetString(char *buffer, int nbcar);
-  // Read characters from the console
+  int GetString(char *buffer, int nbcar);
+  // Read a line from the console
+  void StopInput();
+  // Stop buffering the input, no thread is left to read it
 
   void GetAChar();   // Send a char to the console device
   void PutAChar();   // Receive e char from the console
 
+  bool InputReady() { return get->IsPositive(); }
+  // Is a line waiting to be read?
+  void AddWaiter(Waiter *w);
+  // Wake up w when a line arrives (WaitAny)
+  void RemoveWaiter(Waiter *w);
+
 private:
   Lock *mutexget;         //!< Lock on read operations
   Lock *mutexput;         //!< Lock on write operations
-  Semaphore *get, *put;   //!< Semaphores to wait for interrupts
+  Semaphore *get;         //!< Complete lines in the input ring
+  Semaphore *put;         //!< Semaphore to wait for write interrupts
+
+  char input[CONSOLE_BUFFER_SIZE];   //!< Input ring
+  int inHead;       //!< Index of the first character of the ring
+  int inCount;      //!< Number of characters in the ring
+  int inReady;      /*!< Number of characters of the complete lines,
+                       at the beginning of the ring */
+  bool inputOn;     //!< Is the input buffered?
+  bool inputEnded;  //!< Has the end of the input been reached?
+  bool listening;   //!< Are the input interrupts enabled?
+
+  void StartInput();        // start buffering the input
+  void UpdateListening();   // enable the interrupts if there is room
+  void ReceiveChar(char c);   // line discipline
 };
 
 void ConsoleGet();
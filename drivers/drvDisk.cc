@@ -7,10 +7,10 @@
 //	the disk providing a synchronous interface (requests wait until
 //	the request completes).
 //
-//	Use a semaphore to synchronize the interrupt handlers with the
-//	pending requests.  And, because the physical disk can only
-//	handle one operation at a time, use a lock to enforce mutual
-//	exclusion.
+//	Because the physical disk can only handle one operation at a time,
+//	requests are queued in the driver: the interrupt handler starts
+//	the next one. A semaphore per batch of requests synchronizes the
+//	interrupt handler with the waiting thread.
  * -----------------------------------------------------
  * This file is part of the Nachos-RiscV distribution
  * Copyright (c) 2022 University of Rennes 1.
@@ -28,17 +28,22 @@
 */
 
 #include "drivers/drvDisk.h"
+#include "drivers/drvVolume.h"
+#include "kernel/workqueue.h"
+#include "utility/stats.h"
 
 //----------------------------------------------------------------------
 // DiskRequestDone
 /*! 	Disk interrupt handler.  Need this to be a C routine, because
 //	C++ can't handle pointers to member functions.
+//
+//	\param diskNumber number of the data disk in the volume
 */
 //----------------------------------------------------------------------
 
 void
-DiskRequestDone() {
-  g_disk_driver->RequestDone();
+DiskRequestDone(int64_t diskNumber) {
+  g_volume_driver->GetDisk(diskNumber)->RequestDone();
 }
 
 //----------------------------------------------------------------------
@@ -49,22 +54,96 @@ DiskRequestDone() {
 //----------------------------------------------------------------------
 
 void
-DiskSwapRequestDone() {
+DiskSwapRequestDone(int64_t unused) {
   g_swap_disk_driver->RequestDone();
 }
 
+//----------------------------------------------------------------------
+// DiskRequestComplete
+/*! 	Work deferred by the disk interrupt handler, run with interrupts
+//	enabled: notify the batch of a completed request.
+//
+//	\param req the completed request
+*/
+//----------------------------------------------------------------------
+
+static void
+DiskRequestComplete(int64_t req) {
+  DiskRequest *request = (DiskRequest *) req;
+
+  request->batch->Done();
+  delete request;
+}
+
+//----------------------------------------------------------------------
+// DiskBatch::DiskBatch
+/*! 	Constructor. Initialize a batch of disk requests.
+//
+//	\param nbRequests the number of requests of the batch
+*/
+//----------------------------------------------------------------------
+
+DiskBatch::DiskBatch(int nbRequests) {
+  remaining = nbRequests;
+  done = new Semaphore((char *) "disk batch", 0);
+}
+
+//----------------------------------------------------------------------
+// DiskBatch::~DiskBatch
+//! 	Destructor.
+//----------------------------------------------------------------------
+
+DiskBatch::~DiskBatch() { delete done; }
+
+//----------------------------------------------------------------------
+// DiskBatch::Done
+/*! 	Called when one request of the batch completes. Wake up the
+//	waiting thread after the last one.
+*/
+//----------------------------------------------------------------------
+
+void
+DiskBatch::Done() {
+  IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+  remaining--;
+  if (remaining == 0)
+    done->V();
+  g_machine->interrupt->SetStatus(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// DiskBatch::Wait
+//! 	Wait until every request of the batch has completed.
+//----------------------------------------------------------------------
+
+void
+DiskBatch::Wait() {
+  done->P();
+}
+
 //----------------------------------------------------------------------
 // DriverDisk::DriverDisk
 /*! 	Constructor.
 //      Initialize the disk driver, in turn
 //	initializing the physical disk.
+//
+//	\param diskName name of the disk, used in the statistics
+//	\param theDisk the raw disk device
 */
 //----------------------------------------------------------------------
 
-DriverDisk::DriverDisk(char *sem_name, char *lock_name, Disk *theDisk) {
-  semaphore = new Semaphore((char *) sem_name, 0);
-  lock = new Lock((char *) lock_name);
+DriverDisk::DriverDisk(char *diskName, BlockDevice *theDisk) {
+  name = new char[strlen(diskName) + 1];
+  strcpy(name, diskName);
   disk = theDisk;
+  queue = new Listint;
+  inFlight = new DiskRequest *[disk->GetQueueDepth()];
+  for (int tag = 0; tag < disk->GetQueueDepth(); tag++)
+    inFlight[tag] = NULL;
+  numInFlight = 0;
+  busySince = 0;
+  busyTicks = 0;
+  numRequests = 0;
 }
 
 //----------------------------------------------------------------------
@@ -75,8 +154,10 @@ DriverDisk::DriverDisk(char *sem_name, char *lock_name, Disk *theDisk) {
 //----------------------------------------------------------------------
 
 DriverDisk::~DriverDisk() {
-  delete lock;
-  delete semaphore;
+  ASSERT(queue->IsEmpty());
+  delete queue;
+  delete[] inFlight;
+  delete[] name;
 }
 
 //----------------------------------------------------------------------
@@ -91,13 +172,13 @@ DriverDisk::~DriverDisk() {
 
 void
 DriverDisk::ReadSector(uint32_t sectorNumber, char *data) {
+  DiskBatch batch(1);
+
   DEBUG('d', (char *) "[sdisk] rd req\n");
-  lock->Acquire();   // only one disk I/O at a time
-  disk->ReadRequest(sectorNumber, data);
+  PostRequest(false, sectorNumber, data, &batch);
   DEBUG('d', (char *) "[sdisk] rd req: wait irq\n");
-  semaphore->P();   // wait for interrupt
+  batch.Wait();   // wait for interrupt
   DEBUG('d', (char *) "[sdisk] rd req: wait irq OK\n");
-  lock->Release();
 }
 
 //----------------------------------------------------------------------
@@ -112,24 +193,105 @@ DriverDisk::ReadSector(uint32_t sectorNumber, char *data) {
 
 void
 DriverDisk::WriteSector(uint32_t sectorNumber, char *data) {
+  DiskBatch batch(1);
+
   DEBUG('d', (char *) "[sdisk] wr req\n");
-  lock->Acquire();   // only one disk I/O at a time
-  disk->WriteRequest(sectorNumber, data);
+  PostRequest(true, sectorNumber, data, &batch);
   DEBUG('d', (char *) "[sdisk] wr req: wait irq...\n");
-  semaphore->P();   // wait for interrupt
+  batch.Wait();   // wait for interrupt
   DEBUG('d', (char *) "[sdisk] wr req: wait irq OK\n");
-  lock->Release();
+}
+
+//----------------------------------------------------------------------
+// DriverDisk::PostRequest
+/*! 	Queue a request for the disk and return at once. The request is
+//	started immediately when the disk can accept it.
+//
+//	\param writing true for a write request, false for a read
+//	\param sectorNumber the disk sector to transfer
+//	\param data the buffer of the transfer, which must stay valid
+//	       until the request completes
+//	\param batch the batch notified when the request completes
+*/
+//----------------------------------------------------------------------
+
+void
+DriverDisk::PostRequest(bool writing, uint32_t sectorNumber, char *data,
+                        DiskBatch *batch) {
+  DiskRequest *request = new DiskRequest;
+  request->writing = writing;
+  request->sectorNumber = sectorNumber;
+  request->data = data;
+  request->batch = batch;
+
+  IntStatus old_status = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+  queue->Append((void *) request);
+  StartRequests();
+  g_machine->interrupt->SetStatus(old_status);
+}
+
+//----------------------------------------------------------------------
+// DriverDisk::StartRequests
+/*! 	Send the queued requests to the disk, in order, as long as it has
+//	a free tag for them. Interrupts are disabled.
+*/
+//----------------------------------------------------------------------
+
+void
+DriverDisk::StartRequests() {
+  int tag = 0;
+
+  while ((numInFlight < disk->GetQueueDepth()) && !queue->IsEmpty()) {
+    DiskRequest *request = (DiskRequest *) queue->Remove();
+    while (inFlight[tag] != NULL)
+      tag++;
+    inFlight[tag] = request;
+    if (numInFlight == 0)
+      busySince = g_stats->getTotalTicks();
+    numInFlight++;
+    numRequests++;
+    if (request->writing)
+      disk->WriteRequest(request->sectorNumber, request->data, tag);
+    else
+      disk->ReadRequest(request->sectorNumber, request->data, tag);
+  }
 }
 
 //----------------------------------------------------------------------
 // DriverDisk::RequestDone
-/*! 	Disk interrupt handler. Wake up any thread waiting for the disk
-//	request to finish.
+/*! 	Disk interrupt handler. Start the next queued requests, if
+//	any, so that the disk does not wait, and defer the notification
+//	of the completed request.
 */
 //----------------------------------------------------------------------
 
 void
 DriverDisk::RequestDone() {
+  int tag = disk->GetCompletedTag();
+  DiskRequest *request = inFlight[tag];
+
   DEBUG('d', (char *) "[sdisk] req done\n");
-  semaphore->V();
+  ASSERT(request != NULL);
+  inFlight[tag] = NULL;
+  numInFlight--;
+  if (numInFlight == 0)
+    busyTicks += g_stats->getTotalTicks() - busySince;
+  StartRequests();
+  g_work_queue->Defer(DiskRequestComplete, (int64_t) request);
+}
+
+//----------------------------------------------------------------------
+// DriverDisk::Print
+//! 	Print the number of requests served and the utilisation of the disk
+//----------------------------------------------------------------------
+
+void
+DriverDisk::Print() {
+  Time total = g_stats->getTotalTicks();
+
+  printf("   %s : \t%" PRIu64 " requests, busy %" PRIu64
+         " cycles (%" PRIu64 " %% of total time)\n",
+         name, numRequests, busyTicks,
+         (total == 0) ? 0 : (busyTicks * 100) / total);
+  disk->Print();
 }
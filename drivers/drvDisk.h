@@ -24,11 +24,39 @@
 #define SYNCHDISK_H
 
 #include "kernel/synch.h"
-#include "machine/disk.h"
+#include "machine/blockdev.h"
 
 class Semaphore;
 class Lock;
 
+/*! \brief Defines a set of disk requests waited for as a whole.
+//
+// A thread posts any number of requests, possibly on several disks,
+// then sleeps once until the last of them completes.
+*/
+class DiskBatch {
+public:
+  DiskBatch(int nbRequests);   // Initialize a batch of nbRequests requests
+  ~DiskBatch();
+
+  void Done();   // Called by the disk driver when one request completes
+  void Wait();   // Wait until every request of the batch has completed
+
+private:
+  int remaining;     //!< Number of requests not completed yet
+  Semaphore *done;   //!< Released when the last request completes
+};
+
+/*! \brief Defines a request waiting in the queue of a disk driver
+ */
+class DiskRequest {
+public:
+  bool writing;            //!< true for a write request
+  uint32_t sectorNumber;   //!< sector of the disk to transfer
+  char *data;              //!< buffer of the transfer (one sector)
+  DiskBatch *batch;        //!< batch to notify at completion
+};
+
 /*! \brief Defines a "synchronous" disk abstraction.
 //
 // As with other I/O devices, the raw physical disk is an asynchronous
@@ -40,11 +68,15 @@ class Lock;
 //
 // This class provides the abstraction that for any individual thread
 // making a request, it waits around until the operation finishes before
-// returning.
+// returning. Requests are queued in the driver, so that a thread can
+// also post several requests and wait for all of them at once. When the
+// device accepts several requests at the same time (flash disk), the
+// driver keeps it fed with up to GetQueueDepth() requests, each of them
+// being identified by its tag, its index in the inFlight table.
 */
 class DriverDisk {
 public:
-  DriverDisk(char *sem_name, char *lock_name, Disk *theDisk);
+  DriverDisk(char *diskName, BlockDevice *theDisk);
   // Constructor. Initializes the disk
   // driver by initializing the raw Disk.
   ~DriverDisk();   // Destructor. De-allocate the driver data
@@ -55,20 +87,31 @@ public:
   // or written.
   void WriteSector(uint32_t sectorNumber, char *data);
 
+  void PostRequest(bool writing, uint32_t sectorNumber, char *data,
+                   DiskBatch *batch);
+  // Queue a request and return at once,
+  // batch is notified when it completes.
+
   void RequestDone();   // Called by the disk device interrupt
                         // handler, to signal that the
                         // current disk operation is complete.
 
+  void Print();   // Print the utilisation of the disk
+
 private:
-  Semaphore *semaphore; /*!< To synchronize requesting thread
-                             with the interrupt handler
-                        */
-  Lock *lock;           /*!< Mutual exclusion on the disk device
-                         */
-  Disk *disk;           /* The disk */
+  char *name;              //!< Name of the disk, for the statistics
+  BlockDevice *disk;       /* The disk */
+  Listint *queue;          //!< Requests waiting for the disk
+  DiskRequest **inFlight;  //!< Requests in progress, indexed by their tag
+  int numInFlight;         //!< Number of requests in progress
+  Time busySince;          //!< When the disk last went from idle to busy
+  Time busyTicks;          //!< Time spent by the disk serving requests
+  uint64_t numRequests;    //!< Number of requests served
+
+  void StartRequests();   // Send queued requests while the disk accepts them
 };
 
-void DiskRequestDone();
-void DiskSwapRequestDone();
+void DiskRequestDone(int64_t diskNumber);
+void DiskSwapRequestDone(int64_t unused);
 
 #endif   // SYNCHDISK_H
@@ -0,0 +1,150 @@
+/*! \file drvVolume.cc
+//  \brief Routines of the block device striped over the data disks
+//
+//	The volume hides the number of data disks to the file system.
+//	Consecutive sectors of the volume are on different disks, so
+//	that the disks serve the sectors of a large request in parallel.
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#include "drivers/drvVolume.h"
+#include "kernel/system.h"
+
+//----------------------------------------------------------------------
+// DriverVolume::DriverVolume
+/*! 	Constructor. Create a driver for every data disk.
+//
+//	\param numDisks number of data disks
+//	\param disks the raw data disk devices
+*/
+//----------------------------------------------------------------------
+
+DriverVolume::DriverVolume(int numDisks, BlockDevice **disks) {
+  char name[MAXSTRLEN];
+
+  ASSERT(numDisks > 0);
+  nbDisks = numDisks;
+  drivers = new DriverDisk *[nbDisks];
+  for (int i = 0; i < nbDisks; i++) {
+    sprintf(name, "data disk %d", i);
+    drivers[i] = new DriverDisk(name, disks[i]);
+  }
+}
+
+//----------------------------------------------------------------------
+// DriverVolume::~DriverVolume
+//! 	Destructor. De-allocate the disk drivers.
+//----------------------------------------------------------------------
+
+DriverVolume::~DriverVolume() {
+  for (int i = 0; i < nbDisks; i++)
+    delete drivers[i];
+  delete[] drivers;
+}
+
+//----------------------------------------------------------------------
+// DriverVolume::ReadSector
+/*! 	Read the contents of a volume sector into a buffer. Return only
+//	after the data has been read.
+//
+//	\param sectorNumber the volume sector to read
+//	\param data the buffer to hold the contents of the sector
+*/
+//----------------------------------------------------------------------
+
+void
+DriverVolume::ReadSector(uint32_t sectorNumber, char *data) {
+  drivers[sectorNumber % nbDisks]->ReadSector(sectorNumber / nbDisks, data);
+}
+
+//----------------------------------------------------------------------
+// DriverVolume::WriteSector
+/*! 	Write the contents of a buffer into a volume sector.  Return only
+//	after the data has been written.
+//
+//	\param sectorNumber the volume sector to be written
+//	\param data the new contents of the sector
+*/
+//----------------------------------------------------------------------
+
+void
+DriverVolume::WriteSector(uint32_t sectorNumber, char *data) {
+  drivers[sectorNumber % nbDisks]->WriteSector(sectorNumber / nbDisks, data);
+}
+
+//----------------------------------------------------------------------
+// DriverVolume::ReadSectors
+/*! 	Read a list of volume sectors into consecutive sectors of a
+//	buffer. Return only after all the data has been read.
+//
+//	\param sectors the volume sectors to read
+//	\param nbSectors the number of sectors to read
+//	\param data the buffer, of nbSectors sectors
+*/
+//----------------------------------------------------------------------
+
+void
+DriverVolume::ReadSectors(uint32_t *sectors, int nbSectors, char *data) {
+  Transfer(false, sectors, nbSectors, data);
+}
+
+//----------------------------------------------------------------------
+// DriverVolume::WriteSectors
+/*! 	Write consecutive sectors of a buffer into a list of volume
+//	sectors. Return only after all the data has been written.
+//
+//	\param sectors the volume sectors to write
+//	\param nbSectors the number of sectors to write
+//	\param data the buffer, of nbSectors sectors
+*/
+//----------------------------------------------------------------------
+
+void
+DriverVolume::WriteSectors(uint32_t *sectors, int nbSectors, char *data) {
+  Transfer(true, sectors, nbSectors, data);
+}
+
+//----------------------------------------------------------------------
+// DriverVolume::Transfer
+/*! 	Post a request per sector to the drivers of the data disks, and
+//	wait for all of them at once.
+*/
+//----------------------------------------------------------------------
+
+void
+DriverVolume::Transfer(bool writing, uint32_t *sectors, int nbSectors,
+                       char *data) {
+  if (nbSectors <= 0)
+    return;
+
+  DiskBatch batch(nbSectors);
+  for (int i = 0; i < nbSectors; i++)
+    drivers[sectors[i] % nbDisks]->PostRequest(writing, sectors[i] / nbDisks,
+                                               &data[i * g_cfg->SectorSize],
+                                               &batch);
+  batch.Wait();
+}
+
+//----------------------------------------------------------------------
+// DriverVolume::Print
+//! 	Print the utilisation of every data disk
+//----------------------------------------------------------------------
+
+void
+DriverVolume::Print() {
+  for (int i = 0; i < nbDisks; i++)
+    drivers[i]->Print();
+}
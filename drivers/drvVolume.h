@@ -0,0 +1,75 @@
+/*! \file drvVolume.h
+    \brief Data structures of the block device striped over the data
+           disks.
+
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#include "kernel/copyright.h"
+
+#ifndef VOLUME_H
+#define VOLUME_H
+
+#include "drivers/drvDisk.h"
+#include "machine/disk.h"
+
+/*! \brief Defines the volume used by the file system.
+//
+// The volume is a block device of NUM_SECTORS sectors striped RAID-0
+// style over the g_cfg->NumDataDisks data disks: sector s of the
+// volume is sector s / NumDataDisks of disk s % NumDataDisks.
+//
+// A multi-sector request is split into one request per sector, posted
+// to the drivers of the disks which all work in parallel, and the
+// calling thread waits once for the whole request.
+*/
+class DriverVolume {
+public:
+  DriverVolume(int numDisks, BlockDevice **disks);
+  // Constructor. Creates a driver
+  // for each data disk.
+  ~DriverVolume();   // Destructor. De-allocate the disk drivers
+
+  void ReadSector(uint32_t sectorNumber, char *data);
+  // Read/write a volume sector, returning
+  // only once the data is actually read
+  // or written.
+  void WriteSector(uint32_t sectorNumber, char *data);
+
+  void ReadSectors(uint32_t *sectors, int nbSectors, char *data);
+  // Read/write a list of volume sectors
+  // from/to consecutive sectors of data,
+  // the disks working in parallel.
+  void WriteSectors(uint32_t *sectors, int nbSectors, char *data);
+
+  DriverDisk *GetDisk(int i) { return drivers[i]; }
+  // Driver of the i-th data disk
+
+  int TrackOf(uint32_t sectorNumber) {
+    return (sectorNumber / nbDisks) / SECTORS_PER_TRACK;
+  }
+  // Track of a volume sector on its disk
+
+  void Print();   // Print the utilisation of every data disk
+
+private:
+  int nbDisks;             //!< Number of data disks
+  DriverDisk **drivers;    //!< Driver of every data disk
+
+  void Transfer(bool writing, uint32_t *sectors, int nbSectors, char *data);
+};
+
+#endif   // VOLUME_H
@@ -250,3 +250,51 @@ Directory::empty() {
   }
   return empti;
 }
+
+//----------------------------------------------------------------------
+// Directory::NumEntries
+//! 	\return the number of entries of the directory, used or not.
+//----------------------------------------------------------------------
+int
+Directory::NumEntries() {
+  return tableSize;
+}
+
+//----------------------------------------------------------------------
+// Directory::EntrySector
+/*! 	\return the sector of the header of the file of entry i, or
+//	ERROR if the entry is not in use.
+//	\param i the index of the entry in the table
+*/
+//----------------------------------------------------------------------
+int
+Directory::EntrySector(int i) {
+  if (!table[i].inUse)
+    return ERROR;
+  return table[i].sector;
+}
+
+//----------------------------------------------------------------------
+// Directory::EntryName
+/*! 	\return the name of the file of entry i.
+//	\param i the index of the entry in the table
+*/
+//----------------------------------------------------------------------
+char *
+Directory::EntryName(int i) {
+  return table[i].name;
+}
+
+//----------------------------------------------------------------------
+// Directory::SetEntrySector
+/*! 	Record that the header of the file of entry i has moved (see
+//	FileSystem::Defragment).
+//	\param i the index of the entry in the table
+//	\param newSector the new location of the header
+*/
+//----------------------------------------------------------------------
+void
+Directory::SetEntrySector(int i, int newSector) {
+  ASSERT(table[i].inUse);
+  table[i].sector = newSector;
+}
@@ -89,6 +89,12 @@ public:
                   //   names and their contents.
   bool empty();
 
+  int NumEntries();                          // Size of the table
+  int EntrySector(int i);                    // Header sector of entry i,
+                                             // ERROR if it is not in use
+  char *EntryName(int i);                    // Name of entry i
+  void SetEntrySector(int i, int newSector); // Move the header of entry i
+
 private:
   int tableSize;               //!< Number of directory entries
   DirectoryEntry *table;       /*!< Table of pairs:
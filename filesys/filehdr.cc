@@ -36,11 +36,14 @@
 */
 
 #include "filesys/filehdr.h"
-#include "drivers/drvDisk.h"
+#include "drivers/drvVolume.h"
 #include "kernel/system.h"
 #include "utility/config.h"
 
-FileHeader::FileHeader(void) { dataSectors = NULL; }
+FileHeader::FileHeader(void) {
+  dataSectors = NULL;
+  readCount = 0;
+}
 
 FileHeader::~FileHeader(void) {
   if (dataSectors != NULL) {
@@ -178,14 +181,15 @@ FileHeader::FetchFrom(int sector) {
 
   // Read the header from the disk
   // and put it in the temporary buffer
-  g_disk_driver->ReadSector(sector, (char *) SectorImg);
+  g_volume_driver->ReadSector(sector, (char *) SectorImg);
 
   // Allocates memory for the table of data sectors
   dataSectors = new int[MAX_DATA_SECTORS];
 
   // Set up the memory image of the file header
   // from the newly read buffer
-  isdir = SectorImg[0];
+  isdir = SectorImg[0] & 1;
+  readCount = (unsigned) SectorImg[0] >> 1;
   numBytes = SectorImg[1];
   numSectors = SectorImg[2];
   numHeaderSectors = SectorImg[3];
@@ -203,7 +207,7 @@ FileHeader::FetchFrom(int sector) {
   for (i = 0; i < numHeaderSectors; i++) {
     // Fill the temporary buffer with zeroes
     memset(SectorImg, 0, g_cfg->SectorSize);
-    g_disk_driver->ReadSector(headerSectors[i], (char *) SectorImg);
+    g_volume_driver->ReadSector(headerSectors[i], (char *) SectorImg);
 
     for (j = 0; j < DatasInSector; j++)
       dataSectors[DatasInFirstSector + i * DatasInSector + j] = SectorImg[j];
@@ -231,7 +235,7 @@ FileHeader::WriteBack(int sector) {
   memset(SectorImg, 0, g_cfg->SectorSize);
 
   // Fills the header of the first header sector
-  SectorImg[0] = isdir;
+  SectorImg[0] = isdir | (readCount << 1);
   SectorImg[1] = numBytes;
   SectorImg[2] = numSectors;
   SectorImg[3] = numHeaderSectors;
@@ -243,7 +247,7 @@ FileHeader::WriteBack(int sector) {
   NextHeaderSector(SectorImg) = headerSectors[0];
 
   // Write the first header sector into disk
-  g_disk_driver->WriteSector(sector, (char *) SectorImg);
+  g_volume_driver->WriteSector(sector, (char *) SectorImg);
 
   // Write the following header sectors into disk
   for (i = 0; i < numHeaderSectors; i++) {
@@ -254,7 +258,7 @@ FileHeader::WriteBack(int sector) {
       NextHeaderSector(SectorImg) = headerSectors[i + 1];
     else
       NextHeaderSector(SectorImg) = 0;
-    g_disk_driver->WriteSector(headerSectors[i], (char *) SectorImg);
+    g_volume_driver->WriteSector(headerSectors[i], (char *) SectorImg);
   }
 }
 
@@ -321,7 +325,7 @@ FileHeader::Print() {
     printf("%" PRIu32 " ", dataSectors[i]);
   printf("\nFile contents:\n");
   for (i = k = 0; i < numSectors; i++) {
-    g_disk_driver->ReadSector(dataSectors[i], data);
+    g_volume_driver->ReadSector(dataSectors[i], data);
     for (j = 0; ((uint32_t) j < g_cfg->SectorSize) && (k < numBytes);
          j++, k++) {
       if ('\040' <= data[j] && data[j] <= '\176')   // isprint(data[j])
@@ -366,3 +370,75 @@ void
 FileHeader::SetDir() {
   isdir = 1;
 }
+
+//----------------------------------------------------------------------
+// FileHeader::GetReadCount
+/*!	\return the number of data sectors read from this file, as counted
+//	when the Defragment option is set.
+*/
+//----------------------------------------------------------------------
+int
+FileHeader::GetReadCount() {
+  return readCount;
+}
+
+//----------------------------------------------------------------------
+// FileHeader::AddReadCount
+/*!	Add reads to the read count of the file, which saturates at
+//	MAX_READ_COUNT.
+//
+//	\param reads the number of data sectors read
+*/
+//----------------------------------------------------------------------
+void
+FileHeader::AddReadCount(int reads) {
+  if (reads > MAX_READ_COUNT - readCount)
+    readCount = MAX_READ_COUNT;
+  else
+    readCount += reads;
+}
+
+//----------------------------------------------------------------------
+// FileHeader::NumDiskSectors
+/*!	\return the number of sectors of the file, except its first header
+//	sector: the other header sectors come first, then the data sectors,
+//	in the order in which they are read.
+*/
+//----------------------------------------------------------------------
+int
+FileHeader::NumDiskSectors() {
+  return numHeaderSectors + numSectors;
+}
+
+//----------------------------------------------------------------------
+// FileHeader::GetDiskSector
+/*!	\return the i-th sector of the file (see NumDiskSectors)
+//	\param i the index of the sector, from 0 to NumDiskSectors() - 1
+*/
+//----------------------------------------------------------------------
+int
+FileHeader::GetDiskSector(int i) {
+  ASSERT(i >= 0 && i < NumDiskSectors());
+  if (i < numHeaderSectors)
+    return headerSectors[i];
+  return dataSectors[i - numHeaderSectors];
+}
+
+//----------------------------------------------------------------------
+// FileHeader::SetDiskSector
+/*!	Change the location of the i-th sector of the file (see
+//	NumDiskSectors). Only the header is modified: the caller copies
+//	the contents of the sector and writes the header back.
+//
+//	\param i the index of the sector, from 0 to NumDiskSectors() - 1
+//	\param sector its new location
+*/
+//----------------------------------------------------------------------
+void
+FileHeader::SetDiskSector(int i, int sector) {
+  ASSERT(i >= 0 && i < NumDiskSectors());
+  if (i < numHeaderSectors)
+    headerSectors[i] = sector;
+  else
+    dataSectors[i - numHeaderSectors] = sector;
+}
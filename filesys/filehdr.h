@@ -53,7 +53,8 @@ extern Config *g_cfg;
 // 1. First header sector
 //
 //   .----------------------.
-//   |   isDir              | if it is a directory, 1, 0 otherwise
+//   |   isDir | readCount  | bit 0: 1 if it is a directory, 0 otherwise
+//   |                      | other bits: number of data sectors read
 //   |   numBytes           | total size of the data (header excluded)
 //   |   numSectors         | total number of sectors
 //   |   numHeaderSectors   | number of header sectors
@@ -105,6 +106,9 @@ extern Config *g_cfg;
 
 #define MAX_FILE_LENGTH ((int) ((MAX_DATA_SECTORS) * g_cfg->SectorSize))
 
+//! The read count saturates at this value (it shares a word with isDir)
+#define MAX_READ_COUNT 0x3fffffff
+
 /*! \brief Defines a file header in the Nachos file system
  */
 class FileHeader {
@@ -141,8 +145,18 @@ public:
                                 //!< as a directory.
   void SetFile();               //!< Mark this header as a file header
   void SetDir();                //!< Mark this header as a directory header
+
+  int GetReadCount();       //!< Return the number of data sectors read
+  void AddReadCount(int);   //!< Add sectors to the read count
+
+  int NumDiskSectors();   //!< Return the number of header sectors (but
+                          //!< the first one) and data sectors
+  int GetDiskSector(int i);               //!< Return the i-th of them
+  void SetDiskSector(int i, int sector);  //!< Move the i-th of them
 private:
   int isdir;
+  int readCount;          //!< Number of data sectors read (see
+                          //!< FileSystem::Defragment)
   int numBytes;           //!< Number of bytes in the file
   int numSectors;         //!< Number of data sectors in the file
   int *dataSectors;       /*!< Disk sector numbers for each data
@@ -58,6 +58,7 @@
 */
 
 #include "filesys/filesys.h"
+#include "drivers/drvVolume.h"
 #include "filesys/directory.h"
 #include "filesys/filehdr.h"
 #include "filesys/oftable.h"
@@ -183,6 +184,8 @@ FindDir(char *name) {
 //----------------------------------------------------------------------
 FileSystem::FileSystem(bool format) {
   DEBUG('f', (char *) "Initializing the file system.\n");
+  pendingReads = new int[NUM_SECTORS];
+  memset(pendingReads, 0, NUM_SECTORS * sizeof(int));
   if (format) {
     BitMap freeMap(NUM_SECTORS);
     Directory directory(g_cfg->NumDirEntries);
@@ -251,6 +254,7 @@ FileSystem::FileSystem(bool format) {
 FileSystem::~FileSystem() {
   delete freeMapFile;
   delete directoryFile;
+  delete[] pendingReads;
 }
 
 //----------------------------------------------------------------------
@@ -443,6 +447,7 @@ FileSystem::Remove(char *name) {
   // Indicate that sectors are deallocated in the freemap
   fileHdr.Deallocate(&freeMap);   // remove data blocks
   freeMap.Clear(sector);          // remove header block
+  pendingReads[sector] = 0;       // the reads were for this file
 
   // Remove the file from the directory
   directory.Remove(dirname);
@@ -683,3 +688,329 @@ FileSystem::Rmdir(char *dirname) {
 
   return NO_ERROR;
 }
+
+//----------------------------------------------------------------------
+// FileSystem::CountReads
+/*!	Note that data sectors of a file have been read. The reads are
+//	only counted in memory here, and added to the read count of the
+//	file header by SaveReadCount: this is done when the Defragment
+//	option is set, for Defragment to know which files are the most
+//	read.
+//
+//	\param sector the sector of the file header
+//	\param nbSectors the number of data sectors read
+*/
+//----------------------------------------------------------------------
+void
+FileSystem::CountReads(int sector, int nbSectors) {
+  if (sector != FreeMapSector)
+    pendingReads[sector] += nbSectors;
+}
+
+//----------------------------------------------------------------------
+// FileSystem::SaveReadCount
+/*!	Add the reads noted by CountReads to the read count of the file
+//	header on disk. Called when a file is closed by its last user, and
+//	when a program has been loaded, so as not to write the header on
+//	each read.
+//
+//	\param sector the sector of the file header
+*/
+//----------------------------------------------------------------------
+void
+FileSystem::SaveReadCount(int sector) {
+  int reads = pendingReads[sector];
+
+  if (reads == 0)
+    return;
+  pendingReads[sector] = 0;
+
+  FileHeader hdr;
+  hdr.FetchFrom(sector);
+  hdr.AddReadCount(reads);
+  hdr.WriteBack(sector);
+}
+
+/*! \brief A file (or directory) seen by the defragmenter
+ */
+struct DefragFile {
+  int parent;   //!< sector of the header of its directory
+  int index;    //!< index of its entry in that directory
+  int sector;   //!< sector of its header
+  int reads;    //!< its read count
+};
+
+//----------------------------------------------------------------------
+// CollectFiles
+/*!	Add to "files" the files and directories found under a directory,
+//	recursively.
+//
+//	\param dirSector the sector of the header of the directory
+//	\param files the table of the files found so far
+//	\param nbFiles the number of files in this table
+//	\return the new number of files in the table
+*/
+//----------------------------------------------------------------------
+static int
+CollectFiles(int dirSector, DefragFile *files, int nbFiles) {
+  Directory directory(g_cfg->NumDirEntries);
+  OpenFile dirFile(dirSector);
+  directory.FetchFrom(&dirFile);
+
+  for (int i = 0; i < directory.NumEntries(); i++) {
+    int sector = directory.EntrySector(i);
+    if (sector == ERROR)
+      continue;
+
+    FileHeader hdr;
+    hdr.FetchFrom(sector);
+    files[nbFiles].parent = dirSector;
+    files[nbFiles].index = i;
+    files[nbFiles].sector = sector;
+    files[nbFiles].reads = hdr.GetReadCount();
+    nbFiles++;
+    if (hdr.IsDir())
+      nbFiles = CollectFiles(sector, files, nbFiles);
+  }
+  return nbFiles;
+}
+
+//----------------------------------------------------------------------
+// IsContiguous
+/*!	\return true if the sectors of a file (header sectors, then data
+//	sectors) follow each other on the volume.
+//
+//	\param hdr the header of the file
+//	\param sector the sector of this header
+*/
+//----------------------------------------------------------------------
+static bool
+IsContiguous(FileHeader *hdr, int sector) {
+  for (int i = 0; i < hdr->NumDiskSectors(); i++)
+    if (hdr->GetDiskSector(i) != sector + 1 + i)
+      return false;
+  return true;
+}
+
+//----------------------------------------------------------------------
+// MeasureLayout
+/*!	Measure how well the files are laid out on the volume: the number
+//	of extents (runs of consecutive sectors) of the files, the number
+//	of tracks crossed by the disk heads to read each file once from
+//	its header to its end, and the mean distance in tracks of the
+//	reads to the middle of the volume, as given by the read counts.
+//
+//	\param files the table of the files
+//	\param nbFiles the number of files in this table
+//	\param extents, tracks, distance where to store the results
+*/
+//----------------------------------------------------------------------
+static void
+MeasureLayout(DefragFile *files, int nbFiles, int *extents, int *tracks,
+              int *distance) {
+  int middle = g_volume_driver->TrackOf(NUM_SECTORS / 2);
+  int64_t weighted = 0, reads = 0;
+
+  *extents = *tracks = 0;
+  for (int f = 0; f < nbFiles; f++) {
+    FileHeader hdr;
+    int prev = files[f].sector;
+
+    hdr.FetchFrom(prev);
+    (*extents)++;
+    for (int i = 0; i < hdr.NumDiskSectors(); i++) {
+      int sector = hdr.GetDiskSector(i);
+      if (sector != prev + 1)
+        (*extents)++;
+      *tracks += abs(g_volume_driver->TrackOf(sector) -
+                     g_volume_driver->TrackOf(prev));
+      prev = sector;
+    }
+    weighted += (int64_t) files[f].reads *
+                abs(g_volume_driver->TrackOf(files[f].sector) - middle);
+    reads += files[f].reads;
+  }
+  *distance = (reads == 0) ? 0 : (int) (weighted / reads);
+}
+
+//----------------------------------------------------------------------
+// FindRun
+/*!	Look for nbSectors consecutive free sectors, as close as possible
+//	to a given sector.
+//
+//	\param freeMap the bitmap of free sectors
+//	\param nbSectors the number of sectors wanted
+//	\param near the sector around which they should be
+//	\return the first of these sectors, or ERROR if there are not
+//	nbSectors consecutive free sectors on the volume
+*/
+//----------------------------------------------------------------------
+static int
+FindRun(BitMap *freeMap, int nbSectors, int near) {
+  int best = ERROR, bestDistance = 0;
+  int start = 0, end;
+
+  while (start < NUM_SECTORS) {
+    if (freeMap->Test(start)) {
+      start++;
+      continue;
+    }
+
+    // Free run [start, end[: place the sectors as close to near as it
+    // allows
+    for (end = start; end < NUM_SECTORS && !freeMap->Test(end); end++)
+      ;
+    if (end - start >= nbSectors) {
+      int first = near - nbSectors / 2;
+      if (first < start)
+        first = start;
+      if (first > end - nbSectors)
+        first = end - nbSectors;
+      int distance = abs(first + nbSectors / 2 - near);
+      if (best == ERROR || distance < bestDistance) {
+        best = first;
+        bestDistance = distance;
+      }
+    }
+    start = end;
+  }
+  return best;
+}
+
+//----------------------------------------------------------------------
+// FileSystem::Relocate
+/*!	Move a file to consecutive free sectors: its header first, then
+//	its other header sectors, then its data sectors.
+//
+//	The disk is consistent at each step: the new sectors are marked
+//	in the free map on disk before the new header refers to them, the
+//	directory entry is switched to the new header in a single write,
+//	and the old sectors are freed after this switch only.
+//
+//	\param file the file to move (its header sector is updated)
+//	\param freeMap the bitmap of free sectors, written back here
+//	\param first the first of the free sectors
+*/
+//----------------------------------------------------------------------
+void
+FileSystem::Relocate(DefragFile *file, BitMap *freeMap, int first) {
+  FileHeader hdr;
+  char data[g_cfg->SectorSize];
+
+  hdr.FetchFrom(file->sector);
+  int nbSectors = 1 + hdr.NumDiskSectors();
+  int old[nbSectors];
+
+  DEBUG('f', (char *) "Defragment: moving %d sectors from %d to %d\n",
+        nbSectors, file->sector, first);
+
+  // Copy the sectors. The header sectors are rewritten below.
+  old[0] = file->sector;
+  for (int i = 0; i < nbSectors; i++)
+    freeMap->Mark(first + i);
+  for (int i = 1; i < nbSectors; i++) {
+    old[i] = hdr.GetDiskSector(i - 1);
+    g_volume_driver->ReadSector(old[i], data);
+    g_volume_driver->WriteSector(first + i, data);
+    hdr.SetDiskSector(i - 1, first + i);
+  }
+  freeMap->WriteBack(freeMapFile);
+  hdr.WriteBack(first);
+
+  // Switch the directory entry to the new header
+  OpenFile dirFile(file->parent);
+  Directory directory(g_cfg->NumDirEntries);
+  directory.FetchFrom(&dirFile);
+  directory.SetEntrySector(file->index, first);
+  directory.WriteBack(&dirFile);
+
+  // Free the old sectors
+  for (int i = 0; i < nbSectors; i++)
+    freeMap->Clear(old[i]);
+  freeMap->WriteBack(freeMapFile);
+  file->sector = first;
+}
+
+//----------------------------------------------------------------------
+// FileSystem::Defragment
+/*!	Lay out the files again, to reduce the seeks of the disk heads:
+//	  - the files which have been read (see SaveReadCount) are moved,
+//	    the most read first, to consecutive sectors as close as
+//	    possible to the middle of the volume, where the heads are the
+//	    closest to all the other sectors on average,
+//	  - the other files whose sectors are not consecutive are moved
+//	    to the first free run of sectors large enough.
+//	A file is left in place if there is no such run.
+//
+//	The bitmap and root directory files, whose headers are at fixed
+//	sectors, are not moved. Called at startup, when no file is open:
+//	the OpenFile objects hold a copy of the file headers.
+//	Prints the layout of the files before and after.
+*/
+//----------------------------------------------------------------------
+void
+FileSystem::Defragment() {
+  DefragFile *files = new DefragFile[NUM_SECTORS];
+  int nbFiles = CollectFiles(DirectorySector, files, 0);
+  int middle = NUM_SECTORS / 2;
+  int middleTrack = g_volume_driver->TrackOf(middle);
+  int extents[2], tracks[2], distance[2];
+  int moved = 0, stuck = 0;
+
+  MeasureLayout(files, nbFiles, &extents[0], &tracks[0], &distance[0]);
+
+  // Sort the files by decreasing read count, keeping the order of the
+  // directories otherwise
+  for (int f = 1; f < nbFiles; f++) {
+    DefragFile file = files[f];
+    int g;
+    for (g = f; g > 0 && files[g - 1].reads < file.reads; g--)
+      files[g] = files[g - 1];
+    files[g] = file;
+  }
+
+  BitMap freeMap(NUM_SECTORS);
+  freeMap.FetchFrom(freeMapFile);
+
+  for (int f = 0; f < nbFiles; f++) {
+    FileHeader hdr;
+    hdr.FetchFrom(files[f].sector);
+    bool contiguous = IsContiguous(&hdr, files[f].sector);
+    if (contiguous && files[f].reads == 0)
+      continue;
+
+    int first =
+        FindRun(&freeMap, 1 + hdr.NumDiskSectors(),
+                (files[f].reads > 0) ? middle : 0);
+    if (first == ERROR) {
+      stuck++;
+      continue;
+    }
+    // A contiguous file is only moved if it gets closer to the middle
+    if (contiguous &&
+        abs(g_volume_driver->TrackOf(first) - middleTrack) >=
+            abs(g_volume_driver->TrackOf(files[f].sector) - middleTrack))
+      continue;
+
+    int oldSector = files[f].sector;
+    Relocate(&files[f], &freeMap, first);
+    moved++;
+
+    // The files of a directory moved are found from its new header
+    if (hdr.IsDir())
+      for (int g = 0; g < nbFiles; g++)
+        if (files[g].parent == oldSector)
+          files[g].parent = files[f].sector;
+  }
+
+  MeasureLayout(files, nbFiles, &extents[1], &tracks[1], &distance[1]);
+  printf("\nDefragmentation : %d files, %d moved, %d without room to move\n",
+         nbFiles, moved, stuck);
+  printf("   Extents : \t\t\t%d before, %d after\n", extents[0], extents[1]);
+  printf("   Seek distance (tracks) : \t%d before, %d after\n", tracks[0],
+         tracks[1]);
+  printf("   Reads from the middle (tracks) : %d before, %d after\n",
+         distance[0], distance[1]);
+
+  delete[] files;
+}
@@ -47,6 +47,9 @@
 #include "kernel/copyright.h"
 
 int FindDir(char *);
+class BitMap;
+struct DefragFile;
+
 /*! \brief Defines the Nachos file system
  */
 class FileSystem {
@@ -76,7 +79,21 @@ public:
 
   int Rmdir(char *);   //!< Delete a directory
 
+  void Defragment();   //!< Make the files contiguous, and move
+                       //!< the most read ones to the middle of the disk
+
+  void CountReads(int sector, int nbSectors);   //!< Note that sectors of
+                                                //!< a file have been read
+  void SaveReadCount(int sector);   //!< Add the reads noted to the read
+                                    //!< count in the file header
+
 private:
+  void Relocate(DefragFile *file, BitMap *freeMap, int first);
+  //!< Move a file to consecutive sectors
+
+  int *pendingReads;       /*!< Sectors read from each file since its
+                            read count was last saved, by header sector
+                           */
   OpenFile *freeMapFile;   /*!< Bit map of free disk blocks,
                             represented as a file
                            */
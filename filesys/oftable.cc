@@ -181,6 +181,7 @@ OpenFileTable::Close(char *name) {
   if (num != ERROR) {          // the file is in the table
     table[num]->numthread--;   // the thread has no longer this file opened
     if (table[num]->numthread <= 0) {   // if no threads has this file opened
+      g_file_system->SaveReadCount(table[num]->sector);
       DEBUG('f', (char *) "File %s is no more in the table\n", name);
       delete table[num];   // then remove it from the table
       table[num] = NULL;
@@ -25,12 +25,16 @@
 */
 
 #include "filesys/openfile.h"
-#include "drivers/drvDisk.h"
+#include "drivers/drvVolume.h"
 #include "filesys/filehdr.h"
 #include "kernel/msgerror.h"
 #include "kernel/system.h"
+#include "utility/profile.h"
 #include <strings.h>
 
+//! Most sectors sent to the volume in a single request
+#define TRANSFER_SECTORS 32
+
 //----------------------------------------------------------------------
 // OpenFile::OpenFile
 /*! 	Open a Nachos file for reading and writing.  Bring the file header
@@ -128,7 +132,8 @@ OpenFile::Write(char *into, int numBytes) {
 //	sector at a time.
 //
 //	We read in all of the full or partial sectors that are part of the
-//	   request, but we only copy the part we are interested in.
+//	   request, but we only copy the part we are interested in. They
+//	   are read TRANSFER_SECTORS at a time at most.
 //
 //	\param into  the buffer to contain the data to be read from disk
 //	\param numBytes the number of bytes to transfer
@@ -138,8 +143,9 @@ OpenFile::Write(char *into, int numBytes) {
 //----------------------------------------------------------------------
 int
 OpenFile::ReadAt(char *into, int numBytes, int position) {
+  PROFILE_ZONE(PROFILE_READAT);
   int fileLength = hdr->FileLength();
-  int i, firstSector, lastSector, numSectors;
+  int i, firstSector, lastSector, numSectors, count;
 
   // Check if the location in the file is valid
   if ((numBytes <= 0) || (position < 0) || (position >= fileLength))
@@ -150,19 +156,31 @@ OpenFile::ReadAt(char *into, int numBytes, int position) {
   DEBUG('f', (char *) "Reading %d bytes at %d, from file of length %d.\n",
         numBytes, position, fileLength);
 
-  // Compute the list of sectors to be read
-  firstSector = divRoundDown(position, g_cfg->SectorSize);
-  lastSector = divRoundDown(position + numBytes - 1, g_cfg->SectorSize);
-  numSectors = 1 + lastSector - firstSector;
+  char buf[TRANSFER_SECTORS * g_cfg->SectorSize];
+  uint32_t sectors[TRANSFER_SECTORS];
+  for (int done = 0; done < numBytes; done += count) {
+    // Compute the list of sectors to be read
+    firstSector = divRoundDown(position + done, g_cfg->SectorSize);
+    lastSector = divRoundDown(position + numBytes - 1, g_cfg->SectorSize);
+    if (lastSector >= firstSector + TRANSFER_SECTORS)
+      lastSector = firstSector + TRANSFER_SECTORS - 1;
+    numSectors = 1 + lastSector - firstSector;
+    count = (lastSector + 1) * g_cfg->SectorSize - (position + done);
+    if (count > numBytes - done)
+      count = numBytes - done;
 
-  // read in all the full and partial sectors that we need
-  char buf[numSectors * g_cfg->SectorSize];
-  for (i = firstSector; i <= lastSector; i++)
-    g_disk_driver->ReadSector(hdr->ByteToSector(i * g_cfg->SectorSize),
-                              &buf[(i - firstSector) * g_cfg->SectorSize]);
+    // read in all the full and partial sectors that we need, in a
+    // single request so that the disks of the volume work in parallel
+    for (i = firstSector; i <= lastSector; i++)
+      sectors[i - firstSector] = hdr->ByteToSector(i * g_cfg->SectorSize);
+    g_volume_driver->ReadSectors(sectors, numSectors, buf);
+    if (g_cfg->Defragment && !hdr->IsDir())
+      g_file_system->CountReads(fSector, numSectors);
 
-  // copy the part we want
-  bcopy(&buf[position - (firstSector * g_cfg->SectorSize)], into, numBytes);
+    // copy the part we want
+    bcopy(&buf[position + done - (firstSector * g_cfg->SectorSize)],
+          into + done, count);
+  }
   return numBytes;
 }
 
@@ -180,7 +198,8 @@ OpenFile::ReadAt(char *into, int numBytes, int position) {
 //	   We must first read in any sectors that will be partially written,
 //	   so that we don't overwrite the unmodified portion.  We then copy
 //	   in the data that will be modified, and write back all the full
-//	   or partial sectors that are part of the request.
+//	   or partial sectors that are part of the request, TRANSFER_SECTORS
+//	   at a time at most.
 //
 //	\param from the buffer containing the data to be written to disk
 //	\param numBytes the number of bytes to transfer
@@ -192,7 +211,7 @@ int
 OpenFile::WriteAt(char *from, int numBytes, int position) {
   int fileLength = hdr->FileLength();
   int maxFileLength = hdr->MaxFileLength();
-  int i, firstSector, lastSector, numSectors;
+  int i, firstSector, lastSector, numSectors, count;
   bool firstAligned, lastAligned;
 
   // Check the location in the file is valid
@@ -218,31 +237,40 @@ OpenFile::WriteAt(char *from, int numBytes, int position) {
   DEBUG('f', (char *) "Writing %d bytes at %d, to file of length %d.\n",
         numBytes, position, fileLength);
 
-  // Compute the list of sectors to be written
-  firstSector = divRoundDown(position, g_cfg->SectorSize);
-  lastSector = divRoundDown(position + numBytes - 1, g_cfg->SectorSize);
-  numSectors = 1 + lastSector - firstSector;
-
-  char buf[numSectors * g_cfg->SectorSize];
+  char buf[TRANSFER_SECTORS * g_cfg->SectorSize];
+  uint32_t sectors[TRANSFER_SECTORS];
+  for (int done = 0; done < numBytes; done += count) {
+    // Compute the list of sectors to be written
+    firstSector = divRoundDown(position + done, g_cfg->SectorSize);
+    lastSector = divRoundDown(position + numBytes - 1, g_cfg->SectorSize);
+    if (lastSector >= firstSector + TRANSFER_SECTORS)
+      lastSector = firstSector + TRANSFER_SECTORS - 1;
+    numSectors = 1 + lastSector - firstSector;
+    count = (lastSector + 1) * g_cfg->SectorSize - (position + done);
+    if (count > numBytes - done)
+      count = numBytes - done;
 
-  firstAligned = ((uint32_t) position == (firstSector * g_cfg->SectorSize));
-  lastAligned = ((uint32_t) (position + numBytes) ==
-                 ((lastSector + 1) * g_cfg->SectorSize));
+    firstAligned = ((uint32_t) (position + done) ==
+                    (firstSector * g_cfg->SectorSize));
+    lastAligned = ((uint32_t) (position + done + count) ==
+                   ((lastSector + 1) * g_cfg->SectorSize));
 
-  // read in first and last sector, if they are to be partially modified
-  if (!firstAligned)
-    ReadAt(buf, g_cfg->SectorSize, firstSector * g_cfg->SectorSize);
-  if (!lastAligned && ((firstSector != lastSector) || firstAligned))
-    ReadAt(&buf[(lastSector - firstSector) * g_cfg->SectorSize],
-           g_cfg->SectorSize, lastSector * g_cfg->SectorSize);
+    // read in first and last sector, if they are to be partially modified
+    if (!firstAligned)
+      ReadAt(buf, g_cfg->SectorSize, firstSector * g_cfg->SectorSize);
+    if (!lastAligned && ((firstSector != lastSector) || firstAligned))
+      ReadAt(&buf[(lastSector - firstSector) * g_cfg->SectorSize],
+             g_cfg->SectorSize, lastSector * g_cfg->SectorSize);
 
-  // copy in the bytes we want to change
-  bcopy(from, &buf[position - (firstSector * g_cfg->SectorSize)], numBytes);
+    // copy in the bytes we want to change
+    bcopy(from + done,
+          &buf[position + done - (firstSector * g_cfg->SectorSize)], count);
 
-  // write modified sectors back
-  for (i = firstSector; i <= lastSector; i++)
-    g_disk_driver->WriteSector(hdr->ByteToSector(i * g_cfg->SectorSize),
-                               &buf[(i - firstSector) * g_cfg->SectorSize]);
+    // write modified sectors back, in a single request
+    for (i = firstSector; i <= lastSector; i++)
+      sectors[i - firstSector] = hdr->ByteToSector(i * g_cfg->SectorSize);
+    g_volume_driver->WriteSectors(sectors, numSectors, buf);
+  }
   return numBytes;
 }
 
@@ -263,6 +291,14 @@ OpenFile::GetFileHeader() {
   return hdr;
 }
 //----------------------------------------------------------------------
+// OpenFile::GetSector
+//! 	Return the sector of the file's header.
+//----------------------------------------------------------------------
+int
+OpenFile::GetSector() {
+  return fSector;
+}
+//----------------------------------------------------------------------
 // OpenFile::IsDir
 //! 	Return true if the file is a directory.
 //----------------------------------------------------------------------
@@ -75,6 +75,8 @@ public:
                                  */
   FileHeader *GetFileHeader();   //!< return the file's header
 
+  int GetSector();   //!< return the sector of the file's header
+
   char *GetName();   //!< return the file's name
 
   void SetName(char *);   //!< Set the file's name
@@ -80,22 +80,37 @@ AddrSpace::AddrSpace(OpenFile *exec_file, Process *p, int *err) {
 
   // Read the 16 first bytes of the Header to check if the
   // file is 32 or 64 bits
-  exec_file->ReadAt((char *) &eident, 16, 0);
+  if (exec_file->ReadAt((char *) &eident, 16, 0) != 16) {
+    *err = EXEC_FILE_FORMAT_ERROR;
+    return;
+  }
   if (eident[EI_CLASS] == ELFCLASS32)
     is32Bits = 1;
   else if (eident[EI_CLASS] == ELFCLASS64)
     is32Bits = 0;
   else {
-    printf("Error, the ELF File was not recognized as a 32 or 64 bits file, "
-           "exiting.\n");
-    exit(ERROR);
+    DEBUG('a', (char *) "ELF file %s is neither 32 nor 64 bits\n",
+          exec_file->GetName());
+    *err = EXEC_FILE_FORMAT_ERROR;
+    return;
   }
 
-  // Read elf header and check file format
+  // Read elf header and check file format, and that the segments fit
+  // in the file
   ElfFile elff(exec_file, is32Bits, err);
   if (*err != NO_ERROR) {
-    printf("Error, wrong file format for ELF file, exiting.\n");
-    exit(ERROR);
+    DEBUG('a', (char *) "Wrong file format for ELF file %s\n",
+          exec_file->GetName());
+    return;
+  }
+
+  // The segments must start on a page boundary
+  for (int i = 0; i < elff.getPhNum(); i++) {
+    if ((elff.getPhType(i) == PT_LOAD) && (elff.getPhMemSize(i) > 0) &&
+        ((elff.getPhAddr(i) % g_cfg->PageSize) != 0)) {
+      *err = EXEC_FILE_FORMAT_ERROR;
+      return;
+    }
   }
 
   printf("\n****  Loading file %s :\n", exec_file->GetName());
@@ -103,57 +118,68 @@ AddrSpace::AddrSpace(OpenFile *exec_file, Process *p, int *err) {
   // Create an empty translation table
   translationTable = new TranslationTable();
 
+  // Describe the sections of the file, for debugging purpose only
+  if (elff.hasSections()) {
+    for (int i = 0; i < elff.getShNum(); i++)
+      DEBUG('a',
+            (char *) "Section %d : size=0x%x addr=0x%x name=\"%s\"\n", i,
+            (unsigned) elff.getShSize(i), (unsigned) elff.getShAddr(i),
+            elff.getShName(i));
+  }
+
   // Compute the highest virtual address to init the translation table
   uint64_t mem_topaddr = 0;
-  for (int i = 0; i < elff.getShNum(); i++) {
-    // Ignore empty sections
-    if (elff.getShSize(i) <= 0)
+  for (int i = 0; i < elff.getPhNum(); i++) {
+    // Ignore empty segments and segments which are not loaded
+    if ((elff.getPhType(i) != PT_LOAD) || (elff.getPhMemSize(i) <= 0))
       continue;
-    uint64_t section_topaddr = elff.getShAddr(i) + elff.getShSize(i);
-    if ((elff.getShFlags(i) & SHF_ALLOC) && (section_topaddr > mem_topaddr))
-      mem_topaddr = section_topaddr;
+    uint64_t segment_topaddr = elff.getPhAddr(i) + elff.getPhMemSize(i);
+    if (segment_topaddr > mem_topaddr)
+      mem_topaddr = segment_topaddr;
   }
 
-  // Allocate space in virtual memory
-  int base_addr = this->Alloc(divRoundUp(mem_topaddr, g_cfg->PageSize));
+  // Allocate space in virtual memory, the program must fit in the
+  // translation table
+  uint64_t top_pages = divRoundUp(mem_topaddr, g_cfg->PageSize);
+  if (top_pages >= (uint64_t) translationTable->getMaxNumPages()) {
+    *err = OUT_OF_MEMORY;
+    return;
+  }
+  int base_addr = this->Alloc(top_pages);
   // Make sure this region really starts at virtual address 0
   ASSERT(base_addr == 0);
 
   DEBUG('a', (char *) "Allocated virtual area [0x0,0x%x[ for program\n",
         mem_topaddr);
 
-  // Loading of all sections
-  for (int i = 0; i < elff.getShNum(); i++) {
-    // Retrieve the section name
-    const char *section_name = elff.getShName(i);
-
-    DEBUG('a', (char *) "Section %d : size=0x%x name=\"%s\"\n", i,
-          elff.getShSize(i), section_name);
-
-    // Ignore empty sections
-    if (elff.getShSize(i) <= 0)
+  // Loading of all PT_LOAD segments
+  for (int i = 0; i < elff.getPhNum(); i++) {
+    // Ignore empty segments and segments which are not loaded
+    if ((elff.getPhType(i) != PT_LOAD) || (elff.getPhMemSize(i) <= 0))
       continue;
 
-    // Look if this section has to be loaded (SHF_ALLOC flag)
-    if (!(elff.getShFlags(i) & SHF_ALLOC))
-      continue;
-
-    printf("\t- Section %s : file offset 0x%x, size 0x%x, addr 0x%x, %s%s\n",
-           section_name, (unsigned) elff.getShOffset(i),
-           (unsigned) elff.getShSize(i), (unsigned) elff.getShAddr(i),
-           (elff.getShFlags(i) & SHF_WRITE) ? "R/W" : "R",
-           (elff.getShFlags(i) & SHF_EXECINSTR) ? "/X" : "");
-
-    // Make sure section is aligned on page boundary
-    ASSERT((elff.getShAddr(i) % g_cfg->PageSize) == 0);
-
-
-    // Initializes the page table entries and loads the section
-    // in memory (demand paging will be implemented later on)
-    for (unsigned int pgdisk = 0,
-                      virt_page = elff.getShAddr(i) / g_cfg->PageSize;
-         pgdisk < divRoundUp(elff.getShSize(i), g_cfg->PageSize);
-         pgdisk++, virt_page++) {
+    uint64_t filesz = elff.getPhFileSize(i);
+    uint64_t memsz = elff.getPhMemSize(i);
+    bool writable = (elff.getPhFlags(i) & PF_W) != 0;
+
+    printf("\t- Segment %d : file offset 0x%x, file size 0x%x, mem size 0x%x, "
+           "addr 0x%x, %s%s\n",
+           i, (unsigned) elff.getPhOffset(i), (unsigned) filesz,
+           (unsigned) memsz, (unsigned) elff.getPhAddr(i),
+           writable ? "R/W" : "R",
+           (elff.getPhFlags(i) & PF_X) ? "/X" : "");
+
+    unsigned int first_page = elff.getPhAddr(i) / g_cfg->PageSize;
+    unsigned int nb_pages = divRoundUp(memsz, g_cfg->PageSize);
+    // The pages with no image in the executable file (bss) are given
+    // filled with zeroes
+    unsigned int zero_page = first_page + divRoundUp(filesz, g_cfg->PageSize);
+
+    // Initializes the page table entries of the segment and gives them
+    // a physical page (demand paging will be implemented later on)
+    bool contiguous = true;
+    for (unsigned int virt_page = first_page;
+         virt_page < first_page + nb_pages; virt_page++) {
 
       /* Without demand paging */
 
@@ -161,54 +187,73 @@ AddrSpace::AddrSpace(OpenFile *exec_file, Process *p, int *err) {
       translationTable->clearBitSwap(virt_page);
       translationTable->setBitReadAllowed(virt_page);
 
-      if (elff.getShFlags(i) & SHF_WRITE)
+      if (writable)
         translationTable->setBitWriteAllowed(virt_page);
       else
         translationTable->clearBitWriteAllowed(virt_page);
       translationTable->clearBitIo(virt_page);
 
-      // Get a page in physical memory, halt of there is not sufficient space
-      int pp = g_physical_mem_manager->FindFreePage();
-      if (pp == INVALID_PAGE) {
+      // Get a page in physical memory (or a whole superpage), halt of
+      // there is not sufficient space
+      if (!translationTable->getBitValid(virt_page) &&
+          (MapPhysicalPages(virt_page, first_page + nb_pages, zero_page) ==
+           0)) {
         printf("Not enough free space to load program %s\n",
                exec_file->GetName());
         g_machine->interrupt->Halt(ERROR);
       }
-      g_physical_mem_manager->tpr[pp].virtualPage = virt_page;
-      g_physical_mem_manager->tpr[pp].owner = this;
-      g_physical_mem_manager->tpr[pp].locked = true;
-      translationTable->setPhysicalPage(virt_page, pp);
-
-      // The SHT_NOBITS flag indicates if the section has an image
-      // in the executable file (text or data section) or not
-      // (bss section)
-      if (elff.getShType(i) != SHT_NOBITS) {
-        // The section has an image in the executable file
-        // Read it from the disk
-        exec_file->ReadAt(
-            (char *) &(g_machine->mainMemory[translationTable->getPhysicalPage(
-                                                 virt_page) *
-                                             g_cfg->PageSize]),
-            g_cfg->PageSize, elff.getShOffset(i) + pgdisk * g_cfg->PageSize);
-
-      } else {
-        // The section does not have an image in the executable
-        // Fill it with zeroes
-        memset(&(g_machine
-                     ->mainMemory[translationTable->getPhysicalPage(virt_page) *
-                                  g_cfg->PageSize]),
-               0, g_cfg->PageSize);
-      }
+      int pp = translationTable->getPhysicalPage(virt_page);
+      if ((virt_page != first_page) &&
+          (pp != translationTable->getPhysicalPage(virt_page - 1) + 1))
+        contiguous = false;
 
-      // The page has been loded in physical memory but
-      // later-on will be saved in the swap disk. We have to indicate this
-      // in the translation table
-      translationTable->setAddrDisk(virt_page, INVALID_SECTOR);
+      /* End of code without demand paging */
+    }
 
-      // The entry is valid
-      translationTable->setBitValid(virt_page);
+    // Read the file image of the segment with sequential reads of
+    // LOAD_CHUNK bytes at most (OpenFile::ReadAt buffers its request
+    // on the kernel stack), directly into physical memory when its
+    // frames are consecutive
+#define LOAD_CHUNK 4096
+    if (filesz > 0) {
+      uint64_t chunk = (LOAD_CHUNK / g_cfg->PageSize) * g_cfg->PageSize;
+      if (chunk == 0)
+        chunk = g_cfg->PageSize;
+      char *image = contiguous ? NULL : new char[chunk];
+      for (uint64_t done = 0; done < filesz; done += chunk) {
+        uint64_t lg = filesz - done;
+        if (lg > chunk)
+          lg = chunk;
+        if (contiguous) {
+          int pp = translationTable->getPhysicalPage(
+              first_page + done / g_cfg->PageSize);
+          exec_file->ReadAt(
+              (char *) &(g_machine->mainMemory[pp * g_cfg->PageSize]), lg,
+              elff.getPhOffset(i) + done);
+          continue;
+        }
+        exec_file->ReadAt(image, lg, elff.getPhOffset(i) + done);
+        for (uint64_t page = 0; page < lg; page += g_cfg->PageSize) {
+          int pp = translationTable->getPhysicalPage(
+              first_page + (done + page) / g_cfg->PageSize);
+          uint64_t len = lg - page;
+          if (len > g_cfg->PageSize)
+            len = g_cfg->PageSize;
+          memcpy(&(g_machine->mainMemory[pp * g_cfg->PageSize]), image + page,
+                 len);
+        }
+      }
+      delete[] image;
+    }
 
-      /* End of code without demand paging */
+    // The end of the last page with an image in the executable file is
+    // filled with zeroes, the next pages already are
+    if (filesz % g_cfg->PageSize != 0) {
+      int pp = translationTable->getPhysicalPage(first_page +
+                                                 filesz / g_cfg->PageSize);
+      uint64_t offset = filesz % g_cfg->PageSize;
+      memset(&(g_machine->mainMemory[pp * g_cfg->PageSize + offset]), 0,
+             g_cfg->PageSize - offset);
     }
   }
 
@@ -234,6 +279,14 @@ AddrSpace::~AddrSpace() {
     // For every virtual page
     for (i = 0; i < freePageId; i++) {
 
+      // If it belongs to a superpage, free its physical pages at once
+      if (translationTable->isSuperPage(i)) {
+        g_physical_mem_manager->RemoveSuperPageMapping(
+            translationTable->getPhysicalPage(i));
+        i += g_cfg->SuperPageSize - 1;
+        continue;
+      }
+
       // If it is in physical memory, free the physical page
       if (translationTable->getBitValid(i))
         g_physical_mem_manager->RemovePhysicalToVirtualMapping(
@@ -264,17 +317,23 @@ AddrSpace::StackAllocate(void) {
   // Optional : leave an anmapped blank space below the stack to
   // detect stack overflows
 #define STACK_BLANK_LEN 4   // in pages
-  int blankaddr = this->Alloc(STACK_BLANK_LEN);
-  DEBUG('a',
-        (char *) "Allocated unmapped virtual area [0x%x,0x%x[ for stack "
-                 "overflow detection\n",
-        blankaddr * g_cfg->PageSize,
-        (blankaddr + STACK_BLANK_LEN) * g_cfg->PageSize);
-
   // The new stack parameters
   int stackBasePage, numPages;
   numPages = divRoundUp(g_cfg->UserStackSize, g_cfg->PageSize);
 
+  // The blank space is enlarged so that the stack starts on a superpage
+  // boundary, when it can hold at least one superpage
+  int blankLen = STACK_BLANK_LEN;
+  if ((g_cfg->SuperPageSize > 1) && (numPages >= (int) g_cfg->SuperPageSize))
+    blankLen += (g_cfg->SuperPageSize -
+                 (freePageId + STACK_BLANK_LEN) % g_cfg->SuperPageSize) %
+                g_cfg->SuperPageSize;
+  int blankaddr = this->Alloc(blankLen);
+  DEBUG('a',
+        (char *) "Allocated unmapped virtual area [0x%x,0x%x[ for stack "
+                 "overflow detection\n",
+        blankaddr * g_cfg->PageSize, (blankaddr + blankLen) * g_cfg->PageSize);
+
   // Allocate virtual space for the new stack
   stackBasePage = this->Alloc(numPages);
   ASSERT(stackBasePage >= 0);
@@ -289,23 +348,16 @@ AddrSpace::StackAllocate(void) {
 
   for (int i = stackBasePage; i < (stackBasePage + numPages); i++) {
     /* Without demand paging */
-    // Allocate a new physical page for the stack, halt if not page available
-    int pp = g_physical_mem_manager->FindFreePage();
-    if (pp == INVALID_PAGE) {
+    // Allocate a new physical page (or a whole superpage) for the stack,
+    // halt if not page available
+    if (!translationTable->getBitValid(i) &&
+        (MapPhysicalPages(i, stackBasePage + numPages, stackBasePage) ==
+         0)) {
       printf("Not enough free space to load stack\n");
       g_machine->interrupt->Halt(ERROR);
     }
-    g_physical_mem_manager->tpr[pp].virtualPage = i;
-    g_physical_mem_manager->tpr[pp].owner = this;
-    g_physical_mem_manager->tpr[pp].locked = true;
-    translationTable->setPhysicalPage(i, pp);
-
-    // Fill the page with zeroes
-    memset(&(g_machine->mainMemory[translationTable->getPhysicalPage(i) *
-                                   g_cfg->PageSize]),
-           0x0, g_cfg->PageSize);
-    translationTable->setAddrDisk(i, INVALID_SECTOR);
-    translationTable->setBitValid(i);
+
+    // The page is filled with zeroes
     translationTable->clearBitSwap(i);
     translationTable->setBitReadAllowed(i);
     translationTable->setBitWriteAllowed(i);
@@ -318,6 +370,60 @@ AddrSpace::StackAllocate(void) {
   return stackpointer;
 }
 
+//----------------------------------------------------------------------
+/**  Give physical pages to the virtual pages starting at virtualPage.
+//   A whole superpage is mapped when virtualPage starts a block lying
+//   before endPage and a run of free physical pages is available, a
+//   single page otherwise. The physical pages are locked and the
+//   entries valid, the caller sets the access rights. The pages from
+//   zeroPage onwards are filled with zeroes, preferably with pages
+//   zeroed ahead of time.
+//
+//    \param virtualPage the first virtual page to map
+//    \param endPage the end of the virtual area being mapped
+//    \param zeroPage the first virtual page of the area to fill with
+//      zeroes
+//    \return the number of virtual pages mapped, 0 when no physical page
+//      is available
+*/
+//----------------------------------------------------------------------
+int
+AddrSpace::MapPhysicalPages(uint64_t virtualPage, uint64_t endPage,
+                            uint64_t zeroPage) {
+  uint64_t size = g_cfg->SuperPageSize;
+  int pp = INVALID_PAGE;
+
+  if ((virtualPage % size == 0) && (virtualPage + size <= endPage))
+    pp = g_physical_mem_manager->FindFreeRun(virtualPage + size > zeroPage);
+  if (pp == INVALID_PAGE) {
+    pp = g_physical_mem_manager->FindFreePage(virtualPage >= zeroPage);
+    if (pp == INVALID_PAGE)
+      return 0;
+    size = 1;
+  }
+
+  for (uint64_t i = 0; i < size; i++) {
+    g_physical_mem_manager->tpr[pp + i].virtualPage = virtualPage + i;
+    g_physical_mem_manager->tpr[pp + i].owner = this;
+    g_physical_mem_manager->tpr[pp + i].locked = true;
+    translationTable->setPhysicalPage(virtualPage + i, pp + i);
+
+    // The page has been loded in physical memory but
+    // later-on will be saved in the swap disk. We have to indicate this
+    // in the translation table
+    translationTable->setAddrDisk(virtualPage + i, INVALID_SECTOR);
+
+    // The entry is valid
+    translationTable->setBitValid(virtualPage + i);
+  }
+  if (size > 1) {
+    DEBUG('a', (char *) "Superpage at virtual page %d, physical page %d\n",
+          (int) virtualPage, pp);
+    translationTable->setSuperPage(virtualPage);
+  }
+  return size;
+}
+
 //----------------------------------------------------------------------
 /**  Allocate numPages virtual pages in the current address space
 //
@@ -129,6 +129,19 @@ private:
    */
   int Alloc(int numPages);
 
+  /**  Give physical pages to the virtual pages starting at virtualPage,
+   //   a whole superpage when possible
+   //
+   //    \param virtualPage the first virtual page to map
+   //    \param endPage the end of the virtual area being mapped
+   //    \param zeroPage the first virtual page of the area to fill
+   //      with zeroes
+   //    \return the number of virtual pages mapped, 0 when no physical
+   //      page is available
+   */
+  int MapPhysicalPages(uint64_t virtualPage, uint64_t endPage,
+                       uint64_t zeroPage);
+
   /** Number of the next virtual page to be allocated.
     Virtual addresses allocated in a very simple manner : an
     allocation will simply increment this address by
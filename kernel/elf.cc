@@ -6,6 +6,12 @@
 
 #include "elf.h"
 
+//! Tell if "size" bytes at "offset" are within a file of "length" bytes
+static bool
+InFile(uint64_t offset, uint64_t size, uint64_t length) {
+  return (offset <= length) && (size <= length - offset);
+}
+
 /** 	Management of ELF files, called when loading a new program in memory
  //
  //	\param exec_file is the file containing the object code
@@ -17,42 +23,116 @@ ElfFile::ElfFile(OpenFile *exec_file, char is32bits, int *err) {
   // Type of Elf header
   this->is32Hdr = is32bits;
   this->incorrect_header = 0;
+  program_table32 = NULL;
+  program_table64 = NULL;
+  section_table32 = NULL;
+  section_table64 = NULL;
+  shnames = NULL;
+  shnames_size = 0;
+  uint64_t length = exec_file->Length();
 
   // Read header and check validity
+  *err = EXEC_FILE_FORMAT_ERROR;
   if (this->is32Hdr) {
-    exec_file->ReadAt((char *) &elf32Hdr, sizeof(elf32Hdr), 0);
-    CheckELF32Header(&this->elf32Hdr, err);
+    if (exec_file->ReadAt((char *) &elf32Hdr, sizeof(elf32Hdr), 0) ==
+        sizeof(elf32Hdr))
+      CheckELF32Header(&this->elf32Hdr, err);
   } else {
-    exec_file->ReadAt((char *) &elf64Hdr, sizeof(elf64Hdr), 0);
-    CheckELF64Header(&this->elf64Hdr, err);
+    if (exec_file->ReadAt((char *) &elf64Hdr, sizeof(elf64Hdr), 0) ==
+        sizeof(elf64Hdr))
+      CheckELF64Header(&this->elf64Hdr, err);
   }
+  if ((*err == NO_ERROR) &&
+      (this->is32Hdr ? !InFile(elf32Hdr.e_phoff,
+                               elf32Hdr.e_phnum * sizeof(Elf32_Phdr), length)
+                     : !InFile(elf64Hdr.e_phoff,
+                               elf64Hdr.e_phnum * sizeof(Elf64_Phdr), length)))
+    *err = EXEC_FILE_FORMAT_ERROR;
   if (*err != NO_ERROR) {
     this->incorrect_header = 1;
     return;
   }
 
+  // Read the program header table, which drives the loading
+  if (this->is32Hdr) {
+    program_table32 =
+        (Elf32_Phdr *) new char[elf32Hdr.e_phnum * sizeof(Elf32_Phdr)];
+    exec_file->ReadAt((char *) program_table32,
+                      elf32Hdr.e_phnum * sizeof(Elf32_Phdr), elf32Hdr.e_phoff);
+  } else {
+    program_table64 =
+        (Elf64_Phdr *) new char[elf64Hdr.e_phnum * sizeof(Elf64_Phdr)];
+    exec_file->ReadAt((char *) program_table64,
+                      elf64Hdr.e_phnum * sizeof(Elf64_Phdr), elf64Hdr.e_phoff);
+  }
+  CheckSegments(length, err);
+  if (*err != NO_ERROR)
+    return;
+
+  // The section table and the section names are only needed to
+  // describe the file when debugging: they are skipped when they do
+  // not fit in the file
+  if (!DebugIsEnabled('a'))
+    return;
+
   // Read section table
   if (this->is32Hdr) {
+    if (!InFile(elf32Hdr.e_shoff, elf32Hdr.e_shnum * sizeof(Elf32_Shdr),
+                length))
+      return;
     section_table32 =
-        (Elf32_Shdr *) new char[elf32Hdr.e_shnum * sizeof(elf32Hdr)];
+        (Elf32_Shdr *) new char[elf32Hdr.e_shnum * sizeof(Elf32_Shdr)];
     exec_file->ReadAt((char *) section_table32,
-                      elf32Hdr.e_shnum * sizeof(elf32Hdr), elf32Hdr.e_shoff);
+                      elf32Hdr.e_shnum * sizeof(Elf32_Shdr), elf32Hdr.e_shoff);
     // Read section names
     shname_section32 = &section_table32[elf32Hdr.e_shstrndx];
-    shnames = new char[shname_section32->sh_size];
-    exec_file->ReadAt(shnames, shname_section32->sh_size,
-                      shname_section32->sh_offset);
+    if (!InFile(shname_section32->sh_offset, shname_section32->sh_size,
+                length))
+      return;
+    shnames_size = shname_section32->sh_size;
+    shnames = new char[shnames_size + 1];
+    exec_file->ReadAt(shnames, shnames_size, shname_section32->sh_offset);
   } else {
+    if (!InFile(elf64Hdr.e_shoff, elf64Hdr.e_shnum * sizeof(Elf64_Shdr),
+                length))
+      return;
     section_table64 =
-        (Elf64_Shdr *) new char[elf64Hdr.e_shnum * sizeof(elf64Hdr)];
+        (Elf64_Shdr *) new char[elf64Hdr.e_shnum * sizeof(Elf64_Shdr)];
     exec_file->ReadAt((char *) section_table64,
-                      elf64Hdr.e_shnum * sizeof(elf64Hdr), elf64Hdr.e_shoff);
+                      elf64Hdr.e_shnum * sizeof(Elf64_Shdr), elf64Hdr.e_shoff);
     // Read section names
     shname_section64 = &section_table64[elf64Hdr.e_shstrndx];
-    shnames = new char[shname_section64->sh_size];
-    exec_file->ReadAt(shnames, shname_section64->sh_size,
-                      shname_section64->sh_offset);
+    if (!InFile(shname_section64->sh_offset, shname_section64->sh_size,
+                length))
+      return;
+    shnames_size = shname_section64->sh_size;
+    shnames = new char[shnames_size + 1];
+    exec_file->ReadAt(shnames, shnames_size, shname_section64->sh_offset);
   }
+  // The names are looked up by offset, the last one must end
+  shnames[shnames_size] = '\0';
+}
+
+/** 	Check that every segment to load has its file image within the
+ //	file, no larger than its size in memory, and does not wrap
+ //	around the address space.
+ //
+ //	\param fileLength is the length of the executable file
+ //	\param err: NO_ERROR if OK, EXEC_FILE_FORMAT_ERROR otherwise
+ */
+void
+ElfFile::CheckSegments(uint64_t fileLength, int *err) {
+  for (int i = 0; i < getPhNum(); i++) {
+    if ((getPhType(i) != PT_LOAD) || (getPhMemSize(i) == 0))
+      continue;
+    if ((getPhFileSize(i) > getPhMemSize(i)) ||
+        !InFile(getPhOffset(i), getPhFileSize(i), fileLength) ||
+        (getPhAddr(i) + getPhMemSize(i) < getPhAddr(i))) {
+      *err = EXEC_FILE_FORMAT_ERROR;
+      return;
+    }
+  }
+  *err = NO_ERROR;
 }
 
 void
@@ -93,7 +173,14 @@ ElfFile::CheckELF32Header(Elf32_Ehdr *elfHdr, int *err) {
   /* Make sure ELF file internal structures are consistent with what
      we expect */
   if (elfHdr->e_ehsize != sizeof(Elf32_Ehdr) ||
-      elfHdr->e_shentsize != sizeof(Elf32_Shdr)) {
+      elfHdr->e_shentsize != sizeof(Elf32_Shdr) ||
+      elfHdr->e_phentsize != sizeof(Elf32_Phdr)) {
+    *err = EXEC_FILE_FORMAT_ERROR;
+    return;
+  }
+
+  /* Make sure ELF program header table is available */
+  if (elfHdr->e_phnum == 0 || elfHdr->e_phoff < sizeof(Elf32_Ehdr)) {
     *err = EXEC_FILE_FORMAT_ERROR;
     return;
   }
@@ -150,7 +237,14 @@ ElfFile::CheckELF64Header(Elf64_Ehdr *elfHdr, int *err) {
   /* Make sure ELF file internal structures are consistent with what
      we expect */
   if (elfHdr->e_ehsize != sizeof(Elf64_Ehdr) ||
-      elfHdr->e_shentsize != sizeof(Elf64_Shdr)) {
+      elfHdr->e_shentsize != sizeof(Elf64_Shdr) ||
+      elfHdr->e_phentsize != sizeof(Elf64_Phdr)) {
+    *err = EXEC_FILE_FORMAT_ERROR;
+    return;
+  }
+
+  /* Make sure ELF program header table is available */
+  if (elfHdr->e_phnum == 0 || elfHdr->e_phoff < sizeof(Elf64_Ehdr)) {
     *err = EXEC_FILE_FORMAT_ERROR;
     return;
   }
@@ -121,18 +121,47 @@ typedef struct {
 #define EV_NONE    0 /* invalid version */
 #define EV_CURRENT 1 /* current version */
 
-//! Program header
+//! Program header (only used fields are commented)
+// ELF 32 bits
 typedef struct {
-  Elf32_Word p_type;
-  Elf32_Off p_offset;
-  Elf32_Addr p_vaddr;
+  Elf32_Word p_type;     //!< Segment type (see below)
+  Elf32_Off p_offset;    //!< Segment offset in file
+  Elf32_Addr p_vaddr;    //!< Segment virtual address
   Elf32_Addr p_paddr;
-  Elf32_Word p_filesz;
-  Elf32_Word p_memsz;
-  Elf32_Word p_flags;
+  Elf32_Word p_filesz;   //!< Size of the segment image in the file (bytes)
+  Elf32_Word p_memsz;    //!< Size of the segment in memory (bytes)
+  Elf32_Word p_flags;    //!< Segment permissions (see below)
   Elf32_Word p_align;
 } Elf32_Phdr;
 
+// ELF 64 bits
+typedef struct {
+  Elf64_Word p_type;      //!< Segment type (see below)
+  Elf64_Word p_flags;     //!< Segment permissions (see below)
+  Elf64_Off p_offset;     //!< Segment offset in file
+  Elf64_Addr p_vaddr;     //!< Segment virtual address
+  Elf64_Addr p_paddr;
+  Elf64_Xword p_filesz;   //!< Size of the segment image in the file (bytes)
+  Elf64_Xword p_memsz;    //!< Size of the segment in memory (bytes)
+  Elf64_Xword p_align;
+} Elf64_Phdr;
+
+/* segment type */
+#define PT_NULL    0
+#define PT_LOAD    1   //!< The segment has to be loaded in memory
+#define PT_DYNAMIC 2
+#define PT_INTERP  3
+#define PT_NOTE    4
+#define PT_SHLIB   5
+#define PT_PHDR    6
+#define PT_LOPROC  0x70000000
+#define PT_HIPROC  0x7fffffff
+
+/* segment flags */
+#define PF_X 0x1
+#define PF_W 0x2
+#define PF_R 0x4
+
 /* Reserved section table indexes */
 #define SHN_UNDEF     0
 #define SHN_LORESERVE 0xff00
@@ -201,11 +230,17 @@ class ElfFile {
   Elf32_Ehdr elf32Hdr;   // Header du fichier executable
   void CheckELF32Header(Elf32_Ehdr *elfHdr, int *err);
   void CheckELF64Header(Elf64_Ehdr *elfHdr, int *err);
+  void CheckSegments(uint64_t fileLength, int *err);
+  Elf32_Phdr *program_table32;
+  Elf64_Phdr *program_table64;
+  // The section table is only read when the address space debug flag
+  // is set: program loading only relies on the program headers.
   Elf32_Shdr *section_table32;
   Elf64_Shdr *section_table64;
   Elf32_Shdr *shname_section32;
   Elf64_Shdr *shname_section64;
   char *shnames;
+  uint64_t shnames_size;
 
 public:
   /** 	Management of ELF files, called when loading a new program in memory
@@ -216,19 +251,108 @@ public:
    */
   ElfFile(OpenFile *exec_file, char is32bits, int *err);
 
-  /**   Deallocates an address space and in particular frees
-   *   all memory it uses (RAM and swap area).
+  /**   Deallocates the program and section tables read from the file.
    */
   ~ElfFile() {
     if (incorrect_header == 0) {
-      if (is32Hdr)
-        delete section_table32;
-      else
-        delete section_table64;
-      delete shnames;
+      if (is32Hdr) {
+        delete[] (char *) program_table32;
+        delete[] (char *) section_table32;
+      } else {
+        delete[] (char *) program_table64;
+        delete[] (char *) section_table64;
+      }
+      delete[] shnames;
     }
   }
 
+  /**	Tell if the section table was read from the file
+   *      \return true if the section getters can be used
+   */
+  bool hasSections() {
+    if (is32Hdr)
+      return section_table32 != NULL;
+    else
+      return section_table64 != NULL;
+  }
+
+  /**	Get number of segments (program headers) in Elf
+   *      \return number of segments
+   */
+  uint16_t getPhNum() {
+    if (is32Hdr)
+      return elf32Hdr.e_phnum;
+    else
+      return elf64Hdr.e_phnum;
+  }
+
+  /**	Get type of segment number i
+   *      \param i = segment number
+   *      \return type of segment (PT_LOAD, ...)
+   */
+  uint64_t getPhType(int i) {
+    if (is32Hdr)
+      return program_table32[i].p_type;
+    else
+      return program_table64[i].p_type;
+  }
+
+  /**	Get offset in file for segment number i
+   *      \param i = segment number
+   *      \return offset in file (bytes)
+   */
+  uint64_t getPhOffset(int i) {
+    if (is32Hdr)
+      return program_table32[i].p_offset;
+    else
+      return program_table64[i].p_offset;
+  }
+
+  /**	Get virtual address of segment number i
+   *      \param i = segment number
+   *      \return virtual address of segment
+   */
+  uint64_t getPhAddr(int i) {
+    if (is32Hdr)
+      return program_table32[i].p_vaddr;
+    else
+      return program_table64[i].p_vaddr;
+  }
+
+  /**	Get size of the file image of segment number i
+   *      \param i = segment number
+   *      \return size in the file in bytes
+   */
+  uint64_t getPhFileSize(int i) {
+    if (is32Hdr)
+      return program_table32[i].p_filesz;
+    else
+      return program_table64[i].p_filesz;
+  }
+
+  /**	Get size in memory of segment number i. The bytes beyond the
+   *      file image (bss) are filled with zeroes.
+   *      \param i = segment number
+   *      \return size in memory in bytes
+   */
+  uint64_t getPhMemSize(int i) {
+    if (is32Hdr)
+      return program_table32[i].p_memsz;
+    else
+      return program_table64[i].p_memsz;
+  }
+
+  /**	Get permission flags of segment number i
+   *      \param i = segment number
+   *      \return flags of segment (PF_R, PF_W, PF_X)
+   */
+  uint64_t getPhFlags(int i) {
+    if (is32Hdr)
+      return program_table32[i].p_flags;
+    else
+      return program_table64[i].p_flags;
+  }
+
   /**	Get number of sections in Elf
    *      \return number of sections
    */
@@ -309,10 +433,12 @@ public:
    *      \return name of section
    */
   const char *getShName(int i) {
+    uint64_t name;
     if (is32Hdr)
-      return shnames + section_table32[i].sh_name;
+      name = section_table32[i].sh_name;
     else
-      return shnames + section_table64[i].sh_name;
+      name = section_table64[i].sh_name;
+    return (name < shnames_size) ? shnames + name : "";
   }
 };
 
@@ -32,11 +32,14 @@
 #include "drivers/drvConsole.h"
 #include "filesys/oftable.h"
 #include "kernel/msgerror.h"
+#include "kernel/scheduler.h"
 #include "kernel/synch.h"
 #include "kernel/system.h"
 #include "machine/machine.h"
 #include "userlib/syscall.h"
+#include "utility/profile.h"
 #include "vm/pagefaultmanager.h"
+#include <limits.h>
 
 //----------------------------------------------------------------------
 // GetLengthParam
@@ -84,697 +87,1379 @@ GetStringParam(uint64_t addr, char *dest, int maxlen) {
 }
 
 //----------------------------------------------------------------------
-// ExceptionHandler
-/*!   Entry point into the Nachos kernel.  Called when a user program
-//    is executing, and either does a syscall, or generates an addressing
-//    or arithmetic exception.
+// WaitAnyObject
+/*! Find the object of an identifier given to WaitAny, and its type
+//  as recorded by g_object_addrs
 //
-//    For system calls, the calling convention is the following:
-//
-//    - system call identifier -- r17
-//    - arg1 -- r10
-//    - arg2 -- r11
-//    - arg3 -- r12
-//    - arg4 -- r13
+//  \param id the identifier
+//  \param obj where the object is put (NULL for the console and the ACIA)
+//  \param type where the type of the object is put (INVALID_TYPE for the
+//    console and the ACIA)
+//  \return the error code of WaitAny if the object is invalid
+*/
+//----------------------------------------------------------------------
+static int
+WaitAnyObject(int64_t id, void **obj, ObjectType *type) {
+  *obj = NULL;
+  *type = INVALID_TYPE;
+  if (id == CONSOLE_INPUT)
+    return NO_ERROR;
+  if (id == ACIA_INPUT) {
+    if ((g_acia_driver == NULL) || (g_cfg->ACIA != ACIA_INTERRUPT))
+      return NO_ACIA;
+    return NO_ERROR;
+  }
+  void *o = g_object_addrs->SearchObject(id);
+  ObjectType t = g_object_addrs->SearchType(id);
+  if ((o == NULL) ||
+      ((t != SEMAPHORE_TYPE) && (t != LOCK_TYPE) && (t != FILE_TYPE)))
+    return INVALID_WAIT_SET;
+  *obj = o;
+  *type = t;
+  return NO_ERROR;
+}
+
+//----------------------------------------------------------------------
+// WaitAnyTake
+/*! Check if an object given to WaitAny is ready, and take it when it
+//  is a semaphore or a lock. Interrupts must be disabled.
 //
-//    The result of the system call, if any, must be put back into register r10
+//  \param id the identifier of the object
+//  \param obj the object, as found by WaitAnyObject
+//  \param type its type, as found by WaitAnyObject
+*/
+//----------------------------------------------------------------------
+static bool
+WaitAnyTake(int64_t id, void *obj, ObjectType type) {
+  switch (type) {
+  case SEMAPHORE_TYPE:
+    return ((Semaphore *) obj)->TryP();
+  case LOCK_TYPE:
+    return ((Lock *) obj)->TryAcquire();
+  case FILE_TYPE:
+    return true;   // reading a file never waits for an event
+  default:
+    if (id == CONSOLE_INPUT)
+      return g_console_driver->InputReady();
+    return g_acia_driver->MessageReady();
+  }
+}
+
+//----------------------------------------------------------------------
+// WaitAnyWatch
+/*! Put a waiter in (or remove it from) the waiter list of an object
+//  given to WaitAny. Interrupts must be disabled.
 //
-//    \param exceptiontype is the kind of exception.
-//           The list of possible exception are defined in machine.h.
-//    \param vaddr is the address that causes the exception to occur
-//           (when used)
+//  \param id the identifier of the object
+//  \param obj the object, as found by WaitAnyObject
+//  \param type its type, as found by WaitAnyObject
+//  \param w the waiter of the current thread
+//  \param add true to put the waiter in the list, false to remove it
 */
 //----------------------------------------------------------------------
-void
-ExceptionHandler(ExceptionType exceptiontype, int vaddr) {
+static void
+WaitAnyWatch(int64_t id, void *obj, ObjectType type, Waiter *w, bool add) {
+  switch (type) {
+  case SEMAPHORE_TYPE:
+    if (add)
+      ((Semaphore *) obj)->AddWaiter(w);
+    else
+      ((Semaphore *) obj)->RemoveWaiter(w);
+    break;
+  case LOCK_TYPE:
+    if (add)
+      ((Lock *) obj)->AddWaiter(w);
+    else
+      ((Lock *) obj)->RemoveWaiter(w);
+    break;
+  case FILE_TYPE:
+    break;
+  default:
+    if (id == CONSOLE_INPUT) {
+      if (add)
+        g_console_driver->AddWaiter(w);
+      else
+        g_console_driver->RemoveWaiter(w);
+    } else {
+      if (add)
+        g_acia_driver->AddWaiter(w);
+      else
+        g_acia_driver->RemoveWaiter(w);
+    }
+  }
+}
 
-  // Get the content of register 17 (system call number in case
-  // of a system call
-  int type = g_machine->ReadIntRegister(17);
+//----------------------------------------------------------------------
+// SysHalt
+//! 	The halt system call. Stops Nachos.
+//----------------------------------------------------------------------
+static void
+SysHalt() {
+  DEBUG('e', (char *) "Shutdown, initiated by user program.\n");
+  g_machine->interrupt->Halt(NO_ERROR);
+}
 
-  switch (exceptiontype) {
-  case NO_EXCEPTION:
-    printf("Nachos internal error, a NoException exception is raised ...\n");
-    g_machine->interrupt->Halt(NO_ERROR);
-    break;
+//----------------------------------------------------------------------
+// SysSysTime
+//! 	The systime system call. Gets the system time
+//----------------------------------------------------------------------
+static void
+SysSysTime() {
+  DEBUG('e', (char *) "Systime call, initiated by user program.\n");
+  int addr = g_machine->ReadIntRegister(10);
+  uint64_t tick = g_stats->getTotalTicks();
+  uint32_t seconds =
+      (uint32_t) cycle_to_sec(tick, g_cfg->ProcessorFrequency);
+  uint32_t nanos =
+      (uint32_t) cycle_to_nano(tick, g_cfg->ProcessorFrequency);
+  g_machine->mmu->WriteMem(addr, sizeof(uint32_t), seconds);
+  g_machine->mmu->WriteMem(addr + 4, sizeof(uint32_t), nanos);
+}
 
-  case SYSCALL_EXCEPTION: {
+//----------------------------------------------------------------------
+// SysExit
+/*! 	The exit system call
+//	Ends the calling thread
+*/
+//----------------------------------------------------------------------
+static void
+SysExit() {
+  DEBUG('e', (char *) "Thread 0x%x %s exit call.\n", g_current_thread,
+        g_current_thread->GetName());
+  ASSERT(g_current_thread->type == THREAD_TYPE);
+  g_current_thread->Finish();
+}
 
-    // System calls
-    // -------------
-    switch (type) {
-      char msg[MAXSTRLEN];   // Argument for the PError system call
-
-    case SC_HALT:
-      // The halt system call. Stops Nachos.
-      DEBUG('e', (char *) "Shutdown, initiated by user program.\n");
-      g_machine->interrupt->Halt(NO_ERROR);
-      g_syscall_error->SetMsg((char *) "", NO_ERROR);
-      return;
+//----------------------------------------------------------------------
+// SysExec
+/*! 	The exec system call
+//	Creates a new process (thread+address space)
+*/
+//----------------------------------------------------------------------
+static void
+SysExec() {
+  DEBUG('e', (char *) "Process: Exec call.\n");
+  int addr;
+  int size;
+  char name[MAXSTRLEN];
+  int error = NO_ERROR;
 
-    case SC_SYS_TIME: {
-      // The systime system call. Gets the system time
-      DEBUG('e', (char *) "Systime call, initiated by user program.\n");
-      int addr = g_machine->ReadIntRegister(10);
-      uint64_t tick = g_stats->getTotalTicks();
-      uint32_t seconds =
-          (uint32_t) cycle_to_sec(tick, g_cfg->ProcessorFrequency);
-      uint32_t nanos =
-          (uint32_t) cycle_to_nano(tick, g_cfg->ProcessorFrequency);
-      g_machine->mmu->WriteMem(addr, sizeof(uint32_t), seconds);
-      g_machine->mmu->WriteMem(addr + 4, sizeof(uint32_t), nanos);
-      g_syscall_error->SetMsg((char *) "", NO_ERROR);
-      break;
-    }
+  // Get the process name
+  addr = g_machine->ReadIntRegister(10);
+  size = GetLengthParam(addr);
+  char ch[size];
+  GetStringParam(addr, ch, size);
+  sprintf(name, "master thread of process %s", ch);
+  Process *p = new Process(ch, &error);
+  if (error != NO_ERROR) {
+    g_machine->WriteIntRegister(10, ERROR);
+    if (error == OUT_OF_MEMORY)
+      g_syscall_error->SetMsg((char *) "", error);
+    else
+      g_syscall_error->SetMsg(ch, error);
+    return;
+  }
+  Thread *ptThread = new Thread(name);
+  int32_t tid = g_object_addrs->AddObject(ptThread, THREAD_TYPE);
+  error = ptThread->Start(p, p->addrspace->getCodeStartAddress64(), -1);
+  if (error != NO_ERROR) {
+    g_machine->WriteIntRegister(10, ERROR);
+    if (error == OUT_OF_MEMORY)
+      g_syscall_error->SetMsg((char *) "", error);
+    else
+      g_syscall_error->SetMsg(name, error);
+    return;
+  }
+  g_machine->WriteIntRegister(10, tid);
+}
 
-    case SC_EXIT: {
-      // The exit system call
-      // Ends the calling thread
-      DEBUG('e', (char *) "Thread 0x%x %s exit call.\n", g_current_thread,
-            g_current_thread->GetName());
-      ASSERT(g_current_thread->type == THREAD_TYPE);
-      g_current_thread->Finish();
-      break;
-    }
+//----------------------------------------------------------------------
+// SysNewThread
+/*! 	The newThread system call
+//	Create a new thread in the same address space
+*/
+//----------------------------------------------------------------------
+static void
+SysNewThread() {
+  DEBUG('e', (char *) "Multithread: NewThread call.\n");
+  Thread *ptThread;
+  int name_addr;
+  int64_t fun;
+  int arg;
+  int err = NO_ERROR;
+  // Get the address of the string for the name of the thread
+  name_addr = g_machine->ReadIntRegister(10);
+  // Get the pointer to the function to be executed by the new thread
+  fun = g_machine->ReadIntRegister(11);
+  // Get the function parameters
+  arg = g_machine->ReadIntRegister(12);
+  // Build the name of the thread
+  int size = GetLengthParam(name_addr);
+  char thr_name[size];
+  GetStringParam(name_addr, thr_name, size);
+  // char *proc_name = g_current_thread->getProcessOwner()->getName();
+  //  Finally start it
+  ptThread = new Thread(thr_name);
+  int32_t tid = g_object_addrs->AddObject(ptThread, THREAD_TYPE);
+  err = ptThread->Start(g_current_thread->GetProcessOwner(), fun, arg);
+  if (err != NO_ERROR) {
+    g_machine->WriteIntRegister(10, ERROR);
+    g_syscall_error->SetMsg((char *) "", err);
+  } else {
+    g_machine->WriteIntRegister(10, tid);
+  }
+}
 
-    case SC_EXEC: {
-      // The exec system call
-      // Creates a new process (thread+address space)
-      DEBUG('e', (char *) "Process: Exec call.\n");
-      int addr;
-      int size;
-      char name[MAXSTRLEN];
-      int error = NO_ERROR;
-
-      // Get the process name
-      addr = g_machine->ReadIntRegister(10);
-      size = GetLengthParam(addr);
-      char ch[size];
-      GetStringParam(addr, ch, size);
-      sprintf(name, "master thread of process %s", ch);
-      Process *p = new Process(ch, &error);
-      if (error != NO_ERROR) {
-        g_machine->WriteIntRegister(10, ERROR);
-        if (error == OUT_OF_MEMORY)
-          g_syscall_error->SetMsg((char *) "", error);
-        else
-          g_syscall_error->SetMsg(ch, error);
-        break;
-      }
-      Thread *ptThread = new Thread(name);
-      int32_t tid = g_object_addrs->AddObject(ptThread);
-      error = ptThread->Start(p, p->addrspace->getCodeStartAddress64(), -1);
-      if (error != NO_ERROR) {
-        g_machine->WriteIntRegister(10, ERROR);
-        if (error == OUT_OF_MEMORY)
-          g_syscall_error->SetMsg((char *) "", error);
-        else
-          g_syscall_error->SetMsg(name, error);
-        break;
-      }
-      g_syscall_error->SetMsg((char *) "", NO_ERROR);
-      g_machine->WriteIntRegister(10, tid);
-      break;
-    }
+//----------------------------------------------------------------------
+// SysJoin
+/*! 	The join system call
+//	Wait for the thread idThread to finish
+*/
+//----------------------------------------------------------------------
+static void
+SysJoin() {
+  DEBUG('e', (char *) "Process or thread: Join call.\n");
+  int64_t tid;
+  Thread *ptThread;
+  tid = g_machine->ReadIntRegister(10);
+  ptThread = (Thread *) g_object_addrs->SearchObject(tid);
+  if (ptThread && ptThread->type == THREAD_TYPE) {
+    g_current_thread->Join(ptThread);
+    g_machine->WriteIntRegister(10, NO_ERROR);
+  } else
+  // Thread already terminated (type set to INVALID_TYPE) or call on an
+  // object that is not a thread Exit with no error code since we cannot
+  // separate the two cases
+  {
+    g_machine->WriteIntRegister(10, NO_ERROR);
+  }
+  DEBUG('e', (char *) "Fin Join");
+}
 
-    case SC_NEW_THREAD: {
-      // The newThread system call
-      // Create a new thread in the same address space
-      DEBUG('e', (char *) "Multithread: NewThread call.\n");
-      Thread *ptThread;
-      int name_addr;
-      int64_t fun;
-      int arg;
-      int err = NO_ERROR;
-      // Get the address of the string for the name of the thread
-      name_addr = g_machine->ReadIntRegister(10);
-      // Get the pointer to the function to be executed by the new thread
-      fun = g_machine->ReadIntRegister(11);
-      // Get the function parameters
-      arg = g_machine->ReadIntRegister(12);
-      // Build the name of the thread
-      int size = GetLengthParam(name_addr);
-      char thr_name[size];
-      GetStringParam(name_addr, thr_name, size);
-      // char *proc_name = g_current_thread->getProcessOwner()->getName();
-      //  Finally start it
-      ptThread = new Thread(thr_name);
-      int32_t tid = g_object_addrs->AddObject(ptThread);
-      err = ptThread->Start(g_current_thread->GetProcessOwner(), fun, arg);
-      if (err != NO_ERROR) {
-        g_machine->WriteIntRegister(10, ERROR);
-        g_syscall_error->SetMsg((char *) "", err);
-      } else {
-        g_machine->WriteIntRegister(10, tid);
-        g_syscall_error->SetMsg((char *) "", NO_ERROR);
-      }
-      break;
-    }
+//----------------------------------------------------------------------
+// SysYield
+//! 	The Yield system call: let the other threads run.
+//----------------------------------------------------------------------
+static void
+SysYield() {
+  DEBUG('e', (char *) "Process or thread: Yield call.\n");
+  if (g_current_thread->type == THREAD_TYPE) {
+    g_current_thread->Yield();
+    g_machine->WriteIntRegister(10, NO_ERROR);
+  } else {
+    g_syscall_error->SetMsg((char *) "", INVALID_SEMAPHORE_ID);
+    g_machine->WriteIntRegister(10, ERROR);
+  }
+}
 
-    case SC_JOIN: {
-      // The join system call
-      // Wait for the thread idThread to finish
-      DEBUG('e', (char *) "Process or thread: Join call.\n");
-      int64_t tid;
-      Thread *ptThread;
-      tid = g_machine->ReadIntRegister(10);
-      ptThread = (Thread *) g_object_addrs->SearchObject(tid);
-      if (ptThread && ptThread->type == THREAD_TYPE) {
-        g_current_thread->Join(ptThread);
-        g_syscall_error->SetMsg((char *) "", NO_ERROR);
-        g_machine->WriteIntRegister(10, NO_ERROR);
-      } else
-      // Thread already terminated (type set to INVALID_TYPE) or call on an
-      // object that is not a thread Exit with no error code since we cannot
-      // separate the two cases
-      {
-        g_syscall_error->SetMsg((char *) "", NO_ERROR);
-        g_machine->WriteIntRegister(10, NO_ERROR);
-      }
-      DEBUG('e', (char *) "Fin Join");
-      break;
-    }
+//----------------------------------------------------------------------
+// SysPError
+/*! 	the PError system call
+//	print the last error message
+*/
+//----------------------------------------------------------------------
+static void
+SysPError() {
+  DEBUG('e', (char *) "Debug: Perror call.\n");
+  int size;
+  int addr;
+  addr = g_machine->ReadIntRegister(10);
+  size = GetLengthParam(addr);
+  char ch[size];
+  GetStringParam(addr, ch, size);
+  g_syscall_error->PrintLastMsg(g_console_driver, ch);
+}
 
-    case SC_YIELD: {
-      DEBUG('e', (char *) "Process or thread: Yield call.\n");
-      if (g_current_thread->type == THREAD_TYPE) {
-        g_current_thread->Yield();
-        g_syscall_error->SetMsg((char *) "", NO_ERROR);
-        g_machine->WriteIntRegister(10, NO_ERROR);
-      } else {
-        g_syscall_error->SetMsg((char *) "", INVALID_SEMAPHORE_ID);
-        g_machine->WriteIntRegister(10, ERROR);
-      }
-      break;
-    }
+//----------------------------------------------------------------------
+// SysCreate
+/*! 	The create system call
+//	Create a new file in nachos file system
+*/
+//----------------------------------------------------------------------
+static void
+SysCreate() {
+  DEBUG('e', (char *) "Filesystem: Create call.\n");
+  int addr;
+  int size;
+  int ret;
+  int sizep;
+  // Get the name and initial size of the new file
+  addr = g_machine->ReadIntRegister(10);
+  size = g_machine->ReadIntRegister(11);
+  sizep = GetLengthParam(addr);
+  char ch[sizep];
+  GetStringParam(addr, ch, sizep);
+  // Try to create it
+  int err = g_file_system->Create(ch, size);
+  if (err == NO_ERROR) {
+    ret = NO_ERROR;
+  } else {
+    ret = ERROR;
+    if (err == OUT_OF_DISK)
+      g_syscall_error->SetMsg((char *) "", err);
+    else
+      g_syscall_error->SetMsg(ch, err);
+  }
+  g_machine->WriteIntRegister(10, ret);
+}
 
-    case SC_PERROR: {
-      // the PError system call
-      // print the last error message
-      DEBUG('e', (char *) "Debug: Perror call.\n");
-      int size;
-      int addr;
-      addr = g_machine->ReadIntRegister(10);
-      size = GetLengthParam(addr);
-      char ch[size];
-      GetStringParam(addr, ch, size);
-      g_syscall_error->PrintLastMsg(g_console_driver, ch);
-      break;
-    }
+//----------------------------------------------------------------------
+// SysOpen
+/*! 	The open system call
+//	Opens a file and returns an openfile identifier
+*/
+//----------------------------------------------------------------------
+static void
+SysOpen() {
+  DEBUG('e', (char *) "Filesystem: Open call.\n");
+  int addr;
+  int sizep;
+  int ret = 0;
+  // Get the file name
+  addr = g_machine->ReadIntRegister(10);
+  sizep = GetLengthParam(addr);
+  char ch[sizep];
+  GetStringParam(addr, ch, sizep);
+  // Try to open the file
+  OpenFile *file = g_open_file_table->Open(ch);
+  if (file == NULL) {
+    g_syscall_error->SetMsg(ch, OPENFILE_ERROR);
+  } else {
+    ret = g_object_addrs->AddObject(file, FILE_TYPE);
+  }
+  g_machine->WriteIntRegister(10, ret);
+}
 
-    case SC_CREATE: {
-      // The create system call
-      // Create a new file in nachos file system
-      DEBUG('e', (char *) "Filesystem: Create call.\n");
-      int addr;
-      int size;
-      int ret;
-      int sizep;
-      // Get the name and initial size of the new file
-      addr = g_machine->ReadIntRegister(10);
-      size = g_machine->ReadIntRegister(11);
-      sizep = GetLengthParam(addr);
-      char ch[sizep];
-      GetStringParam(addr, ch, sizep);
-      // Try to create it
-      int err = g_file_system->Create(ch, size);
-      if (err == NO_ERROR) {
-        g_syscall_error->SetMsg((char *) "", NO_ERROR);
-        ret = NO_ERROR;
-      } else {
-        ret = ERROR;
-        if (err == OUT_OF_DISK)
-          g_syscall_error->SetMsg((char *) "", err);
-        else
-          g_syscall_error->SetMsg(ch, err);
-      }
-      g_machine->WriteIntRegister(10, ret);
-      break;
-    }
+//----------------------------------------------------------------------
+// SysRead
+/*! 	The read system call
+//	Read in a file or the console
+*/
+//----------------------------------------------------------------------
+static void
+SysRead() {
+  DEBUG('e', (char *) "Filesystem: Read call.\n");
+  int addr;
+  int size;
+  int64_t f;
+  int numread;
+  // Get the buffer address in the machine memory
+  addr = g_machine->ReadIntRegister(10);
+  // Get the requested size
+  size = g_machine->ReadIntRegister(11);
+  // Get the openfile number or 0 (console)
+  f = g_machine->ReadIntRegister(12);
+  char buffer[size];
 
-    case SC_OPEN: {
-      // The open system call
-      // Opens a file and returns an openfile identifier
-      DEBUG('e', (char *) "Filesystem: Open call.\n");
-      int addr;
-      int sizep;
-      int ret = 0;
-      // Get the file name
-      addr = g_machine->ReadIntRegister(10);
-      sizep = GetLengthParam(addr);
-      char ch[sizep];
-      GetStringParam(addr, ch, sizep);
-      // Try to open the file
-      OpenFile *file = g_open_file_table->Open(ch);
-      if (file == NULL) {
-        g_syscall_error->SetMsg(ch, OPENFILE_ERROR);
-      } else {
-        ret = g_object_addrs->AddObject(file);
-        g_syscall_error->SetMsg((char *) "", NO_ERROR);
-      }
-      g_machine->WriteIntRegister(10, ret);
-      break;
+  // Read in a file
+  if (f != CONSOLE_INPUT) {
+    int64_t fid = f;
+    OpenFile *file = (OpenFile *) g_object_addrs->SearchObject(fid);
+    if (file && file->type == FILE_TYPE) {
+      numread = file->Read(buffer, size);
+    } else {
+      numread = ERROR;
+      g_syscall_error->SetId(f, INVALID_FILE_ID);
     }
+  }
+  // Read a line on the console
+  else {
+    numread = g_console_driver->GetString(buffer, size);
+    DEBUG('e', (char *) "Console read. We have %s of size %d\n", buffer,
+          numread);
+  }
+  // copy the buffer into the emulator memory, with the '\0' ending
+  // a console line
+  int ncopy = ((f == CONSOLE_INPUT) && (size > 0)) ? numread + 1 : numread;
+  for (int i = 0; i < ncopy; i++) {
+    g_machine->mmu->WriteMem(addr++, 1, buffer[i]);
+  }
+  g_machine->WriteIntRegister(10, numread);
+}
 
-    case SC_READ: {
-      // The read system call
-      // Read in a file or the console
-      DEBUG('e', (char *) "Filesystem: Read call.\n");
-      int addr;
-      int size;
-      int64_t f;
-      int numread;
-      // Get the buffer address in the machine memory
-      addr = g_machine->ReadIntRegister(10);
-      // Get the requested size
-      size = g_machine->ReadIntRegister(11);
-      // Get the openfile number or 0 (console)
-      f = g_machine->ReadIntRegister(12);
-      char buffer[size];
-
-      // Read in a file
-      if (f != CONSOLE_INPUT) {
-        int64_t fid = f;
-        OpenFile *file = (OpenFile *) g_object_addrs->SearchObject(fid);
-        if (file && file->type == FILE_TYPE) {
-          numread = file->Read(buffer, size);
-          g_syscall_error->SetMsg((char *) "", NO_ERROR);
-        } else {
-          numread = ERROR;
-          sprintf(msg, "%" PRId64 "", f);
-          g_syscall_error->SetMsg(msg, INVALID_FILE_ID);
-        }
-      }
-      // Read on the console
-      else {
-        g_console_driver->GetString(buffer, size);
-        DEBUG('e', (char *) "Console read. We have %s of size %d\n", buffer,
-              size);
-        numread = size;
-        g_syscall_error->SetMsg((char *) "", NO_ERROR);
-      }
-      for (int i = 0; i < numread;
-           i++) {   // copy the buffer into the emulator memory
-        g_machine->mmu->WriteMem(addr++, 1, buffer[i]);
-      }
-      g_machine->WriteIntRegister(10, numread);
-      break;
+//----------------------------------------------------------------------
+// SysWrite
+/*! 	The write system call
+//	Write in a file or at the console
+*/
+//----------------------------------------------------------------------
+static void
+SysWrite() {
+  DEBUG('e', (char *) "Filesystem: Write call.\n");
+  uint64_t addr;
+  int size;
+  uint64_t f;
+  uint64_t c;
+  addr = g_machine->ReadIntRegister(10);
+  size = g_machine->ReadIntRegister(11);
+  // f is the openfileid or 1 (console)
+  f = g_machine->ReadIntRegister(12);
+  char buffer[size];
+  for (int i = 0; i < size; i++) {
+    g_machine->mmu->ReadMem(addr++, 1, &c);
+    buffer[i] = c;
+  }
+  int numwrite;
+  // Write in a file
+  if (f > CONSOLE_OUTPUT) {
+    int64_t fid = f;
+    OpenFile *file = (OpenFile *) g_object_addrs->SearchObject(fid);
+    if (file && file->type == FILE_TYPE) {
+      // write in file
+      numwrite = file->Write(buffer, size);
+    } else {
+      numwrite = ERROR;
+      g_syscall_error->SetId(f, INVALID_FILE_ID);
     }
-
-    case SC_WRITE: {
-      // The write system call
-      // Write in a file or at the console
-      DEBUG('e', (char *) "Filesystem: Write call.\n");
-      uint64_t addr;
-      int size;
-      uint64_t f;
-      uint64_t c;
-      addr = g_machine->ReadIntRegister(10);
-      size = g_machine->ReadIntRegister(11);
-      // f is the openfileid or 1 (console)
-      f = g_machine->ReadIntRegister(12);
-      char buffer[size];
-      for (int i = 0; i < size; i++) {
-        g_machine->mmu->ReadMem(addr++, 1, &c);
-        buffer[i] = c;
-      }
-      int numwrite;
-      // Write in a file
-      if (f > CONSOLE_OUTPUT) {
-        int64_t fid = f;
-        OpenFile *file = (OpenFile *) g_object_addrs->SearchObject(fid);
-        if (file && file->type == FILE_TYPE) {
-          // write in file
-          numwrite = file->Write(buffer, size);
-          g_syscall_error->SetMsg((char *) "", NO_ERROR);
-        } else {
-          numwrite = ERROR;
-          sprintf(msg, "%" PRId64 "", f);
-          g_syscall_error->SetMsg(msg, INVALID_FILE_ID);
-        }
-      }
-      // write at the console
-      else {
-        if (f == CONSOLE_OUTPUT) {
-          g_console_driver->PutString(buffer, size);
-          numwrite = size;
-          g_syscall_error->SetMsg((char *) "", NO_ERROR);
-        } else {
-          numwrite = ERROR;
-          sprintf(msg, "%" PRId64 "", f);
-          g_syscall_error->SetMsg(msg, INVALID_FILE_ID);
-        }
-      }
-      g_machine->WriteIntRegister(10, numwrite);
-      break;
+  }
+  // write at the console
+  else {
+    if (f == CONSOLE_OUTPUT) {
+      g_console_driver->PutString(buffer, size);
+      numwrite = size;
+    } else {
+      numwrite = ERROR;
+      g_syscall_error->SetId(f, INVALID_FILE_ID);
     }
+  }
+  g_machine->WriteIntRegister(10, numwrite);
+}
 
-    case SC_SEEK: {
-      // Seek to a given position in an opened file
-      DEBUG('e', (char *) "Filesystem: Seek call.\n");
-      int offset;
-      int64_t f;
-      int error = NO_ERROR;
-
-      // Get the offset into the file
-      offset = g_machine->ReadIntRegister(10);
-      // Get the openfile number or 1 (console)
-      f = g_machine->ReadIntRegister(11);
-
-      // Seek into a file
-      if (f > CONSOLE_OUTPUT) {
-        int64_t fid = f;
-        OpenFile *file = (OpenFile *) g_object_addrs->SearchObject(fid);
-        if (file && file->type == FILE_TYPE) {
-          file->Seek(offset);
-          g_syscall_error->SetMsg((char *) "", NO_ERROR);
-        } else {
-          error = ERROR;
-          sprintf(msg, "%" PRId64 "", f);
-          g_syscall_error->SetMsg(msg, INVALID_FILE_ID);
-        }
-        g_machine->WriteIntRegister(10, error);
-      } else {
-        g_machine->WriteIntRegister(10, ERROR);
-        sprintf(msg, "%" PRId64 "", f);
-        g_syscall_error->SetMsg(msg, INVALID_FILE_ID);
-      }
-      break;
-    }
+//----------------------------------------------------------------------
+// SysWaitAny
+/*! 	The WaitAny system call. Wait until one of several objects is
+//	ready, the thread being woken up by the objects themselves
+*/
+//----------------------------------------------------------------------
+static void
+SysWaitAny() {
+  DEBUG('e', (char *) "WaitAny call, initiated by user program.\n");
+  uint64_t addr = g_machine->ReadIntRegister(10);
+  int nb = g_machine->ReadIntRegister(11);
+  int64_t timeout = (int32_t) g_machine->ReadIntRegister(12);
 
-    case SC_CLOSE: {
-      // The close system call
-      // Close a file
-      DEBUG('e', (char *) "Filesystem: Close call.\n");
-      // Get the openfile number
-      int64_t fid = g_machine->ReadIntRegister(10);
-      OpenFile *file = (OpenFile *) g_object_addrs->SearchObject(fid);
-      if (file && file->type == FILE_TYPE) {
-        g_open_file_table->Close(file->GetName());
-        g_object_addrs->RemoveObject(fid);
-        delete file;
-        g_machine->WriteIntRegister(10, NO_ERROR);
-        g_syscall_error->SetMsg((char *) "", NO_ERROR);
-      } else {
-        g_machine->WriteIntRegister(10, ERROR);
-        sprintf(msg, "%" PRId64 "", fid);
-        g_syscall_error->SetMsg(msg, INVALID_FILE_ID);
-      }
-      break;
-    }
+  if ((nb <= 0) || (nb > MAX_WAIT_OBJECTS)) {
+    g_syscall_error->SetId(nb, INVALID_WAIT_SET);
+    g_machine->WriteIntRegister(10, ERROR);
+    return;
+  }
+  // Bounded, these arrays are on the kernel stack
+  int64_t ids[MAX_WAIT_OBJECTS];
+  void *objs[MAX_WAIT_OBJECTS];
+  ObjectType types[MAX_WAIT_OBJECTS];
+  int err = NO_ERROR;
+  int64_t badId = 0;
+  for (int i = 0; (i < nb) && (err == NO_ERROR); i++) {
+    uint64_t id;
+    g_machine->mmu->ReadMem(addr + i * sizeof(uint64_t), sizeof(uint64_t),
+                            &id);
+    ids[i] = id;
+    err = WaitAnyObject(ids[i], &objs[i], &types[i]);
+    if (err != NO_ERROR)
+      badId = ids[i];
+  }
+  if (err != NO_ERROR) {
+    g_syscall_error->SetId(badId, err);
+    g_machine->WriteIntRegister(10, ERROR);
+    return;
+  }
 
-    case SC_REMOVE: {
-      // The Remove system call
-      // Remove a file from the file system
-      DEBUG('e', (char *) "Filesystem: Remove call.\n");
-      int ret;
-      int addr;
-      int sizep;
-      // Get the name of the file to be removes
-      addr = g_machine->ReadIntRegister(10);
-      sizep = GetLengthParam(addr);
-      char *ch = new char[sizep];
-      GetStringParam(addr, ch, sizep);
-      // Actually remove it
-      int err = g_open_file_table->Remove(ch);
-      if (err == NO_ERROR) {
-        ret = 0;
-        g_syscall_error->SetMsg((char *) "", NO_ERROR);
-      } else {
-        ret = ERROR;
-        g_syscall_error->SetMsg(ch, err);
-      }
-      g_machine->WriteIntRegister(10, ret);
+  // The objects are checked again each time the thread is woken up,
+  // as another thread may have taken the one which became ready
+  Waiter *w = new Waiter();
+  IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+  int ready = -1;
+  bool watching = false;
+  for (;;) {
+    for (int i = 0; (i < nb) && (ready < 0); i++)
+      if (WaitAnyTake(ids[i], objs[i], types[i]))
+        ready = i;
+    if ((ready >= 0) || (timeout == 0) || w->TimedOut())
       break;
+    if (!watching) {
+      for (int i = 0; i < nb; i++)
+        WaitAnyWatch(ids[i], objs[i], types[i], w, true);
+      if (timeout > 0)
+        w->SetTimeout(timeout * 1000000);
+      watching = true;
     }
+    w->Sleep();
+  }
+  if (watching)
+    for (int i = 0; i < nb; i++)
+      WaitAnyWatch(ids[i], objs[i], types[i], w, false);
+  w->Release();
+  g_machine->interrupt->SetStatus(oldLevel);
 
-    case SC_MKDIR: {
-      // the Mkdir system call
-      // make a new directory in the file system
-      DEBUG('e', (char *) "Filesystem: Mkdir call.\n");
-      int addr;
-      int sizep;
-      addr = g_machine->ReadIntRegister(10);
-      sizep = GetLengthParam(addr);
-      char name[sizep];
-      GetStringParam(addr, name, sizep);
-      // name is the name of the new directory
-      int good = g_file_system->Mkdir(name);
-      if (good != NO_ERROR) {
-        g_machine->WriteIntRegister(10, ERROR);
-        if (good == OUT_OF_DISK)
-          g_syscall_error->SetMsg((char *) "", good);
-        else
-          g_syscall_error->SetMsg(name, good);
-      } else {
-        g_machine->WriteIntRegister(10, ((int) good));
-        g_syscall_error->SetMsg((char *) "", NO_ERROR);
-      }
-      break;
-    }
+  if (ready < 0) {
+    g_syscall_error->SetMsg((char *) "", TIMEOUT_EXPIRED);
+    g_machine->WriteIntRegister(10, ERROR);
+  } else {
+    DEBUG('e', (char *) "WaitAny: object %d is ready\n", ready);
+    g_machine->WriteIntRegister(10, ready);
+  }
+}
 
-    case SC_RMDIR: {
-      // the Rmdir system call
-      // remove a directory from the file system
-      DEBUG('e', (char *) "Filesystem: Rmdir call.\n");
-      int addr;
-      int sizep;
-      addr = g_machine->ReadIntRegister(10);
-      sizep = GetLengthParam(addr);
-      char name[sizep];
-      GetStringParam(addr, name, sizep);
-      int good = g_file_system->Rmdir(name);
-      if (good != NO_ERROR) {
-        g_machine->WriteIntRegister(10, ERROR);
-        g_syscall_error->SetMsg(name, good);
-      } else {
-        g_machine->WriteIntRegister(10, good);
-        g_syscall_error->SetMsg((char *) "", NO_ERROR);
-      }
-      break;
-    }
+//----------------------------------------------------------------------
+// SysSendFile
+/*! 	Copy an opened file to another one or at the console, sector
+//	by sector, without going through the memory of the program
+*/
+//----------------------------------------------------------------------
+static void
+SysSendFile() {
+  DEBUG('e', (char *) "Filesystem: SendFile call.\n");
+  int64_t in = g_machine->ReadIntRegister(10);
+  int64_t out = g_machine->ReadIntRegister(11);
+  int size = g_machine->ReadIntRegister(12);
 
-    case SC_FSLIST: {
-      // The FSList system call
-      // Lists all the file and directories in the filesystem
-      g_file_system->List();
-      g_syscall_error->SetMsg((char *) "", NO_ERROR);
-      break;
+  OpenFile *src = (OpenFile *) g_object_addrs->SearchObject(in);
+  if (!src || src->type != FILE_TYPE) {
+    g_syscall_error->SetId(in, INVALID_FILE_ID);
+    g_machine->WriteIntRegister(10, ERROR);
+    return;
+  }
+  OpenFile *dst = NULL;
+  if (out != CONSOLE_OUTPUT) {
+    dst = (OpenFile *) g_object_addrs->SearchObject(out);
+    if (!dst || dst->type != FILE_TYPE) {
+      g_syscall_error->SetId(out, INVALID_FILE_ID);
+      g_machine->WriteIntRegister(10, ERROR);
+      return;
     }
+  }
 
-    case SC_TTY_SEND: {
-      // the TtySend system call
-      // Sends some char by the serial line emulated
-      DEBUG('e', (char *) "ACIA: Send call.\n");
-      if (g_cfg->ACIA != ACIA_NONE) {
-        int result;
-        uint64_t c;
-        int i;
-        uint64_t addr = g_machine->ReadIntRegister(10);
-        char buff[MAXSTRLEN];
-        for (i = 0;; i++) {
-          g_machine->mmu->ReadMem(addr + i, 1, &c);
-          buff[i] = (char) c;
-          if (buff[i] == '\0')
-            break;
-        }
-        result = g_acia_driver->TtySend(buff);
-        g_machine->WriteIntRegister(10, result);
-        g_syscall_error->SetMsg((char *) "", NO_ERROR);
-      } else {
-        g_machine->WriteIntRegister(10, ERROR);
-        g_syscall_error->SetMsg((char *) "", NO_ACIA);
-      }
+  char buffer[g_cfg->SectorSize];
+  int numcopied = 0;
+  while (numcopied < size) {
+    int lg = size - numcopied;
+    if (lg > (int) g_cfg->SectorSize)
+      lg = g_cfg->SectorSize;
+    int numread = src->Read(buffer, lg);
+    if (numread <= 0)
       break;
-    }
-
-    case SC_TTY_RECEIVE: {
-      // the TtyReceive system call
-      // read some char on the serial line
-      DEBUG('e', (char *) "ACIA: Receive call.\n");
-      if (g_cfg->ACIA != ACIA_NONE) {
-        int result;
-        int i = 0;
-        int addr = g_machine->ReadIntRegister(10);
-        int length = g_machine->ReadIntRegister(11);
-        char buff[length + 1];
-        result = g_acia_driver->TtyReceive(buff, length);
-        while ((i <= length)) {
-          g_machine->mmu->WriteMem(addr, 1, buff[i]);
-          addr++;
-          i++;
-        }
-        g_machine->mmu->WriteMem(addr, 1, 0);
-        g_machine->WriteIntRegister(10, result);
-        g_syscall_error->SetMsg((char *) "", NO_ERROR);
-      } else {
-        g_machine->WriteIntRegister(10, ERROR);
-        g_syscall_error->SetMsg((char *) "", NO_ACIA);
-      }
+    int numwrite = numread;
+    if (dst != NULL)
+      numwrite = dst->Write(buffer, numread);
+    else
+      g_console_driver->PutString(buffer, numread);
+    numcopied += numwrite;
+    if ((numread < lg) || (numwrite < numread))
       break;
-    }
+  }
+  g_machine->WriteIntRegister(10, numcopied);
+}
 
-    case SC_MMAP: {
-      // Map a file in memory
-      DEBUG('e', (char *) "Filesystem: Mmap call.\n");
-      int32_t fid = g_machine->ReadIntRegister(10);
-      OpenFile *file = (OpenFile *) g_object_addrs->SearchObject(fid);
-      if (file) {
-        int size = g_machine->ReadIntRegister(11);
-        AddrSpace *ap = g_current_thread->GetProcessOwner()->addrspace;
-        int addr = ap->Mmap(file, size);
-        g_machine->WriteIntRegister(10, ((int) addr));
-        g_syscall_error->SetMsg((char *) "", NO_ERROR);
-      } else {
-        g_machine->WriteIntRegister(10, ERROR);
-        sprintf(msg, "%p", file);
-        g_syscall_error->SetMsg(msg, INVALID_FILE_ID);
-      }
-      break;
-    }
+//----------------------------------------------------------------------
+// SysSeek
+//! 	Seek to a given position in an opened file
+//----------------------------------------------------------------------
+static void
+SysSeek() {
+  DEBUG('e', (char *) "Filesystem: Seek call.\n");
+  int offset;
+  int64_t f;
+  int error = NO_ERROR;
 
-    case SC_DEBUG: {
-      // Map a file in memory
-      DEBUG('e', (char *) "Nachos: debug system call.\n");
-      printf("Debug system call: parameter %" PRIu64 "\n",
-             g_machine->ReadIntRegister(10));
-      break;
+  // Get the offset into the file
+  offset = g_machine->ReadIntRegister(10);
+  // Get the openfile number or 1 (console)
+  f = g_machine->ReadIntRegister(11);
+
+  // Seek into a file
+  if (f > CONSOLE_OUTPUT) {
+    int64_t fid = f;
+    OpenFile *file = (OpenFile *) g_object_addrs->SearchObject(fid);
+    if (file && file->type == FILE_TYPE) {
+      file->Seek(offset);
+    } else {
+      error = ERROR;
+      g_syscall_error->SetId(f, INVALID_FILE_ID);
     }
+    g_machine->WriteIntRegister(10, error);
+  } else {
+    g_machine->WriteIntRegister(10, ERROR);
+    g_syscall_error->SetId(f, INVALID_FILE_ID);
+  }
+}
 
-#ifdef ETUDIANTS_TP
-    case SC_P: {
-      DEBUG('e', (char *) "Semaphore: P syscall initiated.\n");
-      SemId sid = g_machine->ReadIntRegister(10);
-      Semaphore* s = (Semaphore*) g_object_addrs->SearchObject(sid);
-      if (s == NULL) {
-        DEBUG('e', (char *) "Semaphore: Invalid ID.\n");
-        g_syscall_error->SetMsg((char *) "", INVALID_SEMAPHORE_ID);
-        g_machine->WriteIntRegister(10, ERROR);
+//----------------------------------------------------------------------
+// SysClose
+/*! 	The close system call
+//	Close a file
+*/
+//----------------------------------------------------------------------
+static void
+SysClose() {
+  DEBUG('e', (char *) "Filesystem: Close call.\n");
+  // Get the openfile number
+  int64_t fid = g_machine->ReadIntRegister(10);
+  OpenFile *file = (OpenFile *) g_object_addrs->SearchObject(fid);
+  if (file && file->type == FILE_TYPE) {
+    g_open_file_table->Close(file->GetName());
+    g_object_addrs->RemoveObject(fid);
+    delete file;
+    g_machine->WriteIntRegister(10, NO_ERROR);
+  } else {
+    g_machine->WriteIntRegister(10, ERROR);
+    g_syscall_error->SetId(fid, INVALID_FILE_ID);
+  }
+}
+
+//----------------------------------------------------------------------
+// SysRemove
+/*! 	The Remove system call
+//	Remove a file from the file system
+*/
+//----------------------------------------------------------------------
+static void
+SysRemove() {
+  DEBUG('e', (char *) "Filesystem: Remove call.\n");
+  int ret;
+  int addr;
+  int sizep;
+  // Get the name of the file to be removes
+  addr = g_machine->ReadIntRegister(10);
+  sizep = GetLengthParam(addr);
+  char ch[sizep];
+  GetStringParam(addr, ch, sizep);
+  // Actually remove it
+  int err = g_open_file_table->Remove(ch);
+  if (err == NO_ERROR) {
+    ret = 0;
+  } else {
+    ret = ERROR;
+    g_syscall_error->SetMsg(ch, err);
+  }
+  g_machine->WriteIntRegister(10, ret);
+}
+
+//----------------------------------------------------------------------
+// SysMkdir
+/*! 	the Mkdir system call
+//	make a new directory in the file system
+*/
+//----------------------------------------------------------------------
+static void
+SysMkdir() {
+  DEBUG('e', (char *) "Filesystem: Mkdir call.\n");
+  int addr;
+  int sizep;
+  addr = g_machine->ReadIntRegister(10);
+  sizep = GetLengthParam(addr);
+  char name[sizep];
+  GetStringParam(addr, name, sizep);
+  // name is the name of the new directory
+  int good = g_file_system->Mkdir(name);
+  if (good != NO_ERROR) {
+    g_machine->WriteIntRegister(10, ERROR);
+    if (good == OUT_OF_DISK)
+      g_syscall_error->SetMsg((char *) "", good);
+    else
+      g_syscall_error->SetMsg(name, good);
+  } else {
+    g_machine->WriteIntRegister(10, ((int) good));
+  }
+}
+
+//----------------------------------------------------------------------
+// SysRmdir
+/*! 	the Rmdir system call
+//	remove a directory from the file system
+*/
+//----------------------------------------------------------------------
+static void
+SysRmdir() {
+  DEBUG('e', (char *) "Filesystem: Rmdir call.\n");
+  int addr;
+  int sizep;
+  addr = g_machine->ReadIntRegister(10);
+  sizep = GetLengthParam(addr);
+  char name[sizep];
+  GetStringParam(addr, name, sizep);
+  int good = g_file_system->Rmdir(name);
+  if (good != NO_ERROR) {
+    g_machine->WriteIntRegister(10, ERROR);
+    g_syscall_error->SetMsg(name, good);
+  } else {
+    g_machine->WriteIntRegister(10, good);
+  }
+}
+
+//----------------------------------------------------------------------
+// SysFSList
+/*! 	The FSList system call
+//	Lists all the file and directories in the filesystem
+*/
+//----------------------------------------------------------------------
+static void
+SysFSList() {
+  g_file_system->List();
+}
+
+//----------------------------------------------------------------------
+// SysTtySend
+/*! 	the TtySend system call
+//	Sends some char by the serial line emulated
+*/
+//----------------------------------------------------------------------
+static void
+SysTtySend() {
+  DEBUG('e', (char *) "ACIA: Send call.\n");
+  if (g_cfg->ACIA != ACIA_NONE) {
+    int result;
+    uint64_t c;
+    int i;
+    uint64_t addr = g_machine->ReadIntRegister(10);
+    char buff[MAXSTRLEN];
+    for (i = 0;; i++) {
+      g_machine->mmu->ReadMem(addr + i, 1, &c);
+      buff[i] = (char) c;
+      if (buff[i] == '\0')
         break;
-      }
-      s->P();
-      g_syscall_error->SetMsg((char *) "", NO_ERROR);
-      break;
     }
+    result = g_acia_driver->TtySend(buff);
+    g_machine->WriteIntRegister(10, result);
+  } else {
+    g_machine->WriteIntRegister(10, ERROR);
+    g_syscall_error->SetMsg((char *) "", NO_ACIA);
+  }
+}
 
-    case SC_V: {
-      DEBUG('e', (char *) "Semaphore: V syscall initiated.\n");
-      SemId sid = g_machine->ReadIntRegister(10);
-      Semaphore* s = (Semaphore*) g_object_addrs->SearchObject(sid);
-      if (s == NULL) {
-        DEBUG('e', (char *) "Semaphore: Invalid ID.\n");
-        g_syscall_error->SetMsg((char *) "", INVALID_SEMAPHORE_ID);
-        g_machine->WriteIntRegister(10, ERROR);
-        break;
-      }
-      s->V();
-      g_syscall_error->SetMsg((char *) "", NO_ERROR);
-      break;
+//----------------------------------------------------------------------
+// SysTtyReceive
+/*! 	the TtyReceive system call
+//	read some char on the serial line
+*/
+//----------------------------------------------------------------------
+static void
+SysTtyReceive() {
+  DEBUG('e', (char *) "ACIA: Receive call.\n");
+  if (g_cfg->ACIA != ACIA_NONE) {
+    int result;
+    int i = 0;
+    int addr = g_machine->ReadIntRegister(10);
+    int length = g_machine->ReadIntRegister(11);
+    char buff[length + 1];
+    result = g_acia_driver->TtyReceive(buff, length);
+    while ((i <= length)) {
+      g_machine->mmu->WriteMem(addr, 1, buff[i]);
+      addr++;
+      i++;
     }
+    g_machine->mmu->WriteMem(addr, 1, 0);
+    g_machine->WriteIntRegister(10, result);
+  } else {
+    g_machine->WriteIntRegister(10, ERROR);
+    g_syscall_error->SetMsg((char *) "", NO_ACIA);
+  }
+}
 
-    case SC_SEM_CREATE: {
-      DEBUG('e', (char *) "Semaphore: Creation of semaphore initiated.\n");
-      uint64_t debug_name_addr = g_machine->ReadIntRegister(10);
-      int debug_name_sizep = GetLengthParam(debug_name_addr);
-      char debug_name[debug_name_sizep];
-      GetStringParam(debug_name_addr, debug_name, debug_name_sizep);
+//----------------------------------------------------------------------
+// SysMmap
+//! 	Map a file in memory
+//----------------------------------------------------------------------
+static void
+SysMmap() {
+  DEBUG('e', (char *) "Filesystem: Mmap call.\n");
+  int32_t fid = g_machine->ReadIntRegister(10);
+  OpenFile *file = (OpenFile *) g_object_addrs->SearchObject(fid);
+  if (file) {
+    int size = g_machine->ReadIntRegister(11);
+    AddrSpace *ap = g_current_thread->GetProcessOwner()->addrspace;
+    int addr = ap->Mmap(file, size);
+    g_machine->WriteIntRegister(10, ((int) addr));
+  } else {
+    g_machine->WriteIntRegister(10, ERROR);
+    g_syscall_error->SetId(fid, INVALID_FILE_ID);
+  }
+}
 
-      uint64_t sema_size = g_machine->ReadIntRegister(11);
-      Semaphore* sema = new Semaphore(debug_name, sema_size);
+//----------------------------------------------------------------------
+// SysDebug
+//! 	Map a file in memory
+//----------------------------------------------------------------------
+static void
+SysDebug() {
+  DEBUG('e', (char *) "Nachos: debug system call.\n");
+  printf("Debug system call: parameter %" PRIu64 "\n",
+         g_machine->ReadIntRegister(10));
+}
 
-      SemId sid = g_object_addrs->AddObject(sema);
-      g_syscall_error->SetMsg((char *) "", NO_ERROR);
-      g_machine->WriteIntRegister(10, sid);
-      break;
-    }
+//----------------------------------------------------------------------
+// SysSetWeight
+//! 	Set the weight of the current process for the scheduler
+//----------------------------------------------------------------------
+static void
+SysSetWeight() {
+  DEBUG('e', (char *) "Process: SetWeight call.\n");
+  int64_t weight = g_machine->ReadIntRegister(10);
+  if ((weight <= 0) || (weight > UINT32_MAX)) {
+    g_syscall_error->SetId(weight, INVALID_WEIGHT);
+    g_machine->WriteIntRegister(10, ERROR);
+    return;
+  }
+  Process *process = g_current_thread->GetProcessOwner();
+  process->weight = weight;
+  process->stat->setWeight(weight);
+  g_machine->WriteIntRegister(10, NO_ERROR);
+}
 
-    case SC_SEM_DESTROY: {
-      DEBUG('e', (char *) "Semaphore: Destruction of semaphore initiated.\n");
-      SemId sid = g_machine->ReadIntRegister(10);
-      Semaphore* s = (Semaphore*) g_object_addrs->SearchObject(sid);
-      if (s == NULL) {
-        DEBUG('e', (char *) "Semaphore: Invalid ID.\n");
-        g_syscall_error->SetMsg((char *) "", INVALID_SEMAPHORE_ID);
-        g_machine->WriteIntRegister(10, ERROR);
-        break;
-      }
-      g_object_addrs->RemoveObject(s);
-      delete s;
-      g_syscall_error->SetMsg((char *) "", NO_ERROR);
-      break;
+//----------------------------------------------------------------------
+// SysGetStats
+/*! 	Copy the statistics of the calling process, or of a thread, in a
+//	ProcessStats structure. The counters kept per process only are
+//	those of the process of the thread.
+*/
+//----------------------------------------------------------------------
+static void
+SysGetStats() {
+  DEBUG('e', (char *) "Process: GetStats call.\n");
+  int64_t tid = g_machine->ReadIntRegister(10);
+  uint64_t addr = g_machine->ReadIntRegister(11);
+  ProcessStat *stat = g_current_thread->GetProcessOwner()->stat;
+  ThreadStat *tstat = NULL;
+  if (tid != 0) {
+    Thread *thread = (Thread *) g_object_addrs->SearchObject(tid);
+    if ((thread == NULL) || (thread->type != THREAD_TYPE) ||
+        (thread->stat == NULL)) {
+      g_syscall_error->SetId(tid, INVALID_THREAD_ID);
+      g_machine->WriteIntRegister(10, ERROR);
+      return;
     }
+    tstat = thread->stat;
+    stat = tstat->getProcess();
+  }
+  // In the order of the fields of ProcessStats
+  uint64_t fields[] = {
+      g_stats->getTotalTicks(),
+      tstat ? tstat->getNumInstruction() : stat->getNumInstruction(),
+      tstat ? tstat->getUserTime() : stat->getUserTime(),
+      tstat ? tstat->getSystemTime() : stat->getSystemTime(),
+      tstat ? tstat->getCpuTicks() : stat->getCpuTicks(),
+      stat->getFairTicks(),
+      stat->getWeight(),
+      stat->getMemoryAccess(),
+      stat->getPageFaults(),
+      tstat ? tstat->getNumDiskReads() : stat->getNumDiskReads(),
+      tstat ? tstat->getNumDiskWrites() : stat->getNumDiskWrites(),
+      stat->getNumCharRead(),
+      stat->getNumCharWritten(),
+      g_cfg->ProcessorFrequency};
+  for (unsigned int i = 0; i < sizeof(fields) / sizeof(uint64_t); i++)
+    g_machine->mmu->WriteMem(addr + i * sizeof(uint64_t), sizeof(uint64_t),
+                             fields[i]);
+  g_machine->WriteIntRegister(10, NO_ERROR);
+}
 
-    case SC_LOCK_CREATE: {
-      DEBUG('e', (char *) "Lock: Creation of lock initiated.\n");
-      uint64_t debug_name_addr = g_machine->ReadIntRegister(10);
-      int debug_name_sizep = GetLengthParam(debug_name_addr);
-      char debug_name[debug_name_sizep];
-      GetStringParam(debug_name_addr, debug_name, debug_name_sizep);
+//----------------------------------------------------------------------
+// SysSetPeriodic
+/*! 	Make the calling thread periodic (real-time class), with a
+//	period, a budget and a deadline in microseconds, or a normal
+//	thread again if the period is 0
+*/
+//----------------------------------------------------------------------
+static void
+SysSetPeriodic() {
+  DEBUG('e', (char *) "Process: SetPeriodic call.\n");
+  int64_t period = (int32_t) g_machine->ReadIntRegister(10);
+  int64_t budget = (int32_t) g_machine->ReadIntRegister(11);
+  int64_t deadline = (int32_t) g_machine->ReadIntRegister(12);
+  if (deadline == 0)
+    deadline = period;
+  if ((period < 0) ||
+      ((period > 0) &&
+       ((budget <= 0) || (budget > deadline) || (deadline > period)))) {
+    g_syscall_error->SetId(period, INVALID_PERIODIC);
+    g_machine->WriteIntRegister(10, ERROR);
+    return;
+  }
+  IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+  bool admitted = g_scheduler->SetPeriodic(period * g_cfg->ProcessorFrequency,
+                                           budget * g_cfg->ProcessorFrequency,
+                                           deadline * g_cfg->ProcessorFrequency);
+  g_machine->interrupt->SetStatus(oldLevel);
+  if (!admitted) {
+    g_syscall_error->SetId(period, PERIODIC_REJECTED);
+    g_machine->WriteIntRegister(10, ERROR);
+    return;
+  }
+  g_machine->WriteIntRegister(10, NO_ERROR);
+}
 
-      Lock* l = new Lock(debug_name);
+//----------------------------------------------------------------------
+// SysWaitPeriod
+//! 	End the job of the calling periodic thread, wait for the next one
+//----------------------------------------------------------------------
+static void
+SysWaitPeriod() {
+  DEBUG('e', (char *) "Process: WaitPeriod call.\n");
+  if (g_current_thread->periodic == NULL) {
+    g_syscall_error->SetMsg((char *) "", INVALID_PERIODIC);
+    g_machine->WriteIntRegister(10, ERROR);
+    return;
+  }
+  IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+  g_scheduler->WaitNextPeriod();
+  g_machine->interrupt->SetStatus(oldLevel);
+  g_machine->WriteIntRegister(10, NO_ERROR);
+}
 
-      LockId lid = g_object_addrs->AddObject(l);
-      g_syscall_error->SetMsg((char *) "", NO_ERROR);
-      g_machine->WriteIntRegister(10, lid);
-      break;
-    }
+#ifdef ETUDIANTS_TP
 
-    case SC_LOCK_DESTROY: {
-      DEBUG('e', (char *) "Lock: Destruction of lock initiated.\n");
-      LockId lid = g_machine->ReadIntRegister(10);
-      Lock* l = (Lock*) g_object_addrs->SearchObject(lid);
-      if (l == NULL) {
-        DEBUG('e', (char *) "Lock: Invalid ID.\n");
-        g_syscall_error->SetMsg((char *) "", INVALID_LOCK_ID);
-        g_machine->WriteIntRegister(10, ERROR);
-        break;
-      }
-      g_object_addrs->RemoveObject(l);
-      delete l;
-      g_syscall_error->SetMsg((char *) "", NO_ERROR);
-      break;
-    }
+//----------------------------------------------------------------------
+// SysP
+//! 	The P system call: take a semaphore.
+//----------------------------------------------------------------------
+static void
+SysP() {
+  DEBUG('e', (char *) "Semaphore: P syscall initiated.\n");
+  SemId sid = g_machine->ReadIntRegister(10);
+  Semaphore* s = (Semaphore*) g_object_addrs->SearchObject(sid);
+  if (s == NULL) {
+    DEBUG('e', (char *) "Semaphore: Invalid ID.\n");
+    g_syscall_error->SetMsg((char *) "", INVALID_SEMAPHORE_ID);
+    g_machine->WriteIntRegister(10, ERROR);
+    return;
+  }
+  s->P();
+}
 
-    case SC_LOCK_ACQUIRE: {
-      DEBUG('e', (char *) "Lock: Lock acquire initiated.\n");
-      LockId lid = g_machine->ReadIntRegister(10);
-      Lock* l = (Lock*) g_object_addrs->SearchObject(lid);
-      if (l == NULL) {
-        DEBUG('e', (char *) "Lock: Invalid ID.\n");
-        g_syscall_error->SetMsg((char *) "", INVALID_SEMAPHORE_ID);
-        g_machine->WriteIntRegister(10, ERROR);
-        break;
-      }
-      l->Acquire();
-      g_syscall_error->SetMsg((char *) "", NO_ERROR);
-      break;
-    }
+//----------------------------------------------------------------------
+// SysV
+//! 	The V system call: release a semaphore.
+//----------------------------------------------------------------------
+static void
+SysV() {
+  DEBUG('e', (char *) "Semaphore: V syscall initiated.\n");
+  SemId sid = g_machine->ReadIntRegister(10);
+  Semaphore* s = (Semaphore*) g_object_addrs->SearchObject(sid);
+  if (s == NULL) {
+    DEBUG('e', (char *) "Semaphore: Invalid ID.\n");
+    g_syscall_error->SetMsg((char *) "", INVALID_SEMAPHORE_ID);
+    g_machine->WriteIntRegister(10, ERROR);
+    return;
+  }
+  s->V();
+}
 
-    case SC_LOCK_RELEASE: {
-      DEBUG('e', (char *) "Lock: Lock release initiated.\n");
-      LockId lid = g_machine->ReadIntRegister(10);
-      Lock* l = (Lock*) g_object_addrs->SearchObject(lid);
-      if (l == NULL) {
-        DEBUG('e', (char *) "Lock: Invalid ID.\n");
-        g_syscall_error->SetMsg((char *) "", INVALID_SEMAPHORE_ID);
-        g_machine->WriteIntRegister(10, ERROR);
-        break;
-      }
-      l->Release();
-      g_syscall_error->SetMsg((char *) "", NO_ERROR);
-      break;
-    }
+//----------------------------------------------------------------------
+// SysSemCreate
+//! 	The SemCreate system call: create a semaphore.
+//----------------------------------------------------------------------
+static void
+SysSemCreate() {
+  DEBUG('e', (char *) "Semaphore: Creation of semaphore initiated.\n");
+  uint64_t debug_name_addr = g_machine->ReadIntRegister(10);
+  int debug_name_sizep = GetLengthParam(debug_name_addr);
+  char debug_name[debug_name_sizep];
+  GetStringParam(debug_name_addr, debug_name, debug_name_sizep);
+
+  uint64_t sema_size = g_machine->ReadIntRegister(11);
+  Semaphore* sema = new Semaphore(debug_name, sema_size);
+
+  SemId sid = g_object_addrs->AddObject(sema, SEMAPHORE_TYPE);
+  g_machine->WriteIntRegister(10, sid);
+}
+
+//----------------------------------------------------------------------
+// SysSemDestroy
+//! 	The SemDestroy system call: destroy a semaphore.
+//----------------------------------------------------------------------
+static void
+SysSemDestroy() {
+  DEBUG('e', (char *) "Semaphore: Destruction of semaphore initiated.\n");
+  SemId sid = g_machine->ReadIntRegister(10);
+  Semaphore* s = (Semaphore*) g_object_addrs->SearchObject(sid);
+  if ((s == NULL) || (g_object_addrs->SearchType(sid) != SEMAPHORE_TYPE)) {
+    DEBUG('e', (char *) "Semaphore: Invalid ID.\n");
+    g_syscall_error->SetMsg((char *) "", INVALID_SEMAPHORE_ID);
+    g_machine->WriteIntRegister(10, ERROR);
+    return;
+  }
+  if (s->HasWaiters()) {
+    DEBUG('e', (char *) "Semaphore: Threads still waiting.\n");
+    g_syscall_error->SetId(sid, OBJECT_BUSY);
+    g_machine->WriteIntRegister(10, ERROR);
+    return;
+  }
+  g_object_addrs->RemoveObject(s);
+  delete s;
+}
+
+//----------------------------------------------------------------------
+// SysLockCreate
+//! 	The LockCreate system call: create a lock.
+//----------------------------------------------------------------------
+static void
+SysLockCreate() {
+  DEBUG('e', (char *) "Lock: Creation of lock initiated.\n");
+  uint64_t debug_name_addr = g_machine->ReadIntRegister(10);
+  int debug_name_sizep = GetLengthParam(debug_name_addr);
+  char debug_name[debug_name_sizep];
+  GetStringParam(debug_name_addr, debug_name, debug_name_sizep);
+
+  Lock* l = new Lock(debug_name);
 
+  LockId lid = g_object_addrs->AddObject(l, LOCK_TYPE);
+  g_machine->WriteIntRegister(10, lid);
+}
+
+//----------------------------------------------------------------------
+// SysLockDestroy
+//! 	The LockDestroy system call: destroy a lock.
+//----------------------------------------------------------------------
+static void
+SysLockDestroy() {
+  DEBUG('e', (char *) "Lock: Destruction of lock initiated.\n");
+  LockId lid = g_machine->ReadIntRegister(10);
+  Lock* l = (Lock*) g_object_addrs->SearchObject(lid);
+  if ((l == NULL) || (g_object_addrs->SearchType(lid) != LOCK_TYPE)) {
+    DEBUG('e', (char *) "Lock: Invalid ID.\n");
+    g_syscall_error->SetMsg((char *) "", INVALID_LOCK_ID);
+    g_machine->WriteIntRegister(10, ERROR);
+    return;
+  }
+  if (l->HasWaiters()) {
+    DEBUG('e', (char *) "Lock: Threads still waiting.\n");
+    g_syscall_error->SetId(lid, OBJECT_BUSY);
+    g_machine->WriteIntRegister(10, ERROR);
+    return;
+  }
+  g_object_addrs->RemoveObject(l);
+  delete l;
+}
+
+//----------------------------------------------------------------------
+// SysLockAcquire
+//! 	The LockAcquire system call: acquire a lock.
+//----------------------------------------------------------------------
+static void
+SysLockAcquire() {
+  DEBUG('e', (char *) "Lock: Lock acquire initiated.\n");
+  LockId lid = g_machine->ReadIntRegister(10);
+  Lock* l = (Lock*) g_object_addrs->SearchObject(lid);
+  if (l == NULL) {
+    DEBUG('e', (char *) "Lock: Invalid ID.\n");
+    g_syscall_error->SetMsg((char *) "", INVALID_SEMAPHORE_ID);
+    g_machine->WriteIntRegister(10, ERROR);
+    return;
+  }
+  l->Acquire();
+}
+
+//----------------------------------------------------------------------
+// SysLockRelease
+//! 	The LockRelease system call: release a lock.
+//----------------------------------------------------------------------
+static void
+SysLockRelease() {
+  DEBUG('e', (char *) "Lock: Lock release initiated.\n");
+  LockId lid = g_machine->ReadIntRegister(10);
+  Lock* l = (Lock*) g_object_addrs->SearchObject(lid);
+  if (l == NULL) {
+    DEBUG('e', (char *) "Lock: Invalid ID.\n");
+    g_syscall_error->SetMsg((char *) "", INVALID_SEMAPHORE_ID);
+    g_machine->WriteIntRegister(10, ERROR);
+    return;
+  }
+  l->Release();
+}
+
+//----------------------------------------------------------------------
+// SysCondCreate
+//! 	The CondCreate system call: create a condition.
+//----------------------------------------------------------------------
+static void
+SysCondCreate() {
+  DEBUG('e', (char *) "Cond: Creation of condition initiated.\n");
+  uint64_t debug_name_addr = g_machine->ReadIntRegister(10);
+  int debug_name_sizep = GetLengthParam(debug_name_addr);
+  char debug_name[debug_name_sizep];
+  GetStringParam(debug_name_addr, debug_name, debug_name_sizep);
+
+  Condition* c = new Condition(debug_name);
+
+  CondId cid = g_object_addrs->AddObject(c, CONDITION_TYPE);
+  g_machine->WriteIntRegister(10, cid);
+}
+
+//----------------------------------------------------------------------
+// SysCondDestroy
+//! 	The CondDestroy system call: destroy a condition.
+//----------------------------------------------------------------------
+static void
+SysCondDestroy() {
+  DEBUG('e', (char *) "Cond: Destruction of condition initiated.\n");
+  CondId cid = g_machine->ReadIntRegister(10);
+  Condition* c = (Condition*) g_object_addrs->SearchObject(cid);
+  if ((c == NULL) || (c->type != CONDITION_TYPE)) {
+    DEBUG('e', (char *) "Cond: Invalid ID.\n");
+    g_syscall_error->SetMsg((char *) "", INVALID_CONDITION_ID);
+    g_machine->WriteIntRegister(10, ERROR);
+    return;
+  }
+  g_object_addrs->RemoveObject(c);
+  delete c;
+}
+
+//----------------------------------------------------------------------
+// SysCondWait
+//! 	The CondWait system call: wait on a condition.
+//----------------------------------------------------------------------
+static void
+SysCondWait() {
+  DEBUG('e', (char *) "Cond: Condition wait initiated.\n");
+  CondId cid = g_machine->ReadIntRegister(10);
+  LockId lid = g_machine->ReadIntRegister(11);
+  Condition* c = (Condition*) g_object_addrs->SearchObject(cid);
+  Lock* l = (Lock*) g_object_addrs->SearchObject(lid);
+  if ((c == NULL) || (c->type != CONDITION_TYPE)) {
+    DEBUG('e', (char *) "Cond: Invalid ID.\n");
+    g_syscall_error->SetMsg((char *) "", INVALID_CONDITION_ID);
+    g_machine->WriteIntRegister(10, ERROR);
+    return;
+  }
+  if ((l == NULL) || (l->type != LOCK_TYPE) ||
+      !l->isHeldByCurrentThread()) {
+    DEBUG('e', (char *) "Cond: Invalid or not held lock.\n");
+    g_syscall_error->SetMsg((char *) "", INVALID_LOCK_ID);
+    g_machine->WriteIntRegister(10, ERROR);
+    return;
+  }
+  c->Wait(l);
+}
+
+//----------------------------------------------------------------------
+// SysCondSignal
+//! 	The CondSignal system call: wake up a thread waiting on a condition.
+//----------------------------------------------------------------------
+static void
+SysCondSignal() {
+  DEBUG('e', (char *) "Cond: Condition signal initiated.\n");
+  CondId cid = g_machine->ReadIntRegister(10);
+  Condition* c = (Condition*) g_object_addrs->SearchObject(cid);
+  if ((c == NULL) || (c->type != CONDITION_TYPE)) {
+    DEBUG('e', (char *) "Cond: Invalid ID.\n");
+    g_syscall_error->SetMsg((char *) "", INVALID_CONDITION_ID);
+    g_machine->WriteIntRegister(10, ERROR);
+    return;
+  }
+  c->Signal();
+}
+
+//----------------------------------------------------------------------
+// SysCondBroadcast
+/*! 	The CondBroadcast system call: wake up all the threads waiting on
+//	a condition.
+*/
+//----------------------------------------------------------------------
+static void
+SysCondBroadcast() {
+  DEBUG('e', (char *) "Cond: Condition broadcast initiated.\n");
+  CondId cid = g_machine->ReadIntRegister(10);
+  Condition* c = (Condition*) g_object_addrs->SearchObject(cid);
+  if ((c == NULL) || (c->type != CONDITION_TYPE)) {
+    DEBUG('e', (char *) "Cond: Invalid ID.\n");
+    g_syscall_error->SetMsg((char *) "", INVALID_CONDITION_ID);
+    g_machine->WriteIntRegister(10, ERROR);
+    return;
+  }
+  c->Broadcast();
+}
+
+#endif
+
+//----------------------------------------------------------------------
+// SysBarrierCreate
+//! 	The BarrierCreate system call: create a barrier.
+//----------------------------------------------------------------------
+static void
+SysBarrierCreate() {
+  DEBUG('e', (char *) "Barrier: Creation of barrier initiated.\n");
+  uint64_t debug_name_addr = g_machine->ReadIntRegister(10);
+  int debug_name_sizep = GetLengthParam(debug_name_addr);
+  char debug_name[debug_name_sizep];
+  GetStringParam(debug_name_addr, debug_name, debug_name_sizep);
+
+  int64_t nb_threads = g_machine->ReadIntRegister(11);
+  if ((nb_threads <= 0) || (nb_threads > INT_MAX)) {
+    DEBUG('e', (char *) "Barrier: Invalid number of threads.\n");
+    g_syscall_error->SetId(nb_threads, INVALID_BARRIER_COUNT);
+    g_machine->WriteIntRegister(10, ERROR);
+    return;
+  }
+  Barrier* b = new Barrier(debug_name, nb_threads);
+
+  BarrierId bid = g_object_addrs->AddObject(b, BARRIER_TYPE);
+  g_machine->WriteIntRegister(10, bid);
+}
+
+//----------------------------------------------------------------------
+// SysBarrierDestroy
+//! 	The BarrierDestroy system call: destroy a barrier.
+//----------------------------------------------------------------------
+static void
+SysBarrierDestroy() {
+  DEBUG('e', (char *) "Barrier: Destruction of barrier initiated.\n");
+  BarrierId bid = g_machine->ReadIntRegister(10);
+  Barrier* b = (Barrier*) g_object_addrs->SearchObject(bid);
+  if ((b == NULL) || (b->type != BARRIER_TYPE)) {
+    DEBUG('e', (char *) "Barrier: Invalid ID.\n");
+    g_syscall_error->SetMsg((char *) "", INVALID_BARRIER_ID);
+    g_machine->WriteIntRegister(10, ERROR);
+    return;
+  }
+  if (b->HasWaiters()) {
+    DEBUG('e', (char *) "Barrier: Threads still waiting.\n");
+    g_syscall_error->SetId(bid, OBJECT_BUSY);
+    g_machine->WriteIntRegister(10, ERROR);
+    return;
+  }
+  g_object_addrs->RemoveObject(b);
+  delete b;
+}
+
+//----------------------------------------------------------------------
+// SysBarrierWait
+/*! 	The BarrierWait system call: wait for the other threads at a
+//	barrier.
+*/
+//----------------------------------------------------------------------
+static void
+SysBarrierWait() {
+  DEBUG('e', (char *) "Barrier: Barrier wait initiated.\n");
+  BarrierId bid = g_machine->ReadIntRegister(10);
+  Barrier* b = (Barrier*) g_object_addrs->SearchObject(bid);
+  if ((b == NULL) || (b->type != BARRIER_TYPE)) {
+    DEBUG('e', (char *) "Barrier: Invalid ID.\n");
+    g_syscall_error->SetMsg((char *) "", INVALID_BARRIER_ID);
+    g_machine->WriteIntRegister(10, ERROR);
+    return;
+  }
+  b->Wait();
+}
+
+//! A system call handler: it reads its arguments in the registers of
+//! the machine, and writes its result in r10
+typedef void (*SyscallHandler)(void);
+
+/*! The system call handlers, indexed by system call number (see
+//  userlib/syscall.h). ExceptionHandler clears the error of the calling
+//  thread before calling them: they only set it when the call fails.
+*/
+static SyscallHandler syscallTable[] = {
+    SysHalt,             // SC_HALT
+    SysExit,             // SC_EXIT
+    SysExec,             // SC_EXEC
+    SysJoin,             // SC_JOIN
+    SysCreate,           // SC_CREATE
+    SysOpen,             // SC_OPEN
+    SysRead,             // SC_READ
+    SysWrite,            // SC_WRITE
+    SysSeek,             // SC_SEEK
+    SysClose,            // SC_CLOSE
+    SysNewThread,        // SC_NEW_THREAD
+    SysYield,            // SC_YIELD
+    SysPError,           // SC_PERROR
+#ifdef ETUDIANTS_TP
+    SysP,                // SC_P
+    SysV,                // SC_V
+    SysSemCreate,        // SC_SEM_CREATE
+    SysSemDestroy,       // SC_SEM_DESTROY
+    SysLockCreate,       // SC_LOCK_CREATE
+    SysLockDestroy,      // SC_LOCK_DESTROY
+    SysLockAcquire,      // SC_LOCK_ACQUIRE
+    SysLockRelease,      // SC_LOCK_RELEASE
+    SysCondCreate,       // SC_COND_CREATE
+    SysCondDestroy,      // SC_COND_DESTROY
+    SysCondWait,         // SC_COND_WAIT
+    SysCondSignal,       // SC_COND_SIGNAL
+    SysCondBroadcast,    // SC_COND_BROADCAST
+#else
+    NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+    NULL, NULL, NULL, NULL, NULL, NULL,   // SC_P to SC_COND_BROADCAST
 #endif
+    SysTtySend,          // SC_TTY_SEND
+    SysTtyReceive,       // SC_TTY_RECEIVE
+    SysMkdir,            // SC_MKDIR
+    SysRmdir,            // SC_RMDIR
+    SysRemove,           // SC_REMOVE
+    SysFSList,           // SC_FSLIST
+    SysSysTime,          // SC_SYS_TIME
+    SysMmap,             // SC_MMAP
+    SysDebug,            // SC_DEBUG
+    SysSetWeight,        // SC_SET_WEIGHT
+    SysSendFile,         // SC_SEND_FILE
+    SysBarrierCreate,    // SC_BARRIER_CREATE
+    SysBarrierWait,      // SC_BARRIER_WAIT
+    SysBarrierDestroy,   // SC_BARRIER_DESTROY
+    SysWaitAny,          // SC_WAIT_ANY
+    SysGetStats,         // SC_GET_STATS
+    SysSetPeriodic,      // SC_SET_PERIODIC
+    SysWaitPeriod,       // SC_WAIT_PERIOD
+};
+
+#define NB_SYSCALLS ((int) (sizeof(syscallTable) / sizeof(SyscallHandler)))
+
+// An entry missing or added sends the next system calls to the wrong
+// handlers: the table must end with the last system call
+static_assert(NB_SYSCALLS == SC_WAIT_PERIOD + 1,
+              "syscallTable does not match the system call numbers");
+
+//----------------------------------------------------------------------
+// ExceptionHandler
+/*!   Entry point into the Nachos kernel.  Called when a user program
+//    is executing, and either does a syscall, or generates an addressing
+//    or arithmetic exception.
+//
+//    For system calls, the calling convention is the following:
+//
+//    - system call identifier -- r17
+//    - arg1 -- r10
+//    - arg2 -- r11
+//    - arg3 -- r12
+//    - arg4 -- r13
+//
+//    The result of the system call, if any, must be put back into register r10
+//
+//    \param exceptiontype is the kind of exception.
+//           The list of possible exception are defined in machine.h.
+//    \param vaddr is the address that causes the exception to occur
+//           (when used)
+*/
+//----------------------------------------------------------------------
+void
+ExceptionHandler(ExceptionType exceptiontype, int vaddr) {
+  PROFILE_ZONE(PROFILE_EXCEPTION);
 
-    default:
+  // Get the content of register 17 (system call number in case
+  // of a system call
+  int type = g_machine->ReadIntRegister(17);
+
+  // A loop on Yield may still be a spin loop, if no other thread runs
+  // (SwitchTo tells), but any other call or exception may end it
+  if ((exceptiontype != SYSCALL_EXCEPTION) || (type != SC_YIELD))
+    g_machine->SpinDisturbed();
+
+  switch (exceptiontype) {
+  case NO_EXCEPTION:
+    printf("Nachos internal error, a NoException exception is raised ...\n");
+    g_machine->interrupt->Halt(NO_ERROR);
+    break;
+
+  case SYSCALL_EXCEPTION:
+    // System calls
+    // -------------
+    if ((type < 0) || (type >= NB_SYSCALLS) || (syscallTable[type] == NULL)) {
       printf("Invalid system call number : %d %x\n", type, type);
       exit(ERROR);
-      break;
     }
-
+    // PError prints the error of the previous call
+    if (type != SC_PERROR)
+      g_syscall_error->Clear();
+    syscallTable[type]();
     break;
-  }
 
   // Other exceptions
   // ----------------
@@ -111,6 +111,9 @@ main(int argc, char **argv) {
         Copy(g_cfg->ToCopyUnix[i], g_cfg->ToCopyNachos[i]);
     }
   }
+  if (g_cfg->Defragment) {   // lay out the files again
+    g_file_system->Defragment();
+  }
   if (g_cfg->Print) {   // print a Nachos file
     Print(g_cfg->FileToPrint);
   }
@@ -131,7 +134,7 @@ main(int argc, char **argv) {
     }
     g_machine->mmu->translationTable = p->addrspace->translationTable;
     Thread *t = new Thread(startfilename);
-    g_object_addrs->AddObject(t);
+    g_object_addrs->AddObject(t, THREAD_TYPE);
     err = t->Start(p, p->addrspace->getCodeStartAddress64(), -1);
     if (err != NO_ERROR) {
       fprintf(stderr, "Unable to start initial process: %s\n", startfilename);
@@ -19,6 +19,8 @@
 
 #include "kernel/msgerror.h"
 #include "drivers/drvConsole.h"
+#include "kernel/system.h"
+#include "kernel/thread.h"
 
 //-----------------------------------------------------------------
 // SyscallError::SyscallError
@@ -26,9 +28,6 @@
  */
 //-----------------------------------------------------------------
 SyscallError::SyscallError() {
-  lastError = NO_ERROR;
-  errorAbout = NULL;
-
   msgs[NO_ERROR] = (char *) "no error %s \n";
   msgs[INC_ERROR] = (char *) "incorrect error type %s \n";
 
@@ -49,15 +48,25 @@ SyscallError::SyscallError() {
   msgs[NOT_A_DIRECTORY] = (char *) "%s is not a directory\n";
   msgs[DIRECTORY_NOT_EMPTY] = (char *) "directory %s is not empty\n";
   msgs[INVALID_COUNTER] = (char *) "negative semaphore counter\n";
+  msgs[INVALID_BARRIER_COUNT] =
+      (char *) "invalid number of threads %s for a barrier\n";
 
   msgs[INVALID_SEMAPHORE_ID] = (char *) "invalid semaphore identifier %s\n";
   msgs[INVALID_LOCK_ID] = (char *) "invalid lock identifier %s\n";
   msgs[INVALID_CONDITION_ID] = (char *) "invalid condition identifier %s\n";
+  msgs[INVALID_BARRIER_ID] = (char *) "invalid barrier identifier %s\n";
   msgs[INVALID_FILE_ID] = (char *) "invalid file identifier %s\n";
   msgs[INVALID_THREAD_ID] = (char *) "invalid thread identifier %s\n";
   msgs[WRONG_FILE_ENDIANESS] = (char *) "Incorrect code endianess\n";
 
   msgs[NO_ACIA] = (char *) "no ACIA driver installed %s\n";
+  msgs[INVALID_WEIGHT] = (char *) "invalid process weight %s\n";
+  msgs[INVALID_WAIT_SET] = (char *) "invalid object to wait for %s\n";
+  msgs[TIMEOUT_EXPIRED] = (char *) "timeout expired %s\n";
+  msgs[INVALID_PERIODIC] = (char *) "invalid periodic task parameters %s\n";
+  msgs[PERIODIC_REJECTED] =
+      (char *) "not enough CPU left for the periodic task %s\n";
+  msgs[OBJECT_BUSY] = (char *) "object %s is still waited for\n";
 }
 
 //-----------------------------------------------------------------
@@ -65,15 +74,12 @@ SyscallError::SyscallError() {
 /*!      Destructor. De-allocate the structures
  */
 //-----------------------------------------------------------------
-SyscallError::~SyscallError() {
-  if (errorAbout != NULL)
-    delete[] errorAbout;
-}
+SyscallError::~SyscallError() {}
 
 //-----------------------------------------------------------------
 // SyscallError::SetMsg
-/*!      Set the current error message defined by its index and
-//       the related context string.
+/*!      Set the error of the current thread, defined by its index
+//       and the related context string (truncated if too long).
 //
 //       \param about is the context string
 //       \param num is the number associated with the error msg
@@ -81,26 +87,54 @@ SyscallError::~SyscallError() {
 //-----------------------------------------------------------------
 void
 SyscallError::SetMsg(char *about, int num) {
+  ThreadError *error = &g_current_thread->error;
 
-  // Delete old "about" string
-  if (errorAbout != NULL)
-    delete errorAbout;
+  // Remember the error code of the last system call
+  if ((num < 0) || (num >= NUMMSGERROR) || (msgs[num] == NULL))
+    error->code = INC_ERROR;
+  else
+    error->code = num;
 
-  // Allocate a new one if the argument is not NULL
+  // Copy the context, the string may not outlive the system call
+  error->hasId = false;
   if (about != NULL) {
-    int size = strlen(about) + 1;
-    errorAbout = new char[size];
-    strcpy(errorAbout, about);
+    strncpy(error->about, about, MAX_ERROR_ABOUT - 1);
+    error->about[MAX_ERROR_ABOUT - 1] = '\0';
   } else
-    errorAbout = NULL;
+    error->about[0] = '\0';
+}
 
-  // Remember the error code of the last system call
-  if ((num < 0) || (num >= NUMMSGERROR))
-    lastError = INC_ERROR;
-  if (msgs[num] == NULL)
-    lastError = INC_ERROR;
-  else
-    lastError = num;
+//-----------------------------------------------------------------
+// SyscallError::SetId
+/*!      Set the error of the current thread, defined by its index
+//       and the identifier of the object it is about. The
+//       identifier is only turned into a string by PrintLastMsg.
+//
+//       \param id is the object identifier
+//       \param num is the number associated with the error msg
+*/
+//-----------------------------------------------------------------
+void
+SyscallError::SetId(int64_t id, int num) {
+  SetMsg(NULL, num);
+  g_current_thread->error.hasId = true;
+  g_current_thread->error.id = id;
+}
+
+//-----------------------------------------------------------------
+// SyscallError::Clear
+/*!      Record that the system call of the current thread succeeded.
+//       Done for every system call, so it only stores the error code
+//       and empties the context.
+*/
+//-----------------------------------------------------------------
+void
+SyscallError::Clear() {
+  ThreadError *error = &g_current_thread->error;
+
+  error->code = NO_ERROR;
+  error->hasId = false;
+  error->about[0] = '\0';
 }
 
 //-----------------------------------------------------------------
@@ -123,7 +157,7 @@ SyscallError::GetFormat(int num) {
 
 //-----------------------------------------------------------------
 // SyscallError::PrintLastMsg
-/*! Print the message of the last Nachos error
+/*! Print the message of the last Nachos error of the current thread
 //
 //  \param cons console on which the message should be printed
 //  \param ch heading string to be printed before the Nachos
@@ -132,10 +166,15 @@ SyscallError::GetFormat(int num) {
 //-----------------------------------------------------------------
 void
 SyscallError::PrintLastMsg(DriverConsole *cons, char *ch) {
+  ThreadError *error = &g_current_thread->error;
+  char id[32];
+  char msg[MAX_ERROR_ABOUT + 128];
 
-  int size = strlen(msgs[lastError]) + strlen(errorAbout) + 1;
-  char *msg = new char[size];
-  sprintf(msg, msgs[lastError], errorAbout);
+  if (error->hasId) {
+    snprintf(id, sizeof(id), "%" PRId64, error->id);
+    snprintf(msg, sizeof(msg), msgs[error->code], id);
+  } else
+    snprintf(msg, sizeof(msg), msgs[error->code], error->about);
 
   cons->PutString(ch, strlen(ch));
   cons->PutString((char *) " : ", 3);
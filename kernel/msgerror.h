@@ -20,6 +20,8 @@
 #ifndef MSGERROR_H
 #define MSGERROR_H
 
+#include <stdint.h>
+
 // Forward declarations
 class SyscallError;
 class DriverConsole;
@@ -50,29 +52,55 @@ enum {
   NOT_A_DIRECTORY,
   DIRECTORY_NOT_EMPTY,
   INVALID_COUNTER,
+  INVALID_BARRIER_COUNT,
 
   /* Invalid typeId fields: */
   INVALID_SEMAPHORE_ID,
   INVALID_LOCK_ID,
   INVALID_CONDITION_ID,
+  INVALID_BARRIER_ID,
   INVALID_FILE_ID,
   INVALID_THREAD_ID,
 
   /* Other messages */
   WRONG_FILE_ENDIANESS,
   NO_ACIA,
+  INVALID_WEIGHT,
+  INVALID_WAIT_SET,
+  TIMEOUT_EXPIRED,
+  INVALID_PERIODIC,
+  PERIODIC_REJECTED,
+  OBJECT_BUSY,
 
   NUMMSGERROR /* Must always be last */
 };
 
+//! Maximum length of the context string of an error
+#define MAX_ERROR_ABOUT 256
+
+/*! \brief Defines the error of the last system call of a thread
+//
+//  The context of the error is either a string (eg. the name of an
+//  unknown file) or an object identifier. It is kept as is: the
+//  message is only formatted when the thread calls PError.
+*/
+class ThreadError {
+public:
+  int code;                        //!< error ident, NO_ERROR on success
+  bool hasId;                      //!< is the context id or about?
+  int64_t id;                      //!< context identifier
+  char about[MAX_ERROR_ABOUT];     //!< context string
+};
+
 /*! \brief Defines a structure to store syscall error messages
 //
 //
 //  When an error occurs during a system call, a negative value
 //  is return to the user program and then an error message
 //  can be printed using the system call PError(). This structure
-//  contains the last error message with the corresponding context
-//  string (eg. the name of an unknow file).
+//  contains the error messages; the last error of each thread, with
+//  its context, is kept by the thread itself (see ThreadError), so
+//  that the threads do not overwrite the errors of each other.
 */
 class SyscallError {
 public:
@@ -80,7 +108,13 @@ public:
   ~SyscallError();   // De-allocate the structure
 
   void SetMsg(char *about, int num);
-  //!< Set the current error message
+  //!< Set the error of the current thread, with a context string
+
+  void SetId(int64_t id, int num);
+  //!< Set the error of the current thread, with an identifier
+
+  void Clear();
+  //!< Record that the system call of the current thread succeeded
 
   void PrintLastMsg(DriverConsole *cons, char *ch);
   //!< Print the error message with a user defined
@@ -90,8 +124,6 @@ public:
   const char *GetFormat(int num);
 
 private:
-  int lastError;             //!< last error's ident
-  char *errorAbout;          //!< context string
   char *msgs[NUMMSGERROR];   //!< The array of strings for the error messages
 };
 
@@ -32,12 +32,15 @@
 //----------------------------------------------------------------------
 Process::Process(char *filename, int *err) {
   numThreads = 0;
+  weight = DEFAULT_WEIGHT;
+  accountMark = 0;
   *err = NO_ERROR;
   if (filename == NULL) {
     DEBUG('t', (char *) "Create empty process\n");
 
     // Create a statistics object for the program
     stat = g_stats->NewProcStat((char *) "BOOT");
+    stat->setWeight(weight);
 
     // Fake process Name
     name = new char[strlen("BOOT") + 1];
@@ -50,6 +53,7 @@ Process::Process(char *filename, int *err) {
 
     // Create a statistics object for the program
     stat = g_stats->NewProcStat(filename);
+    stat->setWeight(weight);
 
     // Set process name
     name = new char[strlen(filename) + 1];
@@ -74,6 +78,10 @@ Process::Process(char *filename, int *err) {
     delete[] name;
     return;
   }
+
+  // Record the reads of the program (see FileSystem::Defragment)
+  if (exec_file != NULL)
+    g_file_system->SaveReadCount(exec_file->GetSector());
 }
 
 //----------------------------------------------------------------------
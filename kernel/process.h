@@ -33,6 +33,9 @@ class AddrSpace;
 class Thread;
 class Semaphore;
 
+//! Weight of a process, unless changed by the SetWeight system call
+#define DEFAULT_WEIGHT 1024
+
 /*! \brief Defines the data structures to keep track of the execution
  environment of a user program */
 class Process {
@@ -57,6 +60,12 @@ public:
   ProcessStat *stat; /*!< Statistics concerning this
                        process */
 
+  uint32_t weight; /*!< Share of the CPU of the process, relative
+                     to the other ones (fair-share scheduling) */
+
+  uint64_t accountMark; /*!< Last CPU accounting the process was
+                          counted in (see Scheduler::Account) */
+
   char *getName() { return (name); } /*!< Returns the process name */
 
 private:
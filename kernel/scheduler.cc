@@ -11,7 +11,9 @@ thread.
 //	end up calling FindNextToRun(), and that would put us in an
 //	infinite loop.
 //
-// 	Very simple implementation -- no priorities, straight FIFO.
+// 	Periodic threads are scheduled first, by earliest deadline; the
+//	others in FIFO order or by fair share of the CPU between the
+//	processes (see scheduler.h).
  * -----------------------------------------------------
  * This file is part of the Nachos-RiscV distribution
  * Copyright (c) 2022 University of Rennes 1.
@@ -31,6 +33,83 @@ thread.
 #include "kernel/scheduler.h"
 #include "kernel/system.h"
 #include "kernel/thread.h"
+#include "utility/profile.h"
+
+//! Share of the CPU that the periodic threads can reserve, in millionths
+#define MAX_RT_SHARE 1000000
+
+//----------------------------------------------------------------------
+// PutTask
+/*! 	Drop a reference to a periodic task, and delete it with the last
+//	one.
+*/
+//----------------------------------------------------------------------
+static void
+PutTask(PeriodicTask *task) {
+  if (--task->refs == 0)
+    delete task;
+}
+
+//----------------------------------------------------------------------
+// StartJob
+//! 	Start the job of a periodic task released at task->release
+//----------------------------------------------------------------------
+static void
+StartJob(PeriodicTask *task) {
+  task->deadline = task->release + task->relDeadline;
+  task->used = 0;
+  task->throttled = false;
+}
+
+// Dummy functions because C++ does not allow pointers to member
+// functions
+static void
+BudgetTimer(int64_t arg) {
+  g_scheduler->BudgetExpired((PeriodicTask *) arg);
+}
+
+static void
+ReleaseTimer(int64_t arg) {
+  g_scheduler->ReleaseJob((PeriodicTask *) arg);
+}
+
+//----------------------------------------------------------------------
+// ArmBudget
+/*! 	Program a timer interrupt for when the job of a periodic task,
+//	about to run, will have used up its budget. An interrupt already
+//	pending comes at that time or before, as the job has not run
+//	since it was programmed: it is kept, and programs the next one.
+*/
+//----------------------------------------------------------------------
+static void
+ArmBudget(PeriodicTask *task) {
+  Time left = (task->used < task->budget) ? task->budget - task->used : 1;
+
+  if (task->budgetArmed)
+    return;
+  task->budgetArmed = true;
+  task->refs++;
+  g_machine->interrupt->Schedule(BudgetTimer, (int64_t) task, left, TIMER_INT);
+}
+
+//----------------------------------------------------------------------
+// ArmRelease
+/*! 	Program a timer interrupt for the start of the next period of a
+//	periodic task, unless one is already pending.
+*/
+//----------------------------------------------------------------------
+static void
+ArmRelease(PeriodicTask *task) {
+  Time now = g_stats->getTotalTicks();
+  Time when = task->release + task->period;
+
+  if (task->releaseArmed)
+    return;
+  task->releaseArmed = true;
+  task->refs++;
+  g_machine->interrupt->Schedule(ReleaseTimer, (int64_t) task,
+                                 (when > now) ? when - now : 1, TIMER_INT);
+}
 
 //----------------------------------------------------------------------
 //  Scheduler::Scheduler
@@ -38,27 +117,56 @@ thread.
 //      running threads to empty.
 */
 //----------------------------------------------------------------------
-Scheduler::Scheduler() { readyList = new Listint; }
+Scheduler::Scheduler() {
+  readyList = new ListTime;
+  rtReadyList = new ListTime;
+  rtShare = 0;
+  accountedAt = 0;
+  idleAt = 0;
+  minVruntime = 0;
+  numAccounts = 0;
+  numOvertakes = 0;
+  preempting = false;
+}
 
 //----------------------------------------------------------------------
 // Scheduler::~Scheduler
 /*! 	Destructor. De-allocate the list of ready threads.
  */
 //----------------------------------------------------------------------
-Scheduler::~Scheduler() { delete readyList; }
+Scheduler::~Scheduler() {
+  delete readyList;
+  delete rtReadyList;
+}
 
 //----------------------------------------------------------------------
 // Scheduler::ReadyToRun
 /*! 	Mark a thread as ready, but not necessarily running yet.
 //	Put it in the ready list, for later scheduling onto the CPU.
 //
+//	With the fair-share policy, a thread which was sleeping (or a new
+//	one) does not get back the time it did not use: its virtual
+//	runtime is brought up to the one of the last elected thread.
+//
+//	A periodic thread within its budget goes to the real-time class.
+//
 //	\param thread is the thread to be put on the ready list.
 */
 //----------------------------------------------------------------------
 void
 Scheduler::ReadyToRun(Thread *thread) {
   DEBUG('t', (char *) "Putting thread %s in ready list.\n", thread->GetName());
-  readyList->Append((void *) thread);
+  PeriodicTask *task = thread->periodic;
+  if ((task != NULL) && !task->throttled) {
+    rtReadyList->SortedInsert((void *) thread, task->deadline);
+    return;
+  }
+  if (g_cfg->SchedPolicy == POLICY_FAIR_SHARE) {
+    if (thread->vruntime < minVruntime)
+      thread->vruntime = minVruntime;
+    readyList->SortedInsert((void *) thread, thread->vruntime);
+  } else
+    readyList->Append((void *) thread);
 }
 
 //----------------------------------------------------------------------
@@ -67,15 +175,151 @@ Scheduler::ReadyToRun(Thread *thread) {
 //	If there are no ready threads, return NULL.
 // Side effect:
 //	Thread is removed from the ready list.
+//	This is called when the running thread gives up the CPU, which is
+//	the time to charge it for the CPU it used.
+//
+//	The ready periodic thread with the earliest deadline is elected
+//	first. Otherwise, a ready thread of the running process is
+//	elected before the head
+//	of the ready list, as it does not need the address space to be
+//	switched. To stay fair, the head is overtaken at most
+//	SchedAffinity times in a row, and never when the running thread
+//	yields by itself: it would otherwise keep the CPU within its
+//	process while polling (see Thread::Join).
+//
+// \param yielding is true when called from Thread::Yield
 // \return Thread to be scheduled on the CPU
 */
 //----------------------------------------------------------------------
 Thread *
-Scheduler::FindNextToRun() {
-  Thread *thread = (Thread *) readyList->Remove();
+Scheduler::FindNextToRun(bool yielding) {
+  Account();
+  if (!rtReadyList->IsEmpty())
+    return (Thread *) rtReadyList->Remove();
+
+  Thread *thread = NULL;
+  ListElement<Time> *first = readyList->getFirst();
+  Process *owner =
+      (g_current_thread != NULL) ? g_current_thread->GetProcessOwner() : NULL;
+
+  if ((!yielding || preempting) && (first != NULL) && (owner != NULL) &&
+      (((Thread *) first->item)->GetProcessOwner() != owner) &&
+      (numOvertakes < g_cfg->SchedAffinity)) {
+    for (ListElement<Time> *e = first->next; e != NULL; e = e->next) {
+      if (((Thread *) e->item)->GetProcessOwner() == owner) {
+        thread = (Thread *) e->item;
+        break;
+      }
+    }
+  }
+  if (thread != NULL) {
+    readyList->RemoveItem(thread);
+    numOvertakes++;
+  } else {
+    thread = (Thread *) readyList->Remove();
+    numOvertakes = 0;
+  }
+  if ((thread != NULL) && (thread->vruntime > minVruntime))
+    minVruntime = thread->vruntime;
   return thread;
 }
 
+//----------------------------------------------------------------------
+// Scheduler::Account
+/*! 	Charge the CPU time used since the last accounting (idle time
+//	excluded) to the running thread and its process. With the
+//	fair-share policy, also grow the virtual runtime of the thread,
+//	and split the time between the processes which were competing for
+//	the CPU, in proportion of their weight, to know their fair share.
+*/
+//----------------------------------------------------------------------
+void
+Scheduler::Account() {
+  Time now = g_stats->getTotalTicks();
+  Time idle = g_stats->getIdleTicks();
+  Time delta = (now - accountedAt) - (idle - idleAt);
+  ListElement<Time> *e;
+
+  accountedAt = now;
+  idleAt = idle;
+  if ((delta == 0) || (g_current_thread == NULL))
+    return;
+  if (g_current_thread->periodic != NULL)
+    g_current_thread->periodic->used += delta;
+  Process *owner = g_current_thread->GetProcessOwner();
+  if (owner == NULL)
+    return;
+
+  if (g_current_thread->stat != NULL)
+    g_current_thread->stat->incrCpuTicks(delta);
+  else
+    owner->stat->incrCpuTicks(delta);
+  if (g_cfg->SchedPolicy != POLICY_FAIR_SHARE)
+    return;
+
+  // Sum the weights of the competing processes, each of them once: a
+  // process is marked when counted. Count the runnable threads of the
+  // running process on the way, the running one included
+  uint64_t totalWeight = owner->weight;
+  uint64_t runnable = 1;
+  owner->accountMark = ++numAccounts;
+  for (e = readyList->getFirst(); e != NULL; e = e->next) {
+    Process *p = ((Thread *) e->item)->GetProcessOwner();
+    if (p == owner)
+      runnable++;
+    else if (p->accountMark != numAccounts) {
+      p->accountMark = numAccounts;
+      totalWeight += p->weight;
+    }
+  }
+
+  // The share of the thread is the weight of its process divided by
+  // the number of its runnable threads
+  g_current_thread->vruntime +=
+      (delta * DEFAULT_WEIGHT * runnable) / owner->weight;
+
+  // Then give each of them its part of delta
+  owner->stat->incrFairTicks((delta * owner->weight) / totalWeight);
+  owner->accountMark = ++numAccounts;
+  for (e = readyList->getFirst(); e != NULL; e = e->next) {
+    Process *p = ((Thread *) e->item)->GetProcessOwner();
+    if (p->accountMark != numAccounts) {
+      p->accountMark = numAccounts;
+      p->stat->incrFairTicks((delta * p->weight) / totalWeight);
+    }
+  }
+}
+
+//----------------------------------------------------------------------
+// Scheduler::ShouldPreempt
+/*! 	Called on timer interrupts, in time sharing mode. With the FIFO
+//	policy, the running thread gives up the CPU as soon as another
+//	one is ready. With the fair-share policy, only when a ready
+//	thread has a smaller virtual runtime. A periodic thread within
+//	its budget only gives it up to one with an earlier deadline, and
+//	the other threads to any ready periodic thread.
+//
+// \return true if the running thread should yield the CPU
+*/
+//----------------------------------------------------------------------
+bool
+Scheduler::ShouldPreempt() {
+  Account();
+  PeriodicTask *task = g_current_thread->periodic;
+  ListElement<Time> *rtFirst = rtReadyList->getFirst();
+  if ((task != NULL) && !task->throttled)
+    return (rtFirst != NULL) && (rtFirst->key < task->deadline);
+  if (rtFirst != NULL)
+    return true;
+
+  ListElement<Time> *first = readyList->getFirst();
+  if (first == NULL)
+    return false;
+  if (g_cfg->SchedPolicy == POLICY_FAIR_SHARE)
+    return (first->key < g_current_thread->vruntime);
+  return true;
+}
+
 //----------------------------------------------------------------------
 // Scheduler::SwitchTo
 /*! 	Dispatch the CPU to nextThread.  Save the state of the old thread,
@@ -91,7 +335,11 @@ Scheduler::FindNextToRun() {
 //----------------------------------------------------------------------
 void
 Scheduler::SwitchTo(Thread *nextThread) {
+  PROFILE_ZONE(PROFILE_SWITCH);
   Thread *oldThread = g_current_thread;
+  bool involuntary = preempting;
+
+  preempting = false;
 
   g_current_thread->CheckOverflow();   // check if the old thread
                                        // had an undetected stack overflow
@@ -108,8 +356,26 @@ Scheduler::SwitchTo(Thread *nextThread) {
   oldThread->SaveProcessorState();
   oldThread->SaveSimulatorState();
 
+  // A periodic thread gets a one-shot timer interrupt for the end of
+  // its budget, even when it goes on running (released while idle)
+  if ((nextThread->periodic != NULL) && !nextThread->periodic->throttled)
+    ArmBudget(nextThread->periodic);
+
   // Do the context switch if the two threads are different
   if (oldThread != g_current_thread) {
+    bool sameSpace =
+        (oldThread->GetProcessOwner() == nextThread->GetProcessOwner());
+
+    g_stats->incrSwitches(sameSpace);
+    oldThread->stat->incrSwitches(involuntary);
+    g_machine->SpinDisturbed();
+
+    // The threads of a process share its address space: only load
+    // the translation table when going to another process
+    if (!sameSpace)
+      g_machine->mmu->translationTable =
+          nextThread->GetProcessOwner()->addrspace->translationTable;
+
     // Restore the state of the operating system from its
     // kernelContext structure such that it goes on executing when
     // it was last interrupted
@@ -131,6 +397,7 @@ Scheduler::SwitchTo(Thread *nextThread) {
   if (oldThread == g_thread_to_be_destroyed){
     ASSERT(g_current_thread == g_thread_to_be_destroyed);//pas moi qui me detruit
     g_scheduler->readyList->RemoveItem(oldThread);
+    g_scheduler->rtReadyList->RemoveItem(oldThread);
     delete oldThread->GetProcessOwner()->addrspace; // pas necessaire
     delete oldThread;
     g_thread_to_be_destroyed = NULL;
@@ -140,15 +407,175 @@ Scheduler::SwitchTo(Thread *nextThread) {
 
 }
 
+//----------------------------------------------------------------------
+// Scheduler::Preempt
+/*! 	Make the running thread give up the CPU, at the end of its time
+//	slice. Unlike when the thread yields by itself, the context
+//	switch is counted as involuntary in its statistics.
+*/
+//----------------------------------------------------------------------
+void
+Scheduler::Preempt() {
+  preempting = true;
+  g_current_thread->Yield();
+  preempting = false;   // in case no other thread was ready
+}
+
+//----------------------------------------------------------------------
+// Scheduler::SetPeriodic
+/*! 	Make the running thread a periodic one, its first job being
+//	released now, or a background thread again if period is 0.
+//	Admission control: the periodic threads are only accepted if
+//	the sum of their CPU shares (budget / deadline) does not exceed
+//	the whole CPU, the condition for EDF to meet all the deadlines.
+//
+//	\param period the period, in cycles, 0 to leave the class
+//	\param budget the CPU time of each job, in cycles
+//	\param deadline the deadline of each job, from its release
+//	       (budget <= deadline <= period)
+// \return false if the thread cannot be admitted
+*/
+//----------------------------------------------------------------------
+bool
+Scheduler::SetPeriodic(Time period, Time budget, Time deadline) {
+  PeriodicTask *task = g_current_thread->periodic;
+  uint64_t share = (period != 0) ? (budget * MAX_RT_SHARE) / deadline : 0;
+  uint64_t oldShare = (task != NULL) ? task->share : 0;
+
+  if (rtShare - oldShare + share > MAX_RT_SHARE)
+    return false;
+  rtShare = rtShare - oldShare + share;
+
+  // Pending interrupts about the old parameters are ignored
+  Account();
+  if (task != NULL) {
+    task->thread = NULL;
+    g_current_thread->periodic = NULL;
+    PutTask(task);
+  }
+  if (period == 0)
+    return true;
+
+  task = new PeriodicTask;
+  task->thread = g_current_thread;
+  task->period = period;
+  task->budget = budget;
+  task->relDeadline = deadline;
+  task->share = share;
+  task->release = g_stats->getTotalTicks();
+  task->waiting = false;
+  task->budgetArmed = false;
+  task->releaseArmed = false;
+  task->refs = 1;
+  StartJob(task);
+  g_current_thread->periodic = task;
+  ArmBudget(task);
+  return true;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::WaitNextPeriod
+/*! 	End the job of the running periodic thread, counting whether it
+//	met its deadline, and block the thread until the start of its
+//	next period. A late thread whose next period has already started
+//	goes on at once. Interrupts must be disabled.
+*/
+//----------------------------------------------------------------------
+void
+Scheduler::WaitNextPeriod() {
+  PeriodicTask *task = g_current_thread->periodic;
+  Time now = g_stats->getTotalTicks();
+
+  Account();
+  g_stats->incrJobs(now > task->deadline);
+  if (task->releaseArmed || (task->release + task->period > now)) {
+    ArmRelease(task);
+    task->waiting = true;
+    g_current_thread->Block(BLOCKED_PERIOD);
+  } else {
+    task->release += task->period;
+    StartJob(task);
+    ArmBudget(task);
+  }
+}
+
+//----------------------------------------------------------------------
+// Scheduler::BudgetExpired
+/*! 	Timer interrupt handler, programmed when a periodic thread is
+//	dispatched (see ArmBudget). If its job has used up its budget, it
+//	goes on in the background class until its next period, and gives
+//	up the CPU. If the job is still running within its budget (it was
+//	switched out meanwhile), the interrupt is programmed again for
+//	what is left; if it no longer runs, its next dispatch does it.
+//
+//	\param task the periodic task
+*/
+//----------------------------------------------------------------------
+void
+Scheduler::BudgetExpired(PeriodicTask *task) {
+  task->budgetArmed = false;
+  if ((task->thread == g_current_thread) && !task->throttled) {
+    Account();
+    if (task->used >= task->budget) {
+      DEBUG('t', (char *) "Thread %s overruns its budget\n",
+            task->thread->GetName());
+      task->throttled = true;
+      g_stats->incrOverruns();
+      ArmRelease(task);
+      if (g_machine->GetStatus() != IDLE_MODE)
+        g_machine->interrupt->YieldOnReturn();
+    } else
+      ArmBudget(task);
+  }
+  PutTask(task);
+}
+
+//----------------------------------------------------------------------
+// Scheduler::ReleaseJob
+/*! 	Timer interrupt handler, at the start of the next period of a
+//	periodic thread, blocked in WaitNextPeriod or throttled: start
+//	its new job, and preempt the running thread if the new job has an
+//	earlier deadline. A throttled job has missed its deadline, what is
+//	left of it goes on as the new job, back in the real-time class.
+//
+//	\param task the periodic task
+*/
+//----------------------------------------------------------------------
+void
+Scheduler::ReleaseJob(PeriodicTask *task) {
+  Thread *thread = task->thread;
+
+  task->releaseArmed = false;
+  if (thread != NULL) {
+    task->release += task->period;
+    StartJob(task);
+    if (task->waiting) {
+      task->waiting = false;
+      ReadyToRun(thread);
+    } else {
+      g_stats->incrJobs(true);
+      if (readyList->Search(thread)) {
+        readyList->RemoveItem(thread);
+        ReadyToRun(thread);
+      } else if (thread == g_current_thread)
+        ArmBudget(task);
+    }
+    if ((g_machine->GetStatus() != IDLE_MODE) && ShouldPreempt())
+      g_machine->interrupt->YieldOnReturn();
+  }
+  PutTask(task);
+}
+
 //----------------------------------------------------------------------
 // Scheduler::Print
 /*! 	Print the scheduler state -- in other words, the contents of
-//	the ready list.  For debugging.
+//	the ready lists.  For debugging.
 */
 //----------------------------------------------------------------------
 void
 Scheduler::Print() {
   printf("Ready list contents: [");
+  rtReadyList->Mapcar((VoidFunctionPtr) ThreadPrint);
   readyList->Mapcar((VoidFunctionPtr) ThreadPrint);
   printf("]\n");
 }
@@ -32,6 +32,48 @@
 
 class Thread;
 
+/*! \brief Parameters and state of a periodic real-time thread
+//
+// A periodic thread runs one job per period. A job is released at the
+// start of its period, and must be done before its deadline, using at
+// most "budget" cycles of CPU. A job which uses up its budget is
+// throttled until the start of the next period, where it goes on as
+// the next job. At most one budget and one release timer interrupt are
+// pending for a task; the object outlives its thread while they are.
+*/
+class PeriodicTask {
+public:
+  Thread *thread;     //!< The thread, NULL once it is no longer periodic
+  Time period;        //!< Period, in cycles
+  Time budget;        //!< CPU time allowed to each job, in cycles
+  Time relDeadline;   //!< Deadline of a job, from its release
+  uint64_t share;     //!< Share of the CPU reserved, in millionths
+  Time release;       //!< Release time of the current job
+  Time deadline;      //!< Absolute deadline of the current job
+  Time used;          //!< CPU time used by the current job
+  bool throttled;     //!< The job has used up its budget
+  bool waiting;       //!< The thread is blocked in WaitNextPeriod
+  bool budgetArmed;   //!< A budget timer interrupt is pending
+  bool releaseArmed;  //!< A release timer interrupt is pending
+  int refs;           //!< The thread and the pending timer interrupts
+};
+
+/*! \brief Defines the scheduler of the threads
+//
+// The periodic threads (see SetPeriodic) form a real-time class, which
+// runs before the others: the ready one with the earliest deadline
+// runs first (EDF). The other threads, and the periodic ones whose job
+// has used up its budget, form the background class, scheduled by the
+// policy below.
+//
+// With the POLICY_FIFO policy, the ready threads run in the order they
+// became ready. With POLICY_FAIR_SHARE, the ready list is sorted by
+// virtual runtime, and the thread with the smallest one runs next. The
+// virtual runtime of a thread grows with the CPU time it uses, scaled
+// by its share: the weight of its process divided by the number of
+// runnable threads of the process. A process thus gets the CPU in
+// proportion of its weight, whatever its number of threads.
+*/
 class Scheduler {
 public:
   //! Constructor. Initializes list of ready threads.
@@ -44,17 +86,57 @@ public:
   void ReadyToRun(Thread *thread);
 
   //! Dequeue first thread of the ready list, if any, and return thread.
-  Thread *FindNextToRun();
+  //! yielding is true when the running thread gives up the CPU by itself
+  Thread *FindNextToRun(bool yielding = false);
+
+  //! True if no thread is ready to run
+  bool IsReadyListEmpty() {
+    return readyList->IsEmpty() && rtReadyList->IsEmpty();
+  }
 
   //! Causes a context switch to nextThread
   void SwitchTo(Thread *nextThread);
 
+  //! Charge the CPU time used since the last call to the running thread
+  void Account();
+
+  //! Check whether the running thread should give up the CPU
+  bool ShouldPreempt();
+
+  //! Make the running thread give up the CPU at the end of its time slice
+  void Preempt();
+
+  //! Make the running thread periodic, or a background one again
+  bool SetPeriodic(Time period, Time budget, Time deadline);
+
+  //! End the job of the running periodic thread, wait for the next one
+  void WaitNextPeriod();
+
+  //! Timer interrupt: the job of a periodic thread may be out of budget
+  void BudgetExpired(PeriodicTask *task);
+
+  //! Timer interrupt: start of a new period of a periodic thread
+  void ReleaseJob(PeriodicTask *task);
+
   //! Print contents of ready list.
   void Print();
 
 protected:
-  //! Queue of threads that are ready to run, but not running.
-  Listint *readyList;
+  //! Queue of threads that are ready to run, but not running, sorted
+  //  by virtual runtime with the fair-share policy.
+  ListTime *readyList;
+
+  //! Periodic threads ready to run, sorted by deadline
+  ListTime *rtReadyList;
+
+  uint64_t rtShare;       //!< CPU reserved by the periodic threads
+
+  Time accountedAt;       //!< Total time at the last accounting
+  Time idleAt;            //!< Idle time at the last accounting
+  Time minVruntime;       //!< Virtual runtime of the last elected thread
+  uint64_t numAccounts;   //!< To mark the processes (see Account)
+  uint32_t numOvertakes;  //!< Elections in a row that overtook the head
+  bool preempting;        //!< The next switch is a preemption
 };
 
 #endif   // SCHEDULER_H
@@ -50,6 +50,7 @@ Semaphore::Semaphore(char* debugName, uint32_t initialCount) {
     strcpy(name, debugName);
     counter = initialCount;
     waiting_queue = new Listint;
+    waiters = new Listint;
     type = SEMAPHORE_TYPE;
 }
 
@@ -68,8 +69,10 @@ Semaphore::~Semaphore() {
         waiting_queue->Append((void*)t);
     }
     ASSERT(waiting_queue->IsEmpty());
+    ASSERT(waiters->IsEmpty());
     delete[] name;
     delete waiting_queue;
+    delete waiters;
 }
 
 //----------------------------------------------------------------------
@@ -96,7 +99,7 @@ void Semaphore::P() {
         IntStatus old_status = g_machine->interrupt->GetStatus();
         g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
         this->waiting_queue->Append(g_current_thread);
-        g_current_thread->Sleep();
+        g_current_thread->Block(BLOCKED_SEMAPHORE);
         g_machine->interrupt->SetStatus(old_status);
     }
 }
@@ -118,20 +121,37 @@ void Semaphore::V() {
 #endif
 #ifdef ETUDIANTS_TP
 void Semaphore::V() {
+    IntStatus old_status = g_machine->interrupt->GetStatus();
+    g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
     if (this->counter < 0) {
-        IntStatus old_status = g_machine->interrupt->GetStatus();
-        g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
         if (!this->waiting_queue->IsEmpty()){
           Thread* thread = (Thread*)this->waiting_queue->getFirst()->item;
           this->waiting_queue->Remove();
           g_scheduler->ReadyToRun(thread);
         }
-        g_machine->interrupt->SetStatus(old_status);
     }
     this->counter++;
+    if (this->counter > 0)
+        Waiter::WakeAll(waiters);
+    g_machine->interrupt->SetStatus(old_status);
 }
 #endif
 
+//----------------------------------------------------------------------
+// Semaphore::TryP
+/*! Decrement the semaphore value if it is positive, with interrupts
+//  disabled.
+//
+//  \return true if the value was decremented, false if P would block
+*/
+//----------------------------------------------------------------------
+bool Semaphore::TryP() {
+    if (counter <= 0)
+        return false;
+    counter--;
+    return true;
+}
+
 //----------------------------------------------------------------------
 // Lock::Lock
 /*! 	Initialize a Lock, so that it can be used for synchronization.
@@ -145,6 +165,7 @@ Lock::Lock(char* debugName) {
     this->waiting_queue = new Listint;
     this->free = true;
     this->owner = NULL;
+    this->waiters = new Listint;
     this->type = LOCK_TYPE;
 }
 
@@ -157,8 +178,10 @@ Lock::Lock(char* debugName) {
 Lock::~Lock() {
     this->type = INVALID_TYPE;
     ASSERT(waiting_queue->IsEmpty());
+    ASSERT(waiters->IsEmpty());
     delete[] name;
     delete waiting_queue;
+    delete waiters;
 }
 
 //----------------------------------------------------------------------
@@ -185,7 +208,7 @@ void Lock::Acquire() {
 
     if (!this->free) {
         waiting_queue->Append(g_current_thread);
-        g_current_thread->Sleep();
+        g_current_thread->Block(BLOCKED_LOCK);
     }
     else{
         owner = g_current_thread;
@@ -217,6 +240,7 @@ void Lock::Release() {
     if (waiting_queue->IsEmpty()) {
         free = true;
         owner = NULL;
+        Waiter::WakeAll(waiters);
         g_machine->interrupt->SetStatus(old_status);
         return;
     }
@@ -227,6 +251,21 @@ void Lock::Release() {
     g_machine->interrupt->SetStatus(old_status);
 }
 #endif
+//----------------------------------------------------------------------
+// Lock::TryAcquire
+/*! Acquire the lock if it is free, with interrupts disabled.
+//
+//  \return true if the lock was acquired, false if Acquire would block
+*/
+//----------------------------------------------------------------------
+bool Lock::TryAcquire() {
+    if (!free)
+        return false;
+    free = false;
+    owner = g_current_thread;
+    return true;
+}
+
 //----------------------------------------------------------------------
 // Lock::isHeldByCurrentThread
 /*! To check if current thread hold the lock
@@ -247,6 +286,7 @@ Condition::Condition(char* debugName) {
     name = new char[strlen(debugName) + 1];
     strcpy(name, debugName);
     waiting_queue = new Listint;
+    lock = NULL;
     type = CONDITION_TYPE;
 }
 
@@ -281,11 +321,70 @@ void Condition::Wait() {
     IntStatus real_Status = g_machine->interrupt->GetStatus();
     g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
 
+    ASSERT(lock == NULL);
+    this->waiting_queue->Append(g_current_thread);
+    g_current_thread->Block(BLOCKED_CONDITION);
+
+    g_machine->interrupt->SetStatus(real_Status);
+}
+#endif
+
+//----------------------------------------------------------------------
+// Condition::Wait
+/*! Release the lock held by the calling thread and block it (put it in
+//  the wait queue), then acquire the lock again once signalled.
+//  This operation must be atomic, so we need to disable interrupts.
+//
+//  \param conditionLock the lock protecting the condition
+*/
+//----------------------------------------------------------------------
+#ifndef ETUDIANTS_TP
+void Condition::Wait(Lock* conditionLock) {
+    printf("**** Warning: method Condition::Wait is not implemented yet\n");
+    exit(ERROR);
+}
+#endif
+
+#ifdef ETUDIANTS_TP
+void Condition::Wait(Lock* conditionLock) {
+    IntStatus real_Status = g_machine->interrupt->GetStatus();
+    g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+
+    ASSERT(conditionLock->isHeldByCurrentThread());
+    ASSERT((lock == NULL) || (lock == conditionLock));
+    lock = conditionLock;
     this->waiting_queue->Append(g_current_thread);
-    g_current_thread->Sleep();
+    conditionLock->Release();
+    g_current_thread->Block(BLOCKED_CONDITION);
+
+    // With wait morphing, the lock has been handed over to the thread
+    // before it was woken up
+    if (!conditionLock->isHeldByCurrentThread())
+        conditionLock->Acquire();
 
     g_machine->interrupt->SetStatus(real_Status);
 }
+
+//----------------------------------------------------------------------
+// Condition::Wake
+/*! Wake up a thread just removed from the wait queue, with interrupts
+//  disabled. With wait morphing, a thread waiting with a lock gets the
+//  lock if it is free, and else waits directly for the lock.
+//
+//  \param thread the thread to wake up
+*/
+//----------------------------------------------------------------------
+void Condition::Wake(Thread* thread) {
+    if ((lock == NULL) || !g_cfg->WaitMorphing) {
+        g_scheduler->ReadyToRun(thread);
+    } else if (lock->free) {
+        lock->free = false;
+        lock->owner = thread;
+        g_scheduler->ReadyToRun(thread);
+    } else {
+        lock->waiting_queue->Append(thread);
+    }
+}
 #endif
 
 //----------------------------------------------------------------------
@@ -308,8 +407,10 @@ void Condition::Signal() {
 
     if (!this->waiting_queue->IsEmpty()) {
         Thread* thread = (Thread*)waiting_queue->Remove();
-        g_scheduler->ReadyToRun(thread);
+        Wake(thread);
     }
+    if (this->waiting_queue->IsEmpty())
+        lock = NULL;
 
     g_machine->interrupt->SetStatus(real_Status);
 }
@@ -332,11 +433,206 @@ void Condition::Broadcast() {
     IntStatus real_Status = g_machine->interrupt->GetStatus();
     g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
 
+    if ((lock != NULL) && g_cfg->WaitMorphing) {
+        // The first waiter gets the lock if it is free, the others are
+        // all moved to the wait queue of the lock at once
+        if (lock->free && !this->waiting_queue->IsEmpty())
+            Wake((Thread*)waiting_queue->Remove());
+        lock->waiting_queue->Concat(this->waiting_queue);
+    }
     while (!this->waiting_queue->IsEmpty()) {
         Thread* thread = (Thread*)waiting_queue->Remove();
         g_scheduler->ReadyToRun(thread);
     }
+    lock = NULL;
 
     g_machine->interrupt->SetStatus(real_Status);
 }
-#endif
\ No newline at end of file
+#endif
+
+//----------------------------------------------------------------------
+// Barrier::Barrier
+/*! 	Initializes a barrier, so that it can be used for synchronization.
+//
+//    \param  "debugName" is an arbitrary name, useful for debugging.
+//    \param  "nbThreads" is the number of threads meeting at the barrier.
+*/
+//----------------------------------------------------------------------
+Barrier::Barrier(char* debugName, int nbThreads) {
+    ASSERT(nbThreads > 0);
+    name = new char[strlen(debugName) + 1];
+    strcpy(name, debugName);
+    waiting_queue = new Listint;
+    count = nbThreads;
+    arrived = 0;
+    phases = 0;
+    phaseStart = totalWait = maxWait = 0;
+    type = BARRIER_TYPE;
+}
+
+//----------------------------------------------------------------------
+// Barrier::~Barrier
+/*! 	De-allocate the barrier, when no longer needed, and print the
+//      time spent at its phases. Assumes that nobody is waiting on it.
+*/
+//----------------------------------------------------------------------
+Barrier::~Barrier() {
+    type = INVALID_TYPE;
+    ASSERT(waiting_queue->IsEmpty());
+    if (g_cfg->PrintStat && (phases > 0))
+        printf("Barrier %s: %" PRIu64 " phases, %" PRIu64
+               " ticks on average, %" PRIu64 " ticks at most\n",
+               name, phases, totalWait / phases, maxWait);
+    delete[] name;
+    delete waiting_queue;
+}
+
+//----------------------------------------------------------------------
+// Barrier::Wait
+/*! Block the calling thread until all the threads have called Wait.
+//  The last thread to arrive moves all the waiting threads to the
+//  ready list in a single pass, without blocking.
+//  This operation must be atomic, so we need to disable interrupts.
+*/
+//----------------------------------------------------------------------
+#ifndef ETUDIANTS_TP
+void Barrier::Wait() {
+    printf("**** Warning: method Barrier::Wait is not implemented yet\n");
+    exit(ERROR);
+}
+#endif
+
+#ifdef ETUDIANTS_TP
+void Barrier::Wait() {
+    IntStatus old_status = g_machine->interrupt->GetStatus();
+    g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+
+    Time now = g_stats->getTotalTicks();
+    if (arrived == 0)
+        phaseStart = now;
+    arrived++;
+
+    if (arrived < count) {
+        waiting_queue->Append(g_current_thread);
+        g_current_thread->Block(BLOCKED_BARRIER);
+    } else {
+        Time wait = now - phaseStart;
+        DEBUG('s', (char*)"Barrier \"%s\": phase %" PRIu64
+              " completed in %" PRIu64 " ticks\n", name, phases, wait);
+        phases++;
+        totalWait += wait;
+        if (wait > maxWait)
+            maxWait = wait;
+        arrived = 0;
+        while (!waiting_queue->IsEmpty())
+            g_scheduler->ReadyToRun((Thread*)waiting_queue->Remove());
+    }
+
+    g_machine->interrupt->SetStatus(old_status);
+}
+#endif
+
+//----------------------------------------------------------------------
+// WaiterTimeout
+/*! Interrupt handler of the timeout of a waiter. Needs this to be a C
+//  routine, because C++ can't handle pointers to member functions.
+//
+//  \param arg the waiter
+*/
+//----------------------------------------------------------------------
+static void WaiterTimeout(int64_t arg) {
+    ((Waiter*)arg)->Expire();
+}
+
+//----------------------------------------------------------------------
+// Waiter::Waiter
+/*! 	Initializes a waiter for the current thread, without timeout.
+*/
+//----------------------------------------------------------------------
+Waiter::Waiter() {
+    thread = g_current_thread;
+    sleeping = false;
+    timedOut = false;
+    released = false;
+    refs = 1;
+}
+
+//----------------------------------------------------------------------
+// Waiter::SetTimeout
+/*! 	Schedule the wake up of the thread after a delay.
+//
+//    \param nanos the delay, in nanoseconds
+*/
+//----------------------------------------------------------------------
+void Waiter::SetTimeout(uint64_t nanos) {
+    Time delay = nano_to_cycles(nanos, g_cfg->ProcessorFrequency);
+    if (delay == 0)
+        delay = 1;
+    refs++;
+    g_machine->interrupt->Schedule(WaiterTimeout, (int64_t)this, delay,
+                                   TIMER_INT);
+}
+
+//----------------------------------------------------------------------
+// Waiter::Sleep
+/*! Block the thread until an object is ready or the timeout expires.
+//  Interrupts must be disabled.
+*/
+//----------------------------------------------------------------------
+void Waiter::Sleep() {
+    ASSERT(thread == g_current_thread);
+    sleeping = true;
+    g_current_thread->Block(BLOCKED_WAITANY);
+}
+
+//----------------------------------------------------------------------
+// Waiter::Wake
+/*! Wake up the thread if it is blocked. Interrupts must be disabled.
+*/
+//----------------------------------------------------------------------
+void Waiter::Wake() {
+    if (sleeping) {
+        sleeping = false;
+        g_scheduler->ReadyToRun(thread);
+    }
+}
+
+//----------------------------------------------------------------------
+// Waiter::WakeAll
+/*! Wake up all the waiters of an object which has become ready. They
+//  stay in the list until their thread stops waiting.
+//
+//    \param waiters the waiters of the object
+*/
+//----------------------------------------------------------------------
+void Waiter::WakeAll(Listint* waiters) {
+    for (ListElement<int>* e = waiters->getFirst(); e != NULL; e = e->next)
+        ((Waiter*)e->item)->Wake();
+}
+
+//----------------------------------------------------------------------
+// Waiter::Expire
+/*! Wake up the thread when the timeout expires, unless it has already
+//  stopped waiting.
+*/
+//----------------------------------------------------------------------
+void Waiter::Expire() {
+    if (!released) {
+        timedOut = true;
+        Wake();
+    }
+    if (--refs == 0)
+        delete this;
+}
+
+//----------------------------------------------------------------------
+// Waiter::Release
+/*! Called by the thread when it stops waiting, once it is removed from
+//  the waiter lists of the objects. Interrupts must be disabled.
+*/
+//----------------------------------------------------------------------
+void Waiter::Release() {
+    released = true;
+    if (--refs == 0)
+        delete this;
+}
\ No newline at end of file
@@ -32,6 +32,8 @@
 #include "kernel/thread.h"
 #include "utility/list.h"
 
+class Waiter;
+
 /*! \brief Defines the "semaphore" synchronization tool
 //
 // The semaphore has only two operations P() and V():
@@ -62,10 +64,27 @@ public:
   void P();   // these are the only operations on a semaphore
   void V();   // they are both *atomic*
 
+  //! Do a P() if it does not block, with interrupts disabled (WaitAny)
+  bool TryP();
+
+  //! true if a P() would not block, with interrupts disabled
+  bool IsPositive() { return counter > 0; }
+
+  //! Wake up w each time the value becomes > 0
+  void AddWaiter(Waiter *w) { waiters->Append(w); }
+  void RemoveWaiter(Waiter *w) { waiters->RemoveItem(w); }
+
+  //! true if threads wait for the semaphore, in P() or in WaitAny
+  bool HasWaiters() {
+    return !waiting_queue->IsEmpty() || !waiters->IsEmpty();
+  }
+
 private:
   char *name;               //!< useful for debugging
   int counter;              //!< semaphore counter
   Listint *waiting_queue;   //!< threads waiting in P() for the value to be > 0
+  Listint *waiters;         //!< threads waiting in WaitAny for the value
+                            //!< to be > 0
 
 public:
   //! Object type, for validity checks during system calls (must be the first
@@ -104,6 +123,18 @@ public:
   //! Release a lock (atomic operation)
   void Release();
 
+  //! Acquire the lock if it is free, with interrupts disabled (WaitAny)
+  bool TryAcquire();
+
+  //! Wake up w each time the lock becomes free
+  void AddWaiter(Waiter *w) { waiters->Append(w); }
+  void RemoveWaiter(Waiter *w) { waiters->RemoveItem(w); }
+
+  //! true if threads wait for the lock, in Acquire() or in WaitAny
+  bool HasWaiters() {
+    return !waiting_queue->IsEmpty() || !waiters->IsEmpty();
+  }
+
   //! true if the current thread holds this lock.  Useful for checking
   //! in Release, and in Condition variable operations below.
   bool isHeldByCurrentThread();
@@ -113,6 +144,9 @@ private:
   Listint *waiting_queue;   //!< threads waiting to acquire the lock
   bool free;                //!< to know if the lock is free
   Thread *owner;            //!< Thread who has acquired the lock
+  Listint *waiters;         //!< threads waiting in WaitAny for the lock
+
+  friend class Condition;   //!< Moves its waiters to the lock (wait morphing)
 
 public:
   //! Object type, for validity checks during system calls (must be the first
@@ -134,6 +168,13 @@ public:
 //
 //	Broadcast() -- wake up all threads waiting on the condition
 //
+// A thread may wait with a lock it holds: the lock is released while
+// the thread waits, and held again when Wait returns. With wait
+// morphing (see the WaitMorphing option), a waiter signalled while the
+// lock is held is moved directly to the wait queue of the lock, instead
+// of being woken up only to block again on the lock. A broadcast then
+// moves all the waiters at once. All the threads waiting at the same
+// time on a condition must use the same lock.
 */
 class Condition {
 public:
@@ -149,6 +190,10 @@ public:
   //! Wait until the condition is signalled
   void Wait();
 
+  //! Release the lock, wait until the condition is signalled, and
+  //! acquire the lock again
+  void Wait(Lock *conditionLock);
+
   //! Wake up one of the thread waiting on the condition
   void Signal();
 
@@ -158,6 +203,9 @@ public:
 private:
   char *name;               //!< For debbuging
   Listint *waiting_queue;   //!< Threads asked to wait
+  Lock *lock;               //!< Lock of the waiting threads, if any
+
+  void Wake(Thread *thread);   //!< Wake up a thread removed from the queue
 
 public:
   //! Object type, for validity checks during system calls (must be the first
@@ -165,4 +213,91 @@ public:
   ObjectType type;
 };
 
+/*! \brief Defines the "barrier" synchronization tool.
+//
+// A barrier is created for a given number of threads. Each thread
+// calling Wait() blocks until all of them have called it, and the last
+// one to arrive releases all the others at once. The barrier can then
+// be used again for the next phase.
+//
+// The time between the first and the last arrival at each phase is
+// recorded, and printed when the barrier is deleted if statistics are
+// enabled.
+*/
+class Barrier {
+public:
+  //! Create a barrier for nbThreads threads
+  Barrier(char *debugName, int nbThreads);
+
+  //! Deallocate the barrier
+  ~Barrier();
+
+  //! For debugging
+  char *getName() { return (name); }
+
+  //! Wait until all the threads have reached the barrier
+  void Wait();
+
+  //! true if threads are waiting at the barrier
+  bool HasWaiters() { return !waiting_queue->IsEmpty(); }
+
+private:
+  char *name;               //!< For debbuging
+  Listint *waiting_queue;   //!< Threads waiting for the others
+  int count;                //!< Number of threads to wait for
+  int arrived;              //!< Threads arrived in the current phase
+  uint64_t phases;          //!< Number of completed phases
+  Time phaseStart;          //!< First arrival in the current phase
+  Time totalWait;           //!< Sum of the duration of the phases
+  Time maxWait;             //!< Duration of the longest phase
+
+public:
+  //! Object type, for validity checks during system calls (must be the first
+  //! public field)
+  ObjectType type;
+};
+
+/*! \brief Defines a thread waiting for any of several objects.
+//
+// A waiter is put in the waiter list of each object the thread waits
+// for (see Semaphore::AddWaiter). The first object to become ready,
+// or the expiry of the timeout, wakes the thread up; the thread then
+// checks the objects again. A waiter is also referenced by the timeout
+// interrupt, the last one of the thread and the interrupt to release
+// it deletes it.
+*/
+class Waiter {
+public:
+  //! Create a waiter for the current thread
+  Waiter();
+
+  //! Wait with a timeout, in nanoseconds
+  void SetTimeout(uint64_t nanos);
+
+  //! Block the thread until Wake is called, with interrupts disabled
+  void Sleep();
+
+  //! Wake up the thread if it is blocked, with interrupts disabled
+  void Wake();
+
+  //! Wake up the waiters of a list
+  static void WakeAll(Listint *waiters);
+
+  //! true once the timeout has expired
+  bool TimedOut() { return timedOut; }
+
+  //! Forget the waiter, with interrupts disabled
+  void Release();
+
+  //! Timeout interrupt handler
+  void Expire();
+
+private:
+  Thread *thread;   //!< The waiting thread
+  bool sleeping;    //!< Is the thread blocked in Sleep?
+  bool timedOut;    //!< Has the timeout expired?
+  bool released;    //!< Has the thread stopped waiting?
+  int refs;         //!< The thread and the pending timeout interrupt
+};
+
 #endif   // SYNCH_H
@@ -21,11 +21,14 @@
 #include "drivers/drvACIA.h"
 #include "drivers/drvConsole.h"
 #include "drivers/drvDisk.h"
+#include "drivers/drvVolume.h"
 #include "filesys/filesys.h"
 #include "filesys/oftable.h"
 #include "kernel/msgerror.h"
 #include "kernel/scheduler.h"
 #include "kernel/thread.h"
+#include "kernel/workqueue.h"
+#include "machine/timer.h"
 #include "utility/config.h"
 #include "utility/objaddr.h"
 #include "utility/stats.h"
@@ -40,15 +43,17 @@
 
 // Hardware components
 Machine *g_machine;   //!< Machine (includes CPU and peripherals)
+Timer *g_timer;       //!< Time slice timer, NULL without time sharing
 
 // Thread management
 Thread *g_current_thread;           //!< The thread holding the CPU
 Thread *g_thread_to_be_destroyed;   //!< The thread that just finished
 Listint *g_alive;                   //!< List of existing threads
 Scheduler *g_scheduler;             //!< Thread scheduler
+WorkQueue *g_work_queue;   //!< Work deferred by interrupt handlers
 
 // Device drivers
-DriverDisk *g_disk_driver;         //!< Disk driver
+DriverVolume *g_volume_driver;     //!< Volume over the data disks
 DriverDisk *g_swap_disk_driver;    //!< Swap disk driver
 DriverConsole *g_console_driver;   //!< Console driver
 DriverACIA *g_acia_driver;         //!< Serial line driver
@@ -93,18 +98,18 @@ CleanupOK() {
 //	if the interrupted thread called Yield at the point it is
 //	was interrupted.
 //
+//	The scheduler tells whether the interrupted thread has to give
+//	up the CPU (see Scheduler::ShouldPreempt).
+//
 //	\param dummy is because every interrupt handler takes one argument,
 //		whether it needs it or not.
 */
 //----------------------------------------------------------------------
-/*
 static void
-TimerInterruptHandler(int dummy)
-{
-    if (machine->getStatus() != IdleMode)
-        machine->interrupt->YieldOnReturn();
+TimerInterruptHandler(int64_t dummy) {
+  if ((g_machine->GetStatus() != IDLE_MODE) && g_scheduler->ShouldPreempt())
+    g_machine->interrupt->YieldOnReturn();
 }
-*/
 
 //----------------------------------------------------------------------
 // Initialize
@@ -159,14 +164,14 @@ Initialize(int argc, char **argv) {
   g_machine = new Machine(debugUserProg);
 
   // Create the device drivers
-  g_disk_driver = new DriverDisk((char *) "sem disk", (char *) "lock disk",
-                                 g_machine->disk);
+  g_volume_driver = new DriverVolume(g_cfg->NumDataDisks, g_machine->disks);
   if (g_cfg->ACIA)
     g_acia_driver = new DriverACIA();
   g_console_driver = new DriverConsole();
 
   // Create the different objects making the Nachos kernel
   g_scheduler = new Scheduler();   // Initialize the ready queue
+  g_work_queue = new WorkQueue();
   g_page_fault_manager = new PageFaultManager();
   g_swap_manager = new SwapManager();
   g_swap_disk_driver = g_swap_manager->GetSwapDisk();
@@ -210,6 +215,12 @@ Initialize(int argc, char **argv) {
   // Enable interrupts
   g_machine->interrupt->SetStatus(INTERRUPTS_ON);
 
+  // Start the time slices
+  if (g_cfg->TimeSharing)
+    g_timer = new Timer(TimerInterruptHandler, 0, false);
+  else
+    g_timer = NULL;
+
   // Init the Nachos file system
   // NB: uses the disk, so blocks the calling thread.
   // Thus; FileSystem initiaization has to be done after the first
@@ -237,8 +248,11 @@ Cleanup() {
   printf("\nCleaning up...\n");
   if (g_cfg->PrintStat) {
     g_stats->Print();
+    printf("\nConcerning disks : \n");
+    g_volume_driver->Print();
+    g_swap_disk_driver->Print();
   }
-  delete g_disk_driver;
+  delete g_volume_driver;
   delete g_console_driver;
   if (g_cfg->ACIA)
     delete g_acia_driver;
@@ -247,11 +261,15 @@ Cleanup() {
   delete g_open_file_table;
   delete g_swap_manager;
   delete g_scheduler;
+  delete g_work_queue;
   delete g_stats;
   delete g_physical_mem_manager;
   delete g_page_fault_manager;
-  delete g_cfg;
   delete g_alive;
   delete g_object_addrs;
+  if (g_timer != NULL)
+    delete g_timer;
   delete g_machine;
+  // Last, the devices may still need the configuration when deleted
+  delete g_cfg;
 }
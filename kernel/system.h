@@ -26,9 +26,6 @@
 #include <stdlib.h>
 using namespace std;
 
-#include "utility/list.h"
-#include "utility/objaddr.h"
-
 /*! Each syscall makes sure that the object that the user passes to it
  * are of the expected type, by checking the typeId field against
  * these identifiers
@@ -37,26 +34,34 @@ typedef enum {
   SEMAPHORE_TYPE = 0xdeefeaea,
   LOCK_TYPE = 0xdeefcccc,
   CONDITION_TYPE = 0xdeefcdcd,
+  BARRIER_TYPE = 0xdeefbaba,
   FILE_TYPE = 0xdeadbeef,
   THREAD_TYPE = 0xbadcafe,
   INVALID_TYPE = 0xf0f0f0f
 } ObjectType;
 
+// After ObjectType, used by ObjAddr
+#include "utility/list.h"
+#include "utility/objaddr.h"
+
 // Forward declarations (ie in other files)
 class Config;
 class Statistics;
 class SyscallError;
 class Thread;
 class Scheduler;
+class WorkQueue;
 class PageFaultManager;
 class PhysicalMemManager;
 class SwapManager;
 class FileSystem;
 class OpenFileTable;
 class DriverDisk;
+class DriverVolume;
 class DriverConsole;
 class DriverACIA;
 class Machine;
+class Timer;
 
 // Initialization and cleanup routines
 extern void Initialize(int argc,
@@ -70,15 +75,17 @@ extern void Cleanup();                 //!< Cleanup, called when
 
 // Hardware components
 extern Machine *g_machine;   //!< Machine (includes CPU and peripherals)
+extern Timer *g_timer;       //!< Time slice timer, NULL without time sharing
 
 // Thread management
 extern Thread *g_current_thread;           //!< The thread holding the CPU
 extern Thread *g_thread_to_be_destroyed;   //!< The thread that just finished
 extern Listint *g_alive;                   //!< List of existing threads
 extern Scheduler *g_scheduler;             //!< Thread scheduler
+extern WorkQueue *g_work_queue;   //!< Work deferred by interrupt handlers
 
 // Device drivers
-extern DriverDisk *g_disk_driver;         //!< Disk driver
+extern DriverVolume *g_volume_driver;     //!< Volume over the data disks
 extern DriverDisk *g_swap_disk_driver;    //!< Swap disk driver
 extern DriverConsole *g_console_driver;   //!< Console driver
 extern DriverACIA *g_acia_driver;         //!< Serial line driver
@@ -27,9 +27,12 @@
 */
 
 #include "kernel/thread.h"
+#include "drivers/drvConsole.h"
 #include "kernel/msgerror.h"
 #include "kernel/scheduler.h"
 #include "kernel/synch.h"
+#include "utility/profile.h"
+#include "vm/physMem.h"
 
 #define UNSIGNED_LONG_AT_ADDR(addr) (*((unsigned long int*)(addr)))
 
@@ -51,6 +54,12 @@ Thread::Thread(char* threadName) {
 
     // No process owner yet
     process = NULL;
+    vruntime = 0;
+    periodic = NULL;
+    stat = NULL;
+    error.code = NO_ERROR;
+    error.hasId = false;
+    error.about[0] = '\0';
 }
 
 //----------------------------------------------------------------------
@@ -125,6 +134,7 @@ int Thread::Start(Process* owner, int64_t func, int64_t arg) {
     DEBUG('t', (char*)"Allocating Stack of thread \"%s\"\n", name);
     this->process = owner;
     this->process->numThreads++;
+    this->stat = owner->stat->NewThreadStat(name);
     int64_t user_base_stack_addr = this->process->addrspace->StackAllocate();
     int8_t* simulator_base_stack_addr = AllocBoundedArray(SIMULATORSTACKSIZE);
     DEBUG('t', (char*)"Initializing context of thread \"%s\"\n", name);
@@ -179,6 +189,8 @@ void ThreadPrint(long arg) {
 }
 
 void StartThreadExecution(void) {
+    // The zones active belong to the thread we switched from
+    PROFILE_THREAD_START();
     printf("****  Starting thread\n");
     g_machine->interrupt->SetStatus(INTERRUPTS_ON);
     g_machine->Run();
@@ -232,6 +244,16 @@ void Thread::InitSimulatorContext(int8_t* base_stack_addr, unsigned long int sta
 */
 void Thread::Join(Thread* Idthread) {
     while (g_alive->Search(Idthread)) {
+        // With no other thread ready, Yield returns at once and only an
+        // interrupt can wake up Idthread: jump to the next one
+        if (g_cfg->SkipSpinLoops && g_scheduler->IsReadyListEmpty()) {
+            Time now = g_stats->getTotalTicks();
+            Time when = g_machine->interrupt->NextDue();
+            if (when > now) {
+                g_stats->incrSpinSkips(when - now);
+                g_machine->interrupt->OneTick(when - now);
+            }
+        }
         Yield();
     }
 }
@@ -290,10 +312,17 @@ void Thread::Finish() {
 
     //removing the thread from data structure
     g_alive->RemoveItem(g_current_thread);
-    
+
+    // Nobody is left to read the console input
+    if (g_alive->IsEmpty())
+        g_console_driver->StopInput();
 
     DEBUG('t', (char*)"Finishing thread \"%s\"\n", GetName());
 
+    // Give back the CPU share reserved by a periodic thread
+    if (periodic != NULL)
+        g_scheduler->SetPeriodic(0, 0, 0);
+
     g_thread_to_be_destroyed = g_current_thread; // Le reste est dans SwitchTo()
     
     // Go to sleep
@@ -327,7 +356,7 @@ void Thread::Yield() {
 
     DEBUG('t', (char*)"Yielding thread \"%s\"\n", GetName());
 
-    nextThread = g_scheduler->FindNextToRun();
+    nextThread = g_scheduler->FindNextToRun(true);
     if (nextThread != NULL) {
         g_scheduler->ReadyToRun(this);
         g_scheduler->SwitchTo(nextThread);
@@ -372,6 +401,8 @@ void Thread::Sleep() {
     // would need to be fixed
     while ((nextThread = g_scheduler->FindNextToRun()) == NULL) {
         DEBUG('t', (char*)"Nobody to run => idle\n");
+        // Use the idle time to zero free pages ahead of time
+        g_physical_mem_manager->RefillZeroPool();
         g_machine->interrupt->Idle(); // no one to run, wait for an interrupt
     }
 
@@ -379,6 +410,22 @@ void Thread::Sleep() {
     g_scheduler->SwitchTo(nextThread);
 }
 
+//----------------------------------------------------------------------
+// Thread::Block
+/*! 	Sleep on a synchronization object, and charge the time until the
+//	thread runs again to the kind of object in its statistics.
+//	Interrupts must be disabled, as for Sleep.
+//
+//	\param reason the kind of object the thread waits for
+*/
+//----------------------------------------------------------------------
+void Thread::Block(BlockReason reason) {
+    Time start = g_stats->getTotalTicks();
+
+    Sleep();
+    stat->incrBlockedTicks(reason, g_stats->getTotalTicks() - start);
+}
+
 //----------------------------------------------------------------------
 // Thread::SaveProcessorState
 /*!	Save the CPU state of a user program on a context switch
@@ -401,13 +448,14 @@ void Thread::SaveProcessorState() {
     }
     this->thread_context.pc = g_machine->pc;
 
-    this->process->addrspace->translationTable = g_machine->mmu->translationTable;
     g_machine->interrupt->SetStatus(oldLevel);
 }
 #endif
 //----------------------------------------------------------------------
 // Thread::RestoreProcessorState
 /*!	Restore the CPU state of a user program on a context switch.
+//	The translation table is loaded by Scheduler::SwitchTo, only when
+//	the address space changes.
  */
 //----------------------------------------------------------------------
 
@@ -428,7 +476,6 @@ void Thread::RestoreProcessorState() {
     }
     g_machine->pc = this->thread_context.pc;
 
-    g_machine->mmu->translationTable = this->process->addrspace->translationTable;
     g_machine->interrupt->SetStatus(oldLevel);
 }
 #endif
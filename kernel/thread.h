@@ -32,6 +32,7 @@ class Thread;
 #define THREAD_H
 
 #include "kernel/copyright.h"
+#include "kernel/msgerror.h"
 #include "kernel/process.h"
 #include "kernel/system.h"
 //#include "kernel/addrspace.h"
@@ -48,6 +49,7 @@ extern void ThreadPrint(long arg);
 
 class Semaphore;
 class Process;
+class PeriodicTask;
 
 /*! \brief Defines the context of the Nachos simulator
  */
@@ -94,6 +96,9 @@ public:
   //! Put the thread to sleep and relinquish the processor
   void Sleep();
 
+  //! Sleep on a synchronization object, counting the time blocked
+  void Block(BlockReason reason);
+
   //! Finish the execution of the thread, and prepare its deallocation
   void Finish();
 
@@ -142,6 +147,19 @@ public:
   ObjectType type;
 
   int stackPointer;
+
+  //! Virtual runtime: CPU time used, scaled by the share of the thread
+  //  (fair-share scheduling)
+  Time vruntime;
+
+  //! Real-time parameters, NULL unless the thread is periodic
+  PeriodicTask *periodic;
+
+  //! Statistics of the thread, rolled up into those of its process
+  ThreadStat *stat;
+
+  //! Error of its last system call, printed by PError
+  ThreadError error;
 };
 
 #endif   // THREAD_H
@@ -0,0 +1,96 @@
+/*! \file workqueue.cc
+//  \brief Routines to run the work deferred by interrupt handlers.
+//
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#include "kernel/workqueue.h"
+#include "kernel/system.h"
+#include "machine/machine.h"
+#include "utility/stats.h"
+
+//----------------------------------------------------------------------
+// WorkQueue::WorkQueue
+//!     Constructor. The queue is initially empty.
+//----------------------------------------------------------------------
+WorkQueue::WorkQueue() {
+  first = 0;
+  count = 0;
+  depth = 0;
+}
+
+//----------------------------------------------------------------------
+// WorkQueue::~WorkQueue
+//!     Destructor. Nothing is allocated by the queue.
+//----------------------------------------------------------------------
+WorkQueue::~WorkQueue() {}
+
+//----------------------------------------------------------------------
+// WorkQueue::Defer
+/*!     Queue a work item. Called by the interrupt handlers, with
+//      interrupts disabled.
+//
+//      \param func the function to call
+//      \param arg the argument to pass to the function
+*/
+//----------------------------------------------------------------------
+void
+WorkQueue::Defer(VoidFunctionPtr func, int64_t arg) {
+  ASSERT(g_machine->interrupt->GetStatus() == INTERRUPTS_OFF);
+
+  if (count == WORK_QUEUE_SIZE) {
+    // No room left, the handler does the work itself
+    DEBUG('i', (char *) "Work queue full, running the work at once\n");
+    (*func)(arg);
+    return;
+  }
+  items[(first + count) % WORK_QUEUE_SIZE].func = func;
+  items[(first + count) % WORK_QUEUE_SIZE].arg = arg;
+  count++;
+}
+
+//----------------------------------------------------------------------
+// WorkQueue::Run
+/*!     Run the waiting work items, with the interrupt level of the
+//      caller. Each item is removed from the queue before being run:
+//      when an item enables interrupts again, the handlers of the
+//      interrupts now due run, and the items they queue are run by a
+//      nested call, or by another thread if the current one is
+//      switched out meanwhile.
+*/
+//----------------------------------------------------------------------
+void
+WorkQueue::Run() {
+  uint64_t start = 0;
+  uint64_t numRun = 0;
+
+  if (count == 0)
+    return;
+  if (depth++ == 0)
+    start = HostNanos();
+  while (count > 0) {
+    WorkItem item = items[first];
+    first = (first + 1) % WORK_QUEUE_SIZE;
+    count--;
+    (*item.func)(item.arg);
+    numRun++;
+  }
+  // The host time of nested calls is counted by the outermost one
+  if (--depth == 0)
+    g_stats->incrDeferred(numRun, HostNanos() - start);
+  else
+    g_stats->incrDeferred(numRun, 0);
+}
@@ -0,0 +1,77 @@
+/*! \file workqueue.h
+    \brief Data structures for the work deferred by interrupt handlers.
+
+        Interrupt handlers run with interrupts disabled, so any work
+        they do delays the other pending interrupts. A handler only
+        does what the device needs at once (acknowledging it, starting
+        the next request), and defers the rest to the work queue.
+
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#ifndef WORKQUEUE_H
+#define WORKQUEUE_H
+
+#include "kernel/copyright.h"
+#include "utility/utility.h"
+
+//! Maximum number of work items waiting to be run
+#define WORK_QUEUE_SIZE 64
+
+/*! \brief Defines the queue of the work deferred by interrupt handlers
+//
+// A work item is a function and its argument. The queue is drained
+// when the interrupt handlers return: with interrupts enabled after
+// a tick of the simulated time (see Interrupt::OneTick), or when the
+// machine idles, before the scheduler looks for a thread to run (see
+// Interrupt::Idle). The latter drain runs with interrupts disabled,
+// as Thread::Sleep requires. A work item must not wait (no P(), no
+// Acquire()), nor count on interrupts being enabled.
+//
+// Only the disk defers its work (the completion of a request). The
+// console and ACIA handlers take a character from the device and do
+// a V(), in constant time: they keep doing it in the handler.
+//
+// The items are kept in a ring, so that deferring work does not
+// allocate memory. When the ring is full, the item is run at once.
+*/
+class WorkQueue {
+public:
+  WorkQueue();    //!< Create an empty work queue
+  ~WorkQueue();   //!< Delete the work queue, the waiting items are lost
+
+  void Defer(VoidFunctionPtr func, int64_t arg);
+  //!< Queue the call of func(arg), to be
+  //!< called by an interrupt handler
+
+  void Run();   //!< Run the waiting items, in the order
+                //!< they were queued
+
+  bool IsEmpty() { return count == 0; }   //!< Is there work waiting?
+
+private:
+  struct WorkItem {
+    VoidFunctionPtr func;   //!< Function to call
+    int64_t arg;            //!< Its argument
+  };
+
+  WorkItem items[WORK_QUEUE_SIZE];   //!< Ring of the waiting items
+  int first;                         //!< First waiting item in the ring
+  int count;                         //!< Number of waiting items
+  int depth;                         //!< Number of nested calls to Run
+};
+
+#endif   // WORKQUEUE_H
@@ -0,0 +1,244 @@
+/*! \file blockdev.cc
+//  \brief Routines common to the emulated block devices.
+//
+//      Reading and writing
+//	to a block device is simulated as reading and writing to a UNIX
+//	file. The simulated time of the requests is computed by each
+//	kind of device (see disk.cc and flashdisk.cc).
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+//  DO NOT CHANGE -- part of the machine emulation
+
+#include "machine/blockdev.h"
+#include "kernel/system.h"
+#include "kernel/thread.h"
+#include "machine/disk.h"
+#include "utility/config.h"
+#include "utility/stats.h"
+
+//----------------------------------------------------------------------
+// BlockDevice::BlockDevice()
+/*! 	Constructor. Open the UNIX file (creating it
+//	if it doesn't exist), and check the magic number to make sure it's
+// 	OK to treat it as Nachos disk storage. With a discarded overlay,
+//	the file is only opened for reading, and must exist.
+//
+//	\param name text name of the file simulating the device
+//	\param sectors number of sectors of the device
+//	\param callWhenDone interrupt handler to be called when a read/write
+//	   request completes
+//	\param callArg argument to pass the interrupt handler
+*/
+//----------------------------------------------------------------------
+
+BlockDevice::BlockDevice(char *name, int sectors, VoidFunctionPtr callWhenDone,
+                         int64_t callArg) {
+  uint32_t magicNum;
+  int tmp = 0;
+
+  DEBUG('h', (char *) "Initializing the device, 0x%x\n", callWhenDone);
+  numSectors = sectors;
+  handler = callWhenDone;
+  handlerArg = callArg;
+  completedTag = -1;
+  overlayFileno = -1;
+  overlaySlot = NULL;
+  overlayUsed = 0;
+
+  // Open the UNIX file used to simulate the device. It is only read,
+  // unless the overlay is committed at exit
+  if (g_cfg->DiskOverlay == OVERLAY_DISCARD) {
+    fileno = OpenForRead(name, false);
+    if (fileno < 0) {
+      printf("Disk image %s not found, DiskOverlay = Discard needs one, "
+             "exiting\n",
+             name);
+      exit(ERROR);
+    }
+  } else
+    fileno = OpenForReadWrite(name, false);
+  if (fileno >= 0) {   // file exists, check magic number
+    Read(fileno, (char *) &magicNum, g_cfg->MagicSize);
+    ASSERT(magicNum == g_cfg->MagicNumber);
+  } else {   // file doesn't exist, create it
+    fileno = OpenForWrite(name);
+    magicNum = g_cfg->MagicNumber;
+    WriteFile(fileno, (char *) &magicNum,
+              g_cfg->MagicSize);   // write magic number
+
+    // need to write at end of file, so that reads will not return EOF
+    Lseek(fileno,
+          g_cfg->MagicSize + numSectors * g_cfg->SectorSize - sizeof(int), 0);
+    WriteFile(fileno, (char *) &tmp, sizeof(int));
+  }
+
+  if (g_cfg->DiskOverlay != OVERLAY_NONE) {
+    // The overlay file is private to this run: it is unlinked at once
+    // so that nothing is left behind, even after a crash.
+    char overlayName[strlen(name) + 16];
+    sprintf(overlayName, "%s.overlayXXXXXX", name);
+    overlayFileno = OpenTemporary(overlayName);
+    Unlink(overlayName);
+
+    overlaySlot = new int[numSectors];
+    for (int i = 0; i < numSectors; i++)
+      overlaySlot[i] = -1;
+    DEBUG('h', (char *) "Copy-on-write overlay %s for disk %s\n", overlayName,
+          name);
+  }
+}
+
+//----------------------------------------------------------------------
+// BlockDevice::~BlockDevice()
+/*! 	Destructor. Close the UNIX file representing the device. With a
+//      copy-on-write overlay, the written sectors are first committed
+//      to the UNIX file if requested.
+*/
+//----------------------------------------------------------------------
+
+BlockDevice::~BlockDevice() {
+  if (overlayFileno >= 0) {
+    if (g_cfg->DiskOverlay == OVERLAY_COMMIT)
+      OverlayCommit();
+    DEBUG('h', (char *) "Overlay of %d sectors %s\n", overlayUsed,
+          (g_cfg->DiskOverlay == OVERLAY_COMMIT) ? "committed" : "discarded");
+    Close(overlayFileno);
+    delete[] overlaySlot;
+  }
+  Close(fileno);
+}
+
+//----------------------------------------------------------------------
+// BlockDevice::OverlayCommit()
+/*! 	Copy every sector of the copy-on-write overlay to its place in the
+//      UNIX file representing the device.
+*/
+//----------------------------------------------------------------------
+
+void
+BlockDevice::OverlayCommit() {
+  char buffer[g_cfg->SectorSize];
+
+  for (int sector = 0; sector < numSectors; sector++) {
+    if (overlaySlot[sector] < 0)
+      continue;
+    Lseek(overlayFileno, g_cfg->SectorSize * overlaySlot[sector], 0);
+    Read(overlayFileno, buffer, g_cfg->SectorSize);
+    Lseek(fileno, g_cfg->SectorSize * sector + g_cfg->MagicSize, 0);
+    WriteFile(fileno, buffer, g_cfg->SectorSize);
+  }
+}
+
+//----------------------------------------------------------------------
+// PrintSector()
+//! 	Dump the data in a disk read/write request, for debugging only.
+//   \param writing indicate if it is a write request
+//   \param sector sector number
+//   \param sector contents
+//----------------------------------------------------------------------
+
+static void
+PrintSector(bool writing, int sector, char *data) {
+  int *p = (int *) data;
+
+  if (writing)
+    printf("Writing sector: %" PRIu32 "\n", sector);
+  else
+    printf("Reading sector: %" PRIu32 "\n", sector);
+  for (unsigned int i = 0; i < (g_cfg->SectorSize / sizeof(int)); i++)
+    printf("%x ", p[i]);
+  printf("\n");
+}
+
+//----------------------------------------------------------------------
+// BlockDevice::ReadImage
+/*!	Read a sector in the UNIX file, or in the overlay if the sector
+//	was written, and update the statistics.
+//
+//	\param sectorNumber the sector to read
+//	\param data the buffer to hold the incoming bytes
+*/
+//----------------------------------------------------------------------
+
+void
+BlockDevice::ReadImage(int sectorNumber, char *data) {
+  // Sanity check of the sector number
+  ASSERT((sectorNumber >= 0) && (sectorNumber < numSectors));
+
+  DEBUG('h', (char *) "Reading from sector %d\n", sectorNumber);
+
+  if ((overlayFileno >= 0) && (overlaySlot[sectorNumber] >= 0)) {
+    Lseek(overlayFileno, g_cfg->SectorSize * overlaySlot[sectorNumber], 0);
+    Read(overlayFileno, data, g_cfg->SectorSize);
+  } else {
+    Lseek(fileno, g_cfg->SectorSize * sectorNumber + g_cfg->MagicSize, 0);
+    Read(fileno, data, g_cfg->SectorSize);
+  }
+  if (DebugIsEnabled('h'))
+    PrintSector(false, sectorNumber, data);
+
+  // Update the statistics
+  g_current_thread->stat->incrNumDiskReads();
+}
+
+//----------------------------------------------------------------------
+// BlockDevice::WriteImage
+/*!	Write a sector in the UNIX file, or in the overlay where the
+//	sector gets a slot the first time it is written, and update the
+//	statistics.
+//
+//	\param sectorNumber the sector to write
+//	\param data the bytes to be written
+*/
+//----------------------------------------------------------------------
+
+void
+BlockDevice::WriteImage(int sectorNumber, char *data) {
+  // Sanity check of the sector number
+  ASSERT((sectorNumber >= 0) && (sectorNumber < numSectors));
+
+  DEBUG('h', (char *) "Writing to sector %d\n", sectorNumber);
+
+  if (overlayFileno >= 0) {
+    if (overlaySlot[sectorNumber] < 0)
+      overlaySlot[sectorNumber] = overlayUsed++;
+    Lseek(overlayFileno, g_cfg->SectorSize * overlaySlot[sectorNumber], 0);
+    WriteFile(overlayFileno, data, g_cfg->SectorSize);
+  } else {
+    Lseek(fileno, g_cfg->SectorSize * sectorNumber + g_cfg->MagicSize, 0);
+    WriteFile(fileno, data, g_cfg->SectorSize);
+  }
+  if (DebugIsEnabled('h'))
+    PrintSector(true, sectorNumber, data);
+
+  // Update statistics
+  g_current_thread->stat->incrNumDiskWrites();
+}
+
+//----------------------------------------------------------------------
+// BlockDevice::Complete
+/*! 	Called by the device when a request completes, to invoke the
+//	interrupt handler of the device.
+//
+//	\param tag the tag of the completed request
+*/
+//----------------------------------------------------------------------
+
+void
+BlockDevice::Complete(int tag) {
+  completedTag = tag;
+  (*handler)(handlerArg);
+}
@@ -0,0 +1,109 @@
+/*! \file blockdev.h
+    \brief Data structures common to the emulated block devices.
+
+        A block device stores a given number of sectors (NUM_SECTORS
+        for a single disk) of g_cfg->SectorSize bytes. It accepts
+        requests to read/write a sector, and signals their completion
+        with an interrupt. Depending on the device, one or several
+        requests may be outstanding at the same time.
+
+    DO NOT CHANGE -- part of the machine emulation
+
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#ifndef BLOCKDEV_H
+#define BLOCKDEV_H
+
+#include "kernel/copyright.h"
+#include "utility/utility.h"
+
+/*! \brief Defines the interface of a block I/O device (rotating disk or
+//  flash disk).
+//
+// The contents of every block device are kept in a UNIX file, with
+// the same layout whatever the kind of the device, so that a disk image
+// can be used by any of them. Only the simulated time of the requests
+// differs from one device to the other.
+//
+// Every request is given a tag by the caller, between 0 and
+// GetQueueDepth() - 1, which must not be used by another outstanding
+// request. When a request completes, the interrupt handler is called
+// and GetCompletedTag() returns the tag of this request. Requests do
+// not necessarily complete in the order they were sent.
+//
+// When the DiskOverlay configuration option is set, the UNIX file is
+// only read. The sectors written during the run are kept in a private
+// copy-on-write overlay file, which is discarded or committed to the
+// UNIX file when the device is deleted.
+*/
+class BlockDevice {
+public:
+  BlockDevice(char *name, int sectors, VoidFunctionPtr callWhenDone,
+              int64_t callArg);
+  /*!< Open the UNIX file of a device of
+       "sectors" sectors.
+       Invoke (*callWhenDone)(callArg)
+       every time a request completes. */
+  virtual ~BlockDevice();   //!< Close the UNIX file
+
+  virtual void ReadRequest(int sectorNumber, char *data, int tag) = 0;
+  /*!< Read/write a single sector.
+       These routines send a request to
+       the device and return immediately. */
+  virtual void WriteRequest(int sectorNumber, char *data, int tag) = 0;
+
+  virtual int GetQueueDepth() { return 1; }
+  /*!< Number of requests the device
+       accepts at the same time */
+
+  int GetNumSectors() { return numSectors; }
+  //!< Number of sectors of the device
+
+  int GetCompletedTag() { return completedTag; }
+  /*!< Tag of the request which has just
+       completed, to be called by the
+       interrupt handler */
+
+  virtual void Print() {}   //!< Print the statistics of the device
+
+protected:
+  int numSectors;   //!< Number of sectors of the device
+
+  void ReadImage(int sectorNumber, char *data);
+  // Read the sector in the UNIX file
+  void WriteImage(int sectorNumber, char *data);
+  // Write the sector in the UNIX file
+  void Complete(int tag);
+  // Signal the completion of a request
+
+private:
+  int fileno;                   //!< UNIX file number for simulated device
+  VoidFunctionPtr handler;      /*!< Interrupt handler, to be invoked
+                                  when any request finishes
+                                */
+  int64_t handlerArg;           //!< Argument of the interrupt handler
+  int completedTag;             //!< Tag of the last completed request
+
+  int overlayFileno;   //!< UNIX file number of the overlay, -1 if none
+  int *overlaySlot;    /*!< For each sector, its slot in the overlay
+                          file, or -1 when it was never written */
+  int overlayUsed;     //!< Number of slots used in the overlay file
+
+  void OverlayCommit();   // write back the overlay in the UNIX file
+};
+
+#endif   // BLOCKDEV_H
@@ -72,6 +72,8 @@ Console::Console(char *readFile, char *writeFile,
   incoming = EOF;
 
   intState = false;
+  pollPending = false;
+  inputClosed = false;
 }
 
 //----------------------------------------------------------------------
@@ -101,18 +103,26 @@ Console::CheckCharAvail() {
   char c;
 
   // schedule the next time to poll for a packet
-  if (intState)
+  pollPending = false;
+  if (intState && !inputClosed) {
     g_machine->interrupt->Schedule(
         ConsoleReadPoll, (int64_t) this,
         nano_to_cycles(CONSOLE_TIME, g_cfg->ProcessorFrequency),
         CONSOLE_READ_INT);
+    pollPending = true;
+  }
 
   // do nothing if character is already buffered, or none to be read
   if ((incoming != EOF) || !PollFile(readFileNo))
     return;
 
-  // otherwise, read character and tell user about it
-  Read(readFileNo, &c, sizeof(char));
+  // otherwise, read character and tell user about it (or tell the
+  // end of the input is reached: the console then stops polling)
+  if (ReadPartial(readFileNo, &c, sizeof(char)) != sizeof(char)) {
+    inputClosed = true;
+    (*readHandler)();
+    return;
+  }
   incoming = c;
   (*readHandler)();
 }
@@ -169,10 +179,15 @@ Console::PutChar(char ch) {
 void
 Console::EnableInterrupt() {
   intState = true;
+  // A check may still be pending from the last time the interrupt
+  // was enabled, no need to schedule another one
+  if (pollPending || inputClosed)
+    return;
   g_machine->interrupt->Schedule(
       ConsoleReadPoll, (int64_t) this,
       nano_to_cycles(CONSOLE_TIME, g_cfg->ProcessorFrequency),
       CONSOLE_READ_INT);
+  pollPending = true;
 }
 
 //----------------------------------------------------------------------
@@ -84,6 +84,11 @@ public:
   */
   char GetChar();
 
+  /*! true once the end of the input has been reached, no character
+  // will arrive any more
+  */
+  bool InputClosed() { return inputClosed; }
+
   /*! Enable the console interrupt
    */
   void EnableInterrupt();
@@ -112,7 +117,9 @@ public:
   void CheckCharAvail();
 
 private:
-  bool intState;   //!< Interrupt status
+  bool intState;      //!< Interrupt status
+  bool pollPending;   //!< Is a check for input already scheduled?
+  bool inputClosed;   //!< Has the end of the input file been reached?
 
   int readFileNo;                    //!< UNIX file emulating the keyboard
   int writeFileNo;                   //!< UNIX file emulating the display
@@ -31,6 +31,7 @@
 #include "machine/interrupt.h"
 #include "machine/machine.h"
 #include "utility/config.h"
+#include "utility/profile.h"
 #include "utility/stats.h"
 
 //! dummy procedure because we can't take a pointer of a member function
@@ -42,74 +43,32 @@ DiskDone(int64_t arg) {
 //----------------------------------------------------------------------
 // Disk::Disk()
 /*! 	Constructor. Initialize a simulated disk.
-//      Open the UNIX file (creating it
-//	if it doesn't exist), and check the magic number to make sure it's
-// 	OK to treat it as Nachos disk storage.
+//      The UNIX file is opened by BlockDevice.
 //
 //	\param name text name of the file simulating the Nachos disk
+//	\param sectors number of sectors of the disk
 //	\param callWhenDone interrupt handler to be called when disk read/write
 //	   request completes
 //	\param callArg argument to pass the interrupt handler
 */
 //----------------------------------------------------------------------
 
-Disk::Disk(char *name, VoidNoArgFunctionPtr callWhenDone) {
-  uint32_t magicNum;
-  int tmp = 0;
-
-  DEBUG('h', (char *) "Initializing the disk, 0x%x\n", callWhenDone);
-  handler = callWhenDone;
+Disk::Disk(char *name, int sectors, VoidFunctionPtr callWhenDone,
+           int64_t callArg)
+    : BlockDevice(name, sectors, callWhenDone, callArg) {
   lastSector = 0;
   bufferInit = 0;
-
-  // Open the UNIX file used to simulate the disk
-  fileno = OpenForReadWrite(name, false);
-  if (fileno >= 0) {   // file exists, check magic number
-    Read(fileno, (char *) &magicNum, g_cfg->MagicSize);
-    ASSERT(magicNum == g_cfg->MagicNumber);
-  } else {   // file doesn't exist, create it
-    fileno = OpenForWrite(name);
-    magicNum = g_cfg->MagicNumber;
-    WriteFile(fileno, (char *) &magicNum,
-              g_cfg->MagicSize);   // write magic number
-
-    // need to write at end of file, so that reads will not return EOF
-    Lseek(fileno, g_cfg->DiskSize - sizeof(int), 0);
-    WriteFile(fileno, (char *) &tmp, sizeof(int));
-  }
+  activeTag = -1;
   DEBUG('h', (char *) "[ctor] Clear active\n");
   active = false;
 }
 
 //----------------------------------------------------------------------
 // Disk::~Disk()
-/*! 	Destructor. Clean up disk simulation, by closing the UNIX file
-//      representing the disk.
-*/
-//----------------------------------------------------------------------
-
-Disk::~Disk() { Close(fileno); }
-
-//----------------------------------------------------------------------
-// Disk::PrintSector()
-//! 	Dump the data in a disk read/write request, for debugging only.
-//   \param writing indicate if it is a write request
-//   \param sector sector number
-//   \param sector contents
+//! 	Destructor. The UNIX file is closed by BlockDevice.
 //----------------------------------------------------------------------
 
-static void
-PrintSector(bool writing, int sector, char *data) {
-  int *p = (int *) data;
-
-  if (writing)
-    printf("Writing sector: %" PRIu32 "\n", sector);
-  else
-    printf("Reading sector: %" PRIu32 "\n", sector);
-  for (unsigned int i = 0; i < (g_cfg->SectorSize / sizeof(int)); i++)
-    printf("%x ", p[i]);
-  printf("\n");
-}
+Disk::~Disk() {}
 
 //----------------------------------------------------------------------
 // Disk::ReadRequest
@@ -124,33 +83,24 @@ PrintSector(bool writing, int sector, char *data) {
 //
 //	\param sectorNumber the disk sector to read
 //	\param data the buffer to hold the incoming bytes
+//	\param tag the tag of the request
 */
 //----------------------------------------------------------------------
 void
-Disk::ReadRequest(int sectorNumber, char *data) {
+Disk::ReadRequest(int sectorNumber, char *data, int tag) {
+  PROFILE_ZONE(PROFILE_DISK);
   int ticks = ComputeLatency(sectorNumber, false);
 
   // Only one request at a time
   ASSERT(!active);
 
-  // Sanity check of the sector number
-  ASSERT((sectorNumber >= 0) && (sectorNumber < NUM_SECTORS))
-
-  DEBUG('h', (char *) "Reading from sector %d\n", sectorNumber);
-
-  // Read in the UNIX file
-  Lseek(fileno, g_cfg->SectorSize * sectorNumber + g_cfg->MagicSize, 0);
-  Read(fileno, data, g_cfg->SectorSize);
-  if (DebugIsEnabled('h'))
-    PrintSector(false, sectorNumber, data);
+  ReadImage(sectorNumber, data);
 
   DEBUG('h', (char *) "[rdrq] Set active\n");
   active = true;
+  activeTag = tag;
   UpdateLast(sectorNumber);
 
-  // Update the statistics
-  g_current_thread->GetProcessOwner()->stat->incrNumDiskReads();
-
   // Schedule the end of IO interrupt
   g_machine->interrupt->Schedule(DiskDone, (int64_t) this, ticks, DISK_INT);
 }
@@ -168,34 +118,24 @@ Disk::ReadRequest(int sectorNumber, char *data) {
 //
 //	\param sectorNumber the disk sector to write
 //	\param data the bytes to be written
+//	\param tag the tag of the request
 */
 //----------------------------------------------------------------------
 
 void
-Disk::WriteRequest(int sectorNumber, char *data) {
+Disk::WriteRequest(int sectorNumber, char *data, int tag) {
   int ticks = ComputeLatency(sectorNumber, true);
 
   // Only one request at a time
   ASSERT(!active);
 
-  // Sanity check of the sector number
-  ASSERT((sectorNumber >= 0) && (sectorNumber < NUM_SECTORS));
-
-  DEBUG('h', (char *) "Writing to sector %d\n", sectorNumber);
-
-  // Write in the UNIX file
-  Lseek(fileno, g_cfg->SectorSize * sectorNumber + g_cfg->MagicSize, 0);
-  WriteFile(fileno, data, g_cfg->SectorSize);
-  if (DebugIsEnabled('h'))
-    PrintSector(true, sectorNumber, data);
+  WriteImage(sectorNumber, data);
 
   DEBUG('h', (char *) "[wrrq] Set active\n");
   active = true;
+  activeTag = tag;
   UpdateLast(sectorNumber);
 
-  // Update statistics
-  g_current_thread->GetProcessOwner()->stat->incrNumDiskWrites();
-
   // Schedule the end of IO interrupt
   g_machine->interrupt->Schedule(DiskDone, (int64_t) this, ticks, DISK_INT);
 }
@@ -213,7 +153,7 @@ Disk::HandleInterrupt() {
   active = false;
 
   // Call the disk interrupt handler
-  (*handler)();
+  Complete(activeTag);
 }
 
 //----------------------------------------------------------------------
@@ -310,7 +250,7 @@ Disk::ComputeLatency(int newSector, bool writing) {
 //----------------------------------------------------------------------
 // Disk::UpdateLast
 /*!   	Keep track of the most recently requested sector.  So we can know
-//	what is in the track buffer.
+//	what is in the track buffer, and count the move of the head.
 // \param newSector accessed sector
 */
 //----------------------------------------------------------------------
@@ -318,8 +258,12 @@ void
 Disk::UpdateLast(int newSector) {
   int rotate;
   int seek = TimeToSeek(newSector, &rotate);
+  int tracks =
+      abs(newSector / SECTORS_PER_TRACK - lastSector / SECTORS_PER_TRACK);
 
   if (seek != 0)
     bufferInit = g_stats->getTotalTicks() + seek + rotate;
+  if (tracks != 0)
+    g_stats->incrSeeks(tracks);
   lastSector = newSector;
 }
@@ -32,6 +32,7 @@
 #define DISK_H
 
 #include "kernel/copyright.h"
+#include "machine/blockdev.h"
 #include "utility/utility.h"
 
 #define SECTORS_PER_TRACK 32   //!< number of sectors per disk track
@@ -66,20 +67,21 @@
 //
 // The track buffer simulation can be disabled by compiling with -DNOTRACKBUF
 */
-class Disk {
+class Disk : public BlockDevice {
 public:
-  Disk(char *name, VoidNoArgFunctionPtr callWhenDone);
+  Disk(char *name, int sectors, VoidFunctionPtr callWhenDone,
+       int64_t callArg);
   /*!< Create a simulated disk.
-       Invoke (*callWhenDone)
+       Invoke (*callWhenDone)(callArg)
        every time a request completes. */
   ~Disk(); /*!< Deallocate the disk. */
 
-  void ReadRequest(int sectorNumber, char *data);
+  void ReadRequest(int sectorNumber, char *data, int tag);
   /*!< Read/write an single disk sector.
        These routines send a request to
        the disk and return immediately.
        Only one request allowed at a time! */
-  void WriteRequest(int sectorNumber, char *data);
+  void WriteRequest(int sectorNumber, char *data, int tag);
 
   void HandleInterrupt(); /*!< Interrupt handler, invoked when
                                disk request finishes. */
@@ -90,11 +92,8 @@ public:
   (seek + rotational delay + transfer) */
 
 private:
-  int fileno;                   //!< UNIX file number for simulated disk
-  VoidNoArgFunctionPtr handler; /*!< Interrupt handler, to be invoked
-                                  when any disk request finishes
-                                */
   bool active;                  //!< Is a disk operation in progress?
+  int activeTag;                //!< Tag of the operation in progress
   int lastSector;               //!< The previous disk request
   Time bufferInit;              //!< When the track buffer started
                                 //!< being loaded
@@ -0,0 +1,480 @@
+/*! \file flashdisk.cc
+//  \brief Routines to simulate a flash disk device (SSD);
+//
+//      Reading and writing
+//	to the flash disk is simulated as reading and writing to a UNIX
+//	file, with the same layout as for a rotating disk. See flashdisk.h
+//	for details about the behavior of the flash disk (and therefore
+//	about the behavior of this simulation).
+//
+//	Flash disk operations are asynchronous, so we have to invoke an
+//	interrupt handler when a simulated operation completes.
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+//  DO NOT CHANGE -- part of the machine emulation
+
+#include "machine/flashdisk.h"
+#include "kernel/system.h"
+#include "machine/disk.h"
+#include "machine/interrupt.h"
+#include "machine/machine.h"
+#include "utility/config.h"
+#include "utility/profile.h"
+#include "utility/stats.h"
+
+//! dummy procedure because we can't take a pointer of a member function
+static void
+FlashDone(int64_t arg) {
+  ((FlashDisk *) arg)->HandleInterrupt();
+}
+
+//----------------------------------------------------------------------
+// FlashDisk::FlashDisk()
+/*! 	Constructor. Initialize a simulated flash disk: compute the
+//      geometry of the flash from the configuration, and map every
+//      sector, striped over the dies.
+//      The UNIX file is opened by BlockDevice.
+//
+//	\param name text name of the file simulating the flash disk
+//	\param sectors number of sectors of the disk
+//	\param callWhenDone interrupt handler to be called when a read/write
+//	   request completes
+//	\param callArg argument to pass the interrupt handler
+*/
+//----------------------------------------------------------------------
+
+FlashDisk::FlashDisk(char *name, int sectors, VoidFunctionPtr callWhenDone,
+                     int64_t callArg)
+    : BlockDevice(name, sectors, callWhenDone, callArg) {
+  numChannels = g_cfg->FlashChannels;
+  numDies = g_cfg->FlashChannels * g_cfg->FlashDiesPerChannel;
+  pagesPerBlock = g_cfg->FlashPagesPerBlock;
+  queueDepth = g_cfg->FlashQueueDepth;
+
+  // Blocks needed for the sectors and the over-provisioning, plus one
+  // block per die which is always kept erased for the garbage
+  // collector and one being filled.
+  int dataBlocks =
+      divRoundUp(numSectors * (100 + g_cfg->FlashOverProvision) / 100,
+                 pagesPerBlock);
+  blocksPerDie = divRoundUp(dataBlocks, numDies) + 2;
+
+  int numBlocks = numDies * blocksPerDie;
+  int numPages = numBlocks * pagesPerBlock;
+
+  mapping = new int[numSectors];
+  pageOwner = new int[numPages];
+  validPages = new int[numBlocks];
+  writePointer = new int[numBlocks];
+  eraseCount = new int[numBlocks];
+  openBlock = new int[numDies];
+  freeBlocks = new int[numDies];
+  dieFreeAt = new Time[numDies];
+  channelFreeAt = new Time[numChannels];
+  tagDone = new Time[queueDepth];
+  tagSeq = new uint64_t[queueDepth];
+  tagActive = new bool[queueDepth];
+
+  for (int p = 0; p < numPages; p++)
+    pageOwner[p] = -1;
+  for (int b = 0; b < numBlocks; b++) {
+    validPages[b] = 0;
+    writePointer[b] = 0;
+    eraseCount[b] = 0;
+  }
+  for (int c = 0; c < numChannels; c++)
+    channelFreeAt[c] = 0;
+  for (int t = 0; t < queueDepth; t++)
+    tagActive[t] = false;
+
+  // Sector s is the (s / numDies)-th page written on die s % numDies
+  for (int s = 0; s < numSectors; s++) {
+    int die = s % numDies;
+    int block = die * blocksPerDie + (s / numDies) / pagesPerBlock;
+    mapping[s] = -1;
+    MapPage(s, block * pagesPerBlock + writePointer[block]++);
+  }
+
+  // The first block not full is being filled, the following ones
+  // are erased
+  for (int d = 0; d < numDies; d++) {
+    int b = d * blocksPerDie;
+    while (writePointer[b] == pagesPerBlock)
+      b++;
+    openBlock[d] = b;
+    freeBlocks[d] = (d + 1) * blocksPerDie - b - 1;
+    dieFreeAt[d] = 0;
+  }
+
+  nextSeq = 0;
+  nextDie = 0;
+  hostWrites = 0;
+  gcWrites = 0;
+  numErasures = 0;
+  numGC = 0;
+  gcTicks = 0;
+
+  DEBUG('h', (char *) "Flash disk: %d dies, %d blocks of %d pages per die\n",
+        numDies, blocksPerDie, pagesPerBlock);
+}
+
+//----------------------------------------------------------------------
+// FlashDisk::~FlashDisk()
+//! 	Destructor. The UNIX file is closed by BlockDevice.
+//----------------------------------------------------------------------
+
+FlashDisk::~FlashDisk() {
+  delete[] mapping;
+  delete[] pageOwner;
+  delete[] validPages;
+  delete[] writePointer;
+  delete[] eraseCount;
+  delete[] openBlock;
+  delete[] freeBlocks;
+  delete[] dieFreeAt;
+  delete[] channelFreeAt;
+  delete[] tagDone;
+  delete[] tagSeq;
+  delete[] tagActive;
+}
+
+//----------------------------------------------------------------------
+// FlashDisk::MapPage
+/*! 	Record that a sector is stored in a physical page.
+//
+//	\param sector the sector
+//	\param page the physical page, which has just been programmed
+*/
+//----------------------------------------------------------------------
+
+void
+FlashDisk::MapPage(int sector, int page) {
+  ASSERT(mapping[sector] == -1);
+  mapping[sector] = page;
+  pageOwner[page] = sector;
+  validPages[PageBlock(page)]++;
+}
+
+//----------------------------------------------------------------------
+// FlashDisk::UnmapPage
+/*! 	Invalidate the physical page holding a sector.
+//
+//	\param sector the sector
+*/
+//----------------------------------------------------------------------
+
+void
+FlashDisk::UnmapPage(int sector) {
+  int page = mapping[sector];
+
+  if (page < 0)
+    return;
+  pageOwner[page] = -1;
+  validPages[PageBlock(page)]--;
+  mapping[sector] = -1;
+}
+
+//----------------------------------------------------------------------
+// FlashDisk::VictimBlock
+/*! 	Choose the block the garbage collector reclaims on a die: the
+//	full block with the fewest valid pages.
+//
+//	\param die the die
+//	\return the block, -1 if no block has an invalid page
+*/
+//----------------------------------------------------------------------
+
+int
+FlashDisk::VictimBlock(int die) {
+  int victim = -1;
+
+  for (int b = die * blocksPerDie; b < (die + 1) * blocksPerDie; b++) {
+    if ((b == openBlock[die]) || (writePointer[b] < pagesPerBlock))
+      continue;
+    if ((victim < 0) || (validPages[b] < validPages[victim]))
+      victim = b;
+  }
+  if ((victim >= 0) && (validPages[victim] == pagesPerBlock))
+    return -1;
+  return victim;
+}
+
+//----------------------------------------------------------------------
+// FlashDisk::CanWrite
+/*! 	Check whether a page can be programmed on a die, possibly
+//	after a garbage collection.
+//
+//	\param die the die
+*/
+//----------------------------------------------------------------------
+
+bool
+FlashDisk::CanWrite(int die) {
+  if (writePointer[openBlock[die]] < pagesPerBlock)
+    return true;
+  if (freeBlocks[die] > 1)
+    return true;
+  return (VictimBlock(die) >= 0);
+}
+
+//----------------------------------------------------------------------
+// FlashDisk::ChooseDie
+/*! 	Choose the die which programs the next written sector: the one
+//	which will be free first, among the dies having room for it.
+//
+//	\param now the current time
+*/
+//----------------------------------------------------------------------
+
+int
+FlashDisk::ChooseDie(Time now) {
+  int best = -1;
+  Time bestFree = 0;
+
+  for (int i = 0; i < numDies; i++) {
+    int die = (nextDie + i) % numDies;
+    Time freeAt = (dieFreeAt[die] > now) ? dieFreeAt[die] : now;
+    if (!CanWrite(die))
+      continue;
+    if ((best < 0) || (freeAt < bestFree)) {
+      best = die;
+      bestFree = freeAt;
+    }
+  }
+  // There are always more pages than sectors
+  ASSERT(best >= 0);
+  nextDie = (best + 1) % numDies;
+  return best;
+}
+
+//----------------------------------------------------------------------
+// FlashDisk::AllocatePage
+/*! 	Program a sector in a new page of a die, and invalidate its
+//	previous page. When the block being filled is full, continue in
+//	an erased block, or reclaim a block when only the last erased
+//	block of the die is left.
+//
+//	\param die the die
+//	\param sector the written sector
+//	\return the time spent by the die collecting garbage
+*/
+//----------------------------------------------------------------------
+
+Time
+FlashDisk::AllocatePage(int die, int sector) {
+  Time gc = 0;
+  int block = openBlock[die];
+
+  UnmapPage(sector);
+
+  if (writePointer[block] == pagesPerBlock) {
+    // Look for an erased block
+    int erased = die * blocksPerDie;
+    while ((erased == block) || (writePointer[erased] != 0))
+      erased++;
+    ASSERT(erased < (die + 1) * blocksPerDie);
+    freeBlocks[die]--;
+    openBlock[die] = erased;
+
+    if (freeBlocks[die] == 0) {
+      // Copy the valid pages of the victim in the erased block,
+      // then erase the victim which becomes the last erased block
+      int victim = VictimBlock(die);
+      ASSERT(victim >= 0);
+      for (int p = victim * pagesPerBlock; p < (victim + 1) * pagesPerBlock;
+           p++) {
+        int owner = pageOwner[p];
+        if (owner < 0)
+          continue;
+        UnmapPage(owner);
+        MapPage(owner, erased * pagesPerBlock + writePointer[erased]++);
+        gcWrites++;
+        gc += nano_to_cycles(FLASH_READ_TIME + FLASH_PROGRAM_TIME,
+                             g_cfg->ProcessorFrequency);
+      }
+      ASSERT(validPages[victim] == 0);
+      writePointer[victim] = 0;
+      eraseCount[victim]++;
+      numErasures++;
+      numGC++;
+      freeBlocks[die]++;
+      gc += nano_to_cycles(FLASH_ERASE_TIME, g_cfg->ProcessorFrequency);
+      DEBUG('h', (char *) "Flash GC on die %d: block %d reclaimed\n", die,
+            victim);
+    }
+    block = erased;
+  }
+
+  MapPage(sector, block * pagesPerBlock + writePointer[block]++);
+  hostWrites++;
+  return gc;
+}
+
+//----------------------------------------------------------------------
+// FlashDisk::ScheduleDone
+/*! 	Schedule the interrupt signalling the end of a request.
+//
+//	\param tag the tag of the request
+//	\param done the time when the request completes
+*/
+//----------------------------------------------------------------------
+
+void
+FlashDisk::ScheduleDone(int tag, Time done) {
+  Time now = g_stats->getTotalTicks();
+
+  tagActive[tag] = true;
+  tagDone[tag] = done;
+  tagSeq[tag] = nextSeq++;
+  DEBUG('h', (char *) "Flash request %d: latency = %d\n", tag, done - now);
+  g_machine->interrupt->Schedule(FlashDone, (int64_t) this, done - now,
+                                 DISK_INT);
+}
+
+//----------------------------------------------------------------------
+// FlashDisk::ReadRequest
+/*!	Simulate a request to read a single sector
+//	   Do the read immediately to the UNIX file
+//	   Set up an interrupt handler to be called when the die holding
+//	      the sector has read it and the channel has transferred it.
+//
+//	\param sectorNumber the sector to read
+//	\param data the buffer to hold the incoming bytes
+//	\param tag the tag of the request
+*/
+//----------------------------------------------------------------------
+
+void
+FlashDisk::ReadRequest(int sectorNumber, char *data, int tag) {
+  PROFILE_ZONE(PROFILE_DISK);
+  Time now = g_stats->getTotalTicks();
+
+  ASSERT((tag >= 0) && (tag < queueDepth) && !tagActive[tag]);
+  ReadImage(sectorNumber, data);
+
+  int die = BlockDie(PageBlock(mapping[sectorNumber]));
+  int channel = DieChannel(die);
+
+  // The die reads the page in its register, which is then
+  // transferred when the channel is free
+  Time start = (dieFreeAt[die] > now) ? dieFreeAt[die] : now;
+  Time ready =
+      start + nano_to_cycles(FLASH_READ_TIME, g_cfg->ProcessorFrequency);
+  if (channelFreeAt[channel] > ready)
+    ready = channelFreeAt[channel];
+  Time done =
+      ready + nano_to_cycles(FLASH_TRANSFER_TIME, g_cfg->ProcessorFrequency);
+  channelFreeAt[channel] = done;
+  dieFreeAt[die] = done;
+
+  ScheduleDone(tag, done);
+}
+
+//----------------------------------------------------------------------
+// FlashDisk::WriteRequest
+/*!	Simulate a request to write a single sector
+//	   Do the write immediately to the UNIX file
+//	   Set up an interrupt handler to be called when the data has been
+//	      transferred to a die and the die has programmed it, after
+//	      a garbage collection if needed.
+//
+//	\param sectorNumber the sector to write
+//	\param data the bytes to be written
+//	\param tag the tag of the request
+*/
+//----------------------------------------------------------------------
+
+void
+FlashDisk::WriteRequest(int sectorNumber, char *data, int tag) {
+  Time now = g_stats->getTotalTicks();
+
+  ASSERT((tag >= 0) && (tag < queueDepth) && !tagActive[tag]);
+  WriteImage(sectorNumber, data);
+
+  int die = ChooseDie(now);
+  int channel = DieChannel(die);
+
+  // The data goes over the channel, while the die may be collecting
+  // garbage, then the die programs it
+  Time sent = (channelFreeAt[channel] > now) ? channelFreeAt[channel] : now;
+  sent += nano_to_cycles(FLASH_TRANSFER_TIME, g_cfg->ProcessorFrequency);
+  channelFreeAt[channel] = sent;
+
+  Time gc = AllocatePage(die, sectorNumber);
+  gcTicks += gc;
+  Time ready = ((dieFreeAt[die] > now) ? dieFreeAt[die] : now) + gc;
+  if (sent > ready)
+    ready = sent;
+  Time done =
+      ready + nano_to_cycles(FLASH_PROGRAM_TIME, g_cfg->ProcessorFrequency);
+  dieFreeAt[die] = done;
+
+  ScheduleDone(tag, done);
+}
+
+//----------------------------------------------------------------------
+// FlashDisk::HandleInterrupt()
+/*! 	Called when it is time to invoke the interrupt handler, to tell
+//	the Nachos kernel that a request is done. Interrupts are raised
+//	in the order of the completion times, requests completing at the
+//	same time in the order they were sent: the completed request is
+//	the first one in this order.
+*/
+//----------------------------------------------------------------------
+
+void
+FlashDisk::HandleInterrupt() {
+  int tag = -1;
+
+  for (int t = 0; t < queueDepth; t++) {
+    if (!tagActive[t])
+      continue;
+    if ((tag < 0) || (tagDone[t] < tagDone[tag]) ||
+        ((tagDone[t] == tagDone[tag]) && (tagSeq[t] < tagSeq[tag])))
+      tag = t;
+  }
+  ASSERT(tag >= 0);
+  tagActive[tag] = false;
+
+  // Call the disk interrupt handler
+  Complete(tag);
+}
+
+//----------------------------------------------------------------------
+// FlashDisk::Print
+//! 	Print the statistics of the flash translation layer
+//----------------------------------------------------------------------
+
+void
+FlashDisk::Print() {
+  int minErase = eraseCount[0];
+  int maxErase = eraseCount[0];
+
+  for (int b = 1; b < numDies * blocksPerDie; b++) {
+    if (eraseCount[b] < minErase)
+      minErase = eraseCount[b];
+    if (eraseCount[b] > maxErase)
+      maxErase = eraseCount[b];
+  }
+  printf("      flash : %" PRIu64 " pages written, %" PRIu64
+         " copied by %" PRIu64 " GC (write amplification %" PRIu64
+         " %%), GC busy %" PRIu64 " cycles\n",
+         hostWrites, gcWrites, numGC,
+         (hostWrites == 0) ? 100 : ((hostWrites + gcWrites) * 100) / hostWrites,
+         gcTicks);
+  printf("      flash : %" PRIu64 " erasures, %d to %d per block\n",
+         numErasures, minErase, maxErase);
+}
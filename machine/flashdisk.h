@@ -0,0 +1,132 @@
+/*! \file flashdisk.h
+    \brief Data structures to emulate a flash disk (SSD).
+
+        A flash disk accepts several outstanding requests to
+        read/write a sector (native command queuing); each of them
+        is signalled by an interrupt when it completes.
+
+    DO NOT CHANGE -- part of the machine emulation
+
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#ifndef FLASHDISK_H
+#define FLASHDISK_H
+
+#include "kernel/copyright.h"
+#include "machine/blockdev.h"
+#include "utility/utility.h"
+
+/*! \brief Defines a flash disk I/O device.
+//
+// The flash memory is made of g_cfg->FlashChannels channels, each of
+// them linking g_cfg->FlashDiesPerChannel dies to the controller. The
+// dies work in parallel, but the dies of a channel share it to
+// transfer the data. A die is split up into erase blocks of
+// g_cfg->FlashPagesPerBlock pages, a page holding one sector.
+//
+// A page is read in FLASH_READ_TIME nanos and programmed in
+// FLASH_PROGRAM_TIME nanos (cf. stats.h). A page can only be programmed
+// once its block has been erased, which takes FLASH_ERASE_TIME nanos.
+// Moving a page between the controller and a die takes
+// FLASH_TRANSFER_TIME nanos on the channel.
+//
+// The flash translation layer (FTL) of the controller maps each
+// sector to a physical page. A written sector goes to a new page in the
+// block being filled on the least busy die, and its previous page
+// becomes invalid. When a die runs out of erased blocks, the garbage
+// collector copies the valid pages of the block with the fewest of them
+// into the last erased block of the die, then erases it. The
+// flash holds g_cfg->FlashOverProvision % more pages than sectors, so
+// that there are always invalid pages to reclaim.
+//
+// At start, every sector is assumed to be mapped, as if the
+// whole disk had been written once, sectors being striped over the dies.
+//
+// Up to g_cfg->FlashQueueDepth requests are accepted at the same time,
+// they complete in the order given by the availability of the dies
+// and channels.
+*/
+class FlashDisk : public BlockDevice {
+public:
+  FlashDisk(char *name, int sectors, VoidFunctionPtr callWhenDone,
+            int64_t callArg);
+  /*!< Create a simulated flash disk.
+       Invoke (*callWhenDone)(callArg)
+       every time a request completes. */
+  ~FlashDisk(); /*!< Deallocate the flash disk. */
+
+  void ReadRequest(int sectorNumber, char *data, int tag);
+  /*!< Read/write an single sector.
+       These routines send a request to
+       the flash disk and return immediately. */
+  void WriteRequest(int sectorNumber, char *data, int tag);
+
+  int GetQueueDepth() { return queueDepth; }
+  /*!< Number of requests accepted at
+       the same time */
+
+  void HandleInterrupt(); /*!< Interrupt handler, invoked when
+                               a request finishes. */
+
+  void Print();   //!< Print the FTL statistics
+
+private:
+  int numChannels;     //!< Number of channels
+  int numDies;         //!< Number of dies (on all the channels)
+  int pagesPerBlock;   //!< Number of pages in an erase block
+  int blocksPerDie;    //!< Number of erase blocks of a die
+  int queueDepth;      //!< Maximum number of outstanding requests
+
+  int *mapping;         //!< Physical page of each sector, -1 if unmapped
+  int *pageOwner;       //!< Sector held by each valid page, -1 otherwise
+  int *validPages;      //!< Number of valid pages of each block
+  int *writePointer;    //!< Next page to program in each block
+  int *eraseCount;      //!< Number of erasures of each block
+  int *openBlock;       //!< Block being filled on each die
+  int *freeBlocks;      //!< Number of erased blocks (open one excluded)
+                        //!< on each die
+  Time *dieFreeAt;      //!< When each die finishes its work
+  Time *channelFreeAt;  //!< When each channel finishes its transfers
+
+  Time *tagDone;        //!< Completion time of the request of each tag
+  uint64_t *tagSeq;     //!< Sending order of the request of each tag
+  bool *tagActive;      //!< Is a request in progress for each tag?
+  uint64_t nextSeq;     //!< Sending order of the next request
+  int nextDie;          //!< First die looked at for the next write
+
+  uint64_t hostWrites;     //!< Pages programmed for the requests
+  uint64_t gcWrites;       //!< Pages copied by the garbage collector
+  uint64_t numErasures;    //!< Blocks erased
+  uint64_t numGC;          //!< Garbage collections
+  Time gcTicks;            //!< Time spent by the dies collecting garbage
+
+  int BlockDie(int block) { return block / blocksPerDie; }
+  int DieChannel(int die) { return die % numChannels; }
+  int PageBlock(int page) { return page / pagesPerBlock; }
+
+  void MapPage(int sector, int page);   // sector is now in page
+  void UnmapPage(int sector);           // invalidate the page of sector
+  bool CanWrite(int die);               // is there room for a page on die?
+  int ChooseDie(Time now);              // die getting the next write
+  int VictimBlock(int die);             // best block to reclaim on die
+  Time AllocatePage(int die, int sector);
+  // Give a new page to sector on die,
+  // return the garbage collection time
+  void ScheduleDone(int tag, Time done);   // end of request at done
+};
+
+#endif   // FLASHDISK_H
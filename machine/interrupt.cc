@@ -32,9 +32,12 @@
 //  DO NOT CHANGE -- part of the machine emulation
 //
 
+#include "kernel/scheduler.h"
 #include "kernel/system.h"
 #include "kernel/thread.h"
+#include "kernel/workqueue.h"
 #include "machine/machine.h"
+#include "utility/profile.h"
 #include "utility/stats.h"
 
 //! String definition for debugging messages
@@ -142,7 +145,8 @@ Interrupt::SetStatus(IntStatus now) {
 */
 //----------------------------------------------------------------------
 void
-Interrupt::OneTick(int nbcycles) {
+Interrupt::OneTick(Time nbcycles) {
+  PROFILE_ZONE(PROFILE_TICK);
   ASSERT(level == INTERRUPTS_ON);   // interrupts need to be enabled,
                                     // to check for an interrupt handler
 
@@ -150,9 +154,9 @@ Interrupt::OneTick(int nbcycles) {
 
   // advance simulated time
   if (g_machine->GetStatus() == SYSTEM_MODE) {
-    g_current_thread->GetProcessOwner()->stat->incrSystemTicks(nbcycles);
+    g_current_thread->stat->incrSystemTicks(nbcycles);
   } else {
-    g_current_thread->GetProcessOwner()->stat->incrUserTicks(nbcycles);
+    g_current_thread->stat->incrUserTicks(nbcycles);
   }
 
   // check any pending interrupts are now ready to fire
@@ -162,11 +166,18 @@ Interrupt::OneTick(int nbcycles) {
   while (CheckIfDue(false))                     // check for pending interrupts
     ;
   ChangeLevel(INTERRUPTS_OFF, INTERRUPTS_ON);   // re-enable interrupts
+
+  // Run the work deferred by the handlers, with interrupts enabled
+  if (!g_work_queue->IsEmpty()) {
+    g_machine->SetStatus(SYSTEM_MODE);
+    g_work_queue->Run();
+    g_machine->SetStatus(old);
+  }
   if (yieldOnReturn) {   // if the timer device handler asked
                          // for a context switch, ok to do it now
     yieldOnReturn = false;
     g_machine->SetStatus(SYSTEM_MODE);   // yield is a kernel routine
-    g_current_thread->Yield();
+    g_scheduler->Preempt();
     g_machine->SetStatus(old);
   }
 }
@@ -211,6 +222,7 @@ Interrupt::Idle() {
     yieldOnReturn = false;      // since there's nothing in the
                                 // ready queue, the yield is automatic
     g_machine->SetStatus(SYSTEM_MODE);
+    g_work_queue->Run();   // the deferred work may wake up a thread
     return;   // return in case there's now
               // a runnable thread
   }
@@ -271,6 +283,25 @@ Interrupt::Schedule(VoidFunctionPtr handler, int64_t arg, int fromNow,
   pending->SortedInsert(toOccur, when);
 }
 
+//----------------------------------------------------------------------
+// Interrupt::NextDue
+/*! 	Time of the next pending interrupt: nothing can happen before it
+//	that the running thread does not do itself. Used to skip the spin
+//	loops.
+//
+// \return
+//	the time when the next interrupt is scheduled, 0 if none is
+*/
+//----------------------------------------------------------------------
+Time
+Interrupt::NextDue() {
+  ListElement<Time> *first = pending->getFirst();
+
+  if (first == NULL)
+    return 0;
+  return first->key;
+}
+
 //----------------------------------------------------------------------
 // Interrupt::CheckIfDue
 /*! 	Check if an interrupt is scheduled to occur, and if so, fire it off.
@@ -322,7 +353,10 @@ Interrupt::CheckIfDue(bool advanceClock) {
   g_machine->SetStatus(SYSTEM_MODE);   // whatever we were doing,
                                        // we are now going to be
                                        // running in the kernel
+  uint64_t start = HostNanos();
   (*(toOccur->handler))(toOccur->arg);   // call the interrupt handler
+  g_stats->incrHandlers(HostNanos() - start);
+  g_machine->SpinDisturbed();            // the handler may end a spin loop
   g_machine->SetStatus(old);             // restore the machine status
   inHandler = false;
   delete toOccur;
@@ -128,7 +128,9 @@ public:
                 IntType type);   //!< at time ``when''.  This is called
                                  //!< by the hardware device simulators.
 
-  void OneTick(int nbcy);   // !<Advance simulated time of nbcy cycles
+  void OneTick(Time nbcy);   // !<Advance simulated time of nbcy cycles
+
+  Time NextDue();   //!< Time of the next pending interrupt, 0 if none
 
 private:
   IntStatus level;   //!< are interrupts enabled or disabled?
@@ -26,6 +26,8 @@
 #include "kernel/msgerror.h"
 #include "kernel/system.h"
 #include "machine/interrupt.h"
+#include "utility/profile.h"
+#include <limits.h>
 
 /*! Textual names of the exceptions that can be generated by user program
  execution, for debugging purpose.
@@ -62,6 +64,25 @@ CheckEndian() {
     host_endianess = IS_LITTLE_ENDIAN;
 }
 
+//----------------------------------------------------------------------
+// NewBlockDevice
+/*! 	Create a block device of the kind given in the configuration.
+//
+//	\param type DISK_ROTATING or DISK_FLASH
+//	\param name name of the UNIX file simulating the device
+//	\param sectors number of sectors of the device
+//	\param callWhenDone interrupt handler of the device
+//	\param callArg argument to pass the interrupt handler
+*/
+//----------------------------------------------------------------------
+static BlockDevice *
+NewBlockDevice(uint8_t type, char *name, int sectors,
+               VoidFunctionPtr callWhenDone, int64_t callArg) {
+  if (type == DISK_FLASH)
+    return new FlashDisk(name, sectors, callWhenDone, callArg);
+  return new Disk(name, sectors, callWhenDone, callArg);
+}
+
 //----------------------------------------------------------------------
 // Machine::Machine
 /*! 	Constructor. Initialize the RISCV machine.
@@ -79,11 +100,10 @@ Machine::Machine(bool debug) {
   for (i = 0; i < NUM_FP_REGS; i++)
     float_registers[i] = 0;
 
-  // Allocate the main memory of the machine and fills it up with zeroes
-  int memSize = g_cfg->NumPhysPages * g_cfg->PageSize;
-  mainMemory = new int8_t[memSize];
-  for (i = 0; i < memSize; i++)
-    mainMemory[i] = 0;
+  // Allocate the main memory of the machine, filled up with zeroes
+  // by the host as it gets used
+  mainMemory = AllocZeroedMemory(g_cfg->NumPhysPages * g_cfg->PageSize,
+                                 g_cfg->HugePages);
 
   // Check the endianess of the host machine
   CheckEndian();
@@ -91,11 +111,27 @@ Machine::Machine(bool debug) {
   // Sets the debug mode of the machine according to the debug flag
   singleStep = debug;
 
+  // No spin loop watched yet
+  spinPC = 0;
+  spinVisits = 0;
+
   // Create the machine sub-components
   this->mmu = new MMU();
   this->interrupt = new Interrupt();
-  this->disk = new Disk(DISK_FILE_NAME, DiskRequestDone);
-  this->diskSwap = new Disk(DISK_SWAP_NAME, DiskSwapRequestDone);
+  // The first data disk is DISK, the following ones DISK1, DISK2...
+  // The sectors of the volume are striped over them
+  int diskSectors = divRoundUp(NUM_SECTORS, g_cfg->NumDataDisks);
+  this->disks = new BlockDevice *[g_cfg->NumDataDisks];
+  this->disks[0] = NewBlockDevice(g_cfg->DiskType, DISK_FILE_NAME, diskSectors,
+                                  DiskRequestDone, 0);
+  for (uint32_t d = 1; d < g_cfg->NumDataDisks; d++) {
+    char name[MAXSTRLEN];
+    sprintf(name, "%s%" PRIu32, DISK_FILE_NAME, d);
+    this->disks[d] = NewBlockDevice(g_cfg->DiskType, name, diskSectors,
+                                    DiskRequestDone, d);
+  }
+  this->diskSwap = NewBlockDevice(g_cfg->SwapDiskType, DISK_SWAP_NAME,
+                                  NUM_SECTORS, DiskSwapRequestDone, 0);
   this->console = new Console(NULL, NULL, ConsoleGet, ConsolePut);
   if (g_cfg->ACIA)
     this->acia = new ACIA(this);
@@ -117,9 +153,12 @@ Machine::~Machine() {
   delete this->interrupt;
   if (this->acia != NULL)
     delete this->acia;
-  delete this->disk;
+  for (uint32_t d = 0; d < g_cfg->NumDataDisks; d++)
+    delete this->disks[d];
+  delete[] this->disks;
   delete this->diskSwap;
   delete this->console;
+  DeallocZeroedMemory(mainMemory, g_cfg->NumPhysPages * g_cfg->PageSize);
 }
 
 //----------------------------------------------------------------------
@@ -336,7 +375,9 @@ Machine::Run() {
 
 int
 Machine::OneInstruction(Instruction *instr) {
+  PROFILE_ZONE(PROFILE_INSTRUCTION);
   int execution_time;   // execution time of the instruction
+  int64_t instrPC = pc;
   if (!mmu->ReadMem(pc, 4, &(instr->value)))
     return 0;   // exception occurred
   instr->Decode();
@@ -345,7 +386,7 @@ Machine::OneInstruction(Instruction *instr) {
   execution_time = USER_TICK;
 
   // Update statistics
-  g_current_thread->GetProcessOwner()->stat->incrNumInstruction();
+  g_current_thread->stat->incrNumInstruction();
 
   // Print its textual representation if debug flag 'm' is set
   if (DebugIsEnabled('m')) {
@@ -1050,6 +1091,77 @@ Machine::OneInstruction(Instruction *instr) {
   n_inst = n_inst + 1;
   cycle++;
 
+  // A short jump backwards may close a spin loop
+  if (g_cfg->SkipSpinLoops && (pc < instrPC) && (instrPC - pc <= SPIN_WINDOW))
+    execution_time += CheckSpin(instrPC, execution_time);
+
   // Now we have successfully executed the instruction.
   return execution_time;
 }
+
+//----------------------------------------------------------------------
+// Machine::CheckSpin
+/*!	Called on each short jump backwards, to detect the loops which
+//	spin until an interrupt: "while (flag == 0);", or a loop on Yield
+//	with no other thread ready to run.
+//
+//	Such a loop makes no store, and no system call but Yield. If
+//	nothing disturbed it (see SpinDisturbed) between two visits of
+//	the same jump, and the registers are the same at both, the loop
+//	is in a state it already went through, and will keep going
+//	through the same states until an interrupt changes something.
+//	Simulating it is a waste of host time: simulated time jumps
+//	forward to the next pending interrupt instead, and the skipped
+//	cycles are charged to the thread as if it had spun.
+//
+//	The registers are only saved on a visit that follows another
+//	undisturbed one, so the loops that store cost almost nothing.
+//
+//	\param jumpPC address of the jump instruction
+//	\param execution_time cycles already charged for the jump
+//	\return the number of cycles to skip (0 if not spinning)
+*/
+//----------------------------------------------------------------------
+int
+Machine::CheckSpin(int64_t jumpPC, int execution_time) {
+  if (jumpPC != spinPC) {
+    // Another loop: start watching it
+    spinPC = jumpPC;
+    spinVisits = 1;
+    return 0;
+  }
+
+  if ((spinVisits < 2) ||
+      (memcmp(spinIntRegs, int_registers, sizeof(spinIntRegs)) != 0) ||
+      (memcmp(spinFPRegs, float_registers, sizeof(spinFPRegs)) != 0)) {
+    if (spinVisits == 0) {
+      // Disturbed since the last visit
+      spinVisits = 1;
+    } else {
+      // Undisturbed iteration: see if the next one ends the same way
+      memcpy(spinIntRegs, int_registers, sizeof(spinIntRegs));
+      memcpy(spinFPRegs, float_registers, sizeof(spinFPRegs));
+      spinVisits = 2;
+    }
+    return 0;
+  }
+
+  // Spinning: skip up to the next interrupt, if any. The cycles of an
+  // instruction are an int: a longer skip is cut, the loop being still
+  // known as spinning at its next visit
+  Time now = g_stats->getTotalTicks() + execution_time;
+  Time when = interrupt->NextDue();
+  if (when <= now)
+    return 0;
+  Time skip = when - now;
+  if (skip > (Time) (INT_MAX - execution_time))
+    skip = INT_MAX - execution_time;
+  else
+    spinVisits = 0;
+
+  DEBUG('m', (char *) "Spin loop at PC 0x%" PRIx64 ", skipping %" PRIu64
+                      " cycles\n",
+        jumpPC, skip);
+  g_stats->incrSpinSkips(skip);
+  return (int) skip;
+}
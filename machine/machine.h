@@ -72,6 +72,7 @@ enum ExceptionType : short {
 
 #include "kernel/copyright.h"
 #include "machine/disk.h"
+#include "machine/flashdisk.h"
 #include "machine/instruction.h"
 #include "utility/stats.h"
 
@@ -103,6 +104,8 @@ enum MachineStatus { IDLE_MODE, SYSTEM_MODE, USER_MODE };
 #define NUM_INT_REGS 32   //!< Number of integer registers
 #define NUM_FP_REGS  32   //!< Number of floating point registers
 
+#define SPIN_WINDOW 256   //!< Largest spin loop watched, in bytes of code
+
 /*! \brief Defines the simulated execution hardware
 //
 // User programs shouldn't be able to tell that they are running on our
@@ -156,6 +159,10 @@ public:
   void Debugger();    //!< Invoke the user program debugger
   void DumpState();   //!< Print the user CPU and memory state
 
+  void SpinDisturbed() { spinVisits = 0; }
+  //!< Something happened that may end a spin loop: a store, a system
+  //!< call, an interrupt or a context switch (see CheckSpin)
+
   // Data structures -- all of these are accessible to Nachos kernel code.
   // "public" for convenience.
   //
@@ -183,8 +190,9 @@ public:
   MMU *mmu;             /*!< Machine memory management unit */
   ACIA *acia;           /*!< ACIA Hardware */
   Interrupt *interrupt; /*!< Interrupt management */
-  Disk *disk;           /*!< Raw disk device (hardware) */
-  Disk *diskSwap;       /*!< Swap raw disk device (hardware) */
+  BlockDevice **disks;  /*!< Raw data disk devices (hardware), there
+                          are g_cfg->NumDataDisks of them */
+  BlockDevice *diskSwap; /*!< Swap raw disk device (hardware) */
   Console *console;     /*!< Console */
 
 private:
@@ -200,6 +208,16 @@ private:
 
   uint64_t n_inst;
   uint64_t cycle;
+
+  int CheckSpin(int64_t jumpPC, int execution_time);
+  //!< Check whether a jump backwards closes a spin loop, and if so
+  //!< return the number of cycles to skip
+
+  int64_t spinPC;   //!< backward jump of the loop being watched
+  int spinVisits;   /*!< number of visits of spinPC with nothing
+                      disturbing in between (at most 2) */
+  int64_t spinIntRegs[NUM_INT_REGS];   //!< registers at the last visit
+  int64_t spinFPRegs[NUM_FP_REGS];
 };
 
 //! Entry point into Nachos to handle user system calls and exceptions.
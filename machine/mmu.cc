@@ -36,6 +36,7 @@
 #include "kernel/msgerror.h"
 #include "kernel/system.h"
 #include "machine/machine.h"
+#include "utility/profile.h"
 #include "vm/pagefaultmanager.h"
 #include "vm/physMem.h"
 
@@ -75,7 +76,7 @@ MMU::ReadMem(uint64_t virtAddr, int size, uint64_t *value) {
   DEBUG('z', (char *) "Reading VA 0x%x, size %d\n", virtAddr, size);
 
   // Update statistics
-  g_current_thread->GetProcessOwner()->stat->incrMemoryAccess();
+  g_current_thread->stat->incrMemoryAccess();
 
   // Perform address translation
   exc = Translate(virtAddr, &physAddr, size, false);
@@ -139,7 +140,10 @@ MMU::WriteMem(uint64_t addr, int size, uint64_t value) {
         value);
 
   // Update statistics
-  g_current_thread->GetProcessOwner()->stat->incrMemoryAccess();
+  g_current_thread->stat->incrMemoryAccess();
+
+  // A store may end a spin loop
+  g_machine->SpinDisturbed();
 
   // Perform address translation
   exc = Translate(addr, &physicalAddress, size, true);
@@ -181,6 +185,8 @@ MMU::WriteMem(uint64_t addr, int size, uint64_t value) {
 // MMU::Translate(uint32_t virtAddr, uint32_t *physAddr, int size, bool writing)
 /*! 	Translate a virtual address into a physical address, using
 //      a linear page table.
+//         - If the page belongs to a superpage, translate it with the
+//           first entry of the superpage
 //         - Look for a translation of the virtual page in the page table
 //             - if found, check access rights and physical address
 //                correctness, returns the physical page
@@ -204,6 +210,7 @@ MMU::WriteMem(uint64_t addr, int size, uint64_t value) {
 */
 ExceptionType
 MMU::Translate(uint32_t virtAddr, uint32_t *physAddr, int size, bool writing) {
+  PROFILE_ZONE(PROFILE_TRANSLATE);
   DEBUG('h', (char *) "\tTranslate 0x%x, %s: ", virtAddr,
         writing ? "write" : "read");
 
@@ -231,6 +238,27 @@ MMU::Translate(uint32_t virtAddr, uint32_t *physAddr, int size, bool writing) {
     return ADDRESSERROR_EXCEPTION;
   }
 
+  // Fast path for a superpage: its first entry describes the whole
+  // block, which is always in main memory
+  if (translationTable->isSuperPage(vpn)) {
+    int first = vpn & ~(g_cfg->SuperPageSize - 1);
+    if (writing && !translationTable->getBitWriteAllowed(first)) {
+      DEBUG('h', (char *) "write access on read-only superpage # %d !\n",
+            first);
+      return READONLY_EXCEPTION;
+    }
+    if (writing)
+      translationTable->setBitM(first);
+    translationTable->setBitU(first);
+    g_current_thread->stat->incrMemoryAccess();
+
+    *physAddr = (translationTable->getPhysicalPage(first) + vpn - first) *
+                    g_cfg->PageSize +
+                offset;
+    DEBUG('h', (char *) "phys addr = 0x%x (superpage)\n", *physAddr);
+    return NO_EXCEPTION;
+  }
+
   // is the page correctly mapped ?
   if (!translationTable->getBitReadAllowed(vpn) &&
       !translationTable->getBitWriteAllowed(vpn)) {
@@ -273,7 +301,7 @@ MMU::Translate(uint32_t virtAddr, uint32_t *physAddr, int size, bool writing) {
     translationTable->setBitM(vpn);
   }
   translationTable->setBitU(vpn);
-  g_current_thread->GetProcessOwner()->stat->incrMemoryAccess();
+  g_current_thread->stat->incrMemoryAccess();
 
   *physAddr = translationTable->getPhysicalPage(vpn) * g_cfg->PageSize + offset;
   DEBUG('h', (char *) "phys addr = 0x%x\n", *physAddr);
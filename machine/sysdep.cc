@@ -166,6 +166,40 @@ OpenForReadWrite(char *name, bool crashOnError) {
   return fd;
 }
 
+//----------------------------------------------------------------------
+// OpenForRead
+/*! 	Open a file for reading only.
+//	Return the file descriptor, or error if it doesn't exist.
+//
+//	\param name file name
+*/
+//----------------------------------------------------------------------
+int
+OpenForRead(char *name, bool crashOnError) {
+  int fd = open(name, O_RDONLY, 0);
+
+  ASSERT(!crashOnError || fd >= 0);
+  return fd;
+}
+
+//----------------------------------------------------------------------
+// OpenTemporary
+/*! 	Create and open for reading and writing a new file with a unique
+//	name. The name is built by replacing the trailing "XXXXXX" of
+//	nameTemplate, which is modified in place.
+//
+//	\param nameTemplate file name, ending with "XXXXXX"
+//      \return file descriptor
+*/
+//----------------------------------------------------------------------
+int
+OpenTemporary(char *nameTemplate) {
+  int fd = mkstemp(nameTemplate);
+
+  ASSERT(fd >= 0);
+  return fd;
+}
+
 //----------------------------------------------------------------------
 // Read
 //! 	Read characters from an open file.  Abort if read fails.
@@ -362,6 +396,22 @@ Delay(int seconds) {
   (void) sleep((unsigned) seconds);
 }
 
+//----------------------------------------------------------------------
+// HostNanos
+/*! 	Return the time elapsed on the host since an arbitrary point,
+//	in nanoseconds. Unlike the simulated time, it measures how much
+//	work the simulator (and the kernel running on it) really does.
+*/
+//----------------------------------------------------------------------
+
+uint64_t
+HostNanos() {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t) now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
 //----------------------------------------------------------------------
 // Abort
 //! 	Quit and drop core.
@@ -425,3 +475,42 @@ void
 DeallocBoundedArray(int8_t *ptr, size_t size) {
   delete[] ptr;
 }
+
+//----------------------------------------------------------------------
+// AllocZeroedMemory
+/*! 	Return the address of a zero-filled memory area. The area is an
+//	anonymous mapping: the host only provides (and zeroes) its pages
+//	when they are first touched, so that the cost of the allocation
+//	does not depend on its size.
+//
+//	\param size size of the area (in bytes)
+//	\param hugePages if true, ask the host to back the area with
+//	       transparent huge pages, where available
+*/
+//----------------------------------------------------------------------
+int8_t *
+AllocZeroedMemory(size_t size, bool hugePages) {
+  void *ptr = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+  ASSERT(ptr != MAP_FAILED);
+#ifdef MADV_HUGEPAGE
+  // Only a hint, the area is usable whatever the answer
+  if (hugePages)
+    madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+  return (int8_t *) ptr;
+}
+
+//----------------------------------------------------------------------
+// DeallocZeroedMemory
+/*! 	Give back to the host a memory area got with AllocZeroedMemory.
+//
+//	\param ptr the area to be deallocated
+//	\param size size of the area (in bytes)
+*/
+//----------------------------------------------------------------------
+void
+DeallocZeroedMemory(int8_t *ptr, size_t size) {
+  munmap(ptr, size);
+}
@@ -50,6 +50,8 @@ extern bool PollFile(int fd);
 
 extern int OpenForWrite(char *name);
 extern int OpenForReadWrite(char *name, bool crashOnError);
+extern int OpenForRead(char *name, bool crashOnError);
+extern int OpenTemporary(char *nameTemplate);
 extern void Read(int fd, char *buffer, int nBytes);
 extern int ReadPartial(int fd, char *buffer, int nBytes);
 extern void WriteFile(int fd, char *buffer, int nBytes);
@@ -72,6 +74,9 @@ extern void Abort();
 extern void Exit(int exitCode);
 extern void Delay(int seconds);
 
+// Host time, to measure the cost of parts of the simulator
+extern uint64_t HostNanos();
+
 // Initialize system so that cleanUp routine is called when user hits ctl-C
 extern void CallOnUserAbort(VoidNoArgFunctionPtr cleanUp);
 
@@ -86,6 +91,13 @@ extern int Random();
 extern int8_t *AllocBoundedArray(size_t size);
 extern void DeallocBoundedArray(int8_t *p, size_t size);
 
+/* Allocate, de-allocate a zero-filled memory area, whose pages are
+// only backed by the host when they are first touched
+*/
+
+extern int8_t *AllocZeroedMemory(size_t size, bool hugePages);
+extern void DeallocZeroedMemory(int8_t *p, size_t size);
+
 /* Other C library routines that are used by Nachos.
 // These are assumed to be portable, so we don't include a wrapper.
 */
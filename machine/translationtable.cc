@@ -35,6 +35,7 @@ TranslationTable::TranslationTable() {
 
   // Init private fields
   maxNumPages = g_cfg->MaxVirtPages;
+  superPageMask = ~(g_cfg->SuperPageSize - 1);
 
   DEBUG('h', (char *) "Allocationg translation table for %d pages (%ld kB)\n",
         maxNumPages, ((long long) maxNumPages * g_cfg->PageSize) >> 10);
@@ -303,35 +304,97 @@ TranslationTable::getBitWriteAllowed(uint64_t virtualPage) {
 void
 TranslationTable::setBitU(uint64_t virtualPage) {
   ASSERT((virtualPage >= 0) && (virtualPage < maxNumPages));
-  pageTable[virtualPage].U = true;
+  pageTable[usageEntry(virtualPage)].U = true;
 }
 
 void
 TranslationTable::clearBitU(uint64_t virtualPage) {
   ASSERT((virtualPage >= 0) && (virtualPage < maxNumPages));
-  pageTable[virtualPage].U = false;
+  pageTable[usageEntry(virtualPage)].U = false;
 }
 bool
 TranslationTable::getBitU(uint64_t virtualPage) {
   ASSERT((virtualPage >= 0) && (virtualPage < maxNumPages));
-  return pageTable[virtualPage].U;
+  return pageTable[usageEntry(virtualPage)].U;
 }
 
 void
 TranslationTable::setBitM(uint64_t virtualPage) {
   ASSERT((virtualPage >= 0) && (virtualPage < maxNumPages));
-  pageTable[virtualPage].M = true;
+  pageTable[usageEntry(virtualPage)].M = true;
 }
 
 void
 TranslationTable::clearBitM(uint64_t virtualPage) {
   ASSERT((virtualPage >= 0) && (virtualPage < maxNumPages));
-  pageTable[virtualPage].M = false;
+  pageTable[usageEntry(virtualPage)].M = false;
 }
 bool
 TranslationTable::getBitM(uint64_t virtualPage) {
   ASSERT((virtualPage >= 0) && (virtualPage < maxNumPages));
-  return pageTable[virtualPage].M;
+  return pageTable[usageEntry(virtualPage)].M;
+}
+
+//----------------------------------------------------------------------
+//  TranslationTable::usageEntry
+/*!  Get the entry holding the U and M bits of a virtual page: the
+//   first entry of its block when it belongs to a superpage, its own
+//   entry otherwise
+//   \param virtualPage : the virtual page
+//   \return the virtual page of the entry
+*/
+//----------------------------------------------------------------------
+uint64_t
+TranslationTable::usageEntry(uint64_t virtualPage) {
+  uint64_t first = virtualPage & superPageMask;
+  return pageTable[first].superPage ? first : virtualPage;
+}
+
+//----------------------------------------------------------------------
+//  TranslationTable::setSuperPage
+/*!  Declare the block of a virtual page as a superpage. The entries of
+//   the block must already map its virtual pages to contiguous
+//   physical pages.
+//   \param virtualPage : the first virtual page of the block
+*/
+//----------------------------------------------------------------------
+void
+TranslationTable::setSuperPage(uint64_t virtualPage) {
+  ASSERT((virtualPage & superPageMask) == virtualPage);
+  ASSERT(virtualPage + g_cfg->SuperPageSize <= maxNumPages);
+  pageTable[virtualPage].superPage = true;
+}
+
+//----------------------------------------------------------------------
+//  TranslationTable::clearSuperPage
+/*!  Split the superpage of a virtual page into single pages. The U and
+//   M bits of the superpage are given to each of its pages.
+//   \param virtualPage : a virtual page of the superpage
+*/
+//----------------------------------------------------------------------
+void
+TranslationTable::clearSuperPage(uint64_t virtualPage) {
+  uint64_t first = virtualPage & superPageMask;
+
+  ASSERT(pageTable[first].superPage);
+  pageTable[first].superPage = false;
+  for (uint64_t i = 1; i < g_cfg->SuperPageSize; i++) {
+    pageTable[first + i].U = pageTable[first].U;
+    pageTable[first + i].M = pageTable[first].M;
+  }
+}
+
+//----------------------------------------------------------------------
+//  TranslationTable::isSuperPage
+/*!  Tell if a virtual page belongs to a superpage
+//   \param virtualPage : the virtual page
+//   \return true if the block of the virtual page is a superpage
+*/
+//----------------------------------------------------------------------
+bool
+TranslationTable::isSuperPage(uint64_t virtualPage) {
+  ASSERT((virtualPage >= 0) && (virtualPage < maxNumPages));
+  return pageTable[virtualPage & superPageMask].superPage;
 }
 
 //----------------------------------------------------------------------
@@ -347,4 +410,5 @@ PageTableEntry::PageTableEntry() {
   writeAllowed = false;
   U = false;
   M = false;
+  superPage = false;
 }
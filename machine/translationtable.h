@@ -35,6 +35,10 @@ enum TranslationMode { SingleLevel, DualLevel };
 
 /*! \brief Defines the data structures used for address translation
 //
+// An aligned block of g_cfg->SuperPageSize virtual pages mapped to
+// contiguous physical pages may be declared as a superpage. Its first
+// entry then describes the whole block for the MMU, and holds the U
+// and M bits of all its pages.
 */
 
 class TranslationTable {
@@ -81,10 +85,22 @@ public:
   void clearBitM(uint64_t virtualPage);
   bool getBitM(uint64_t virtualPage);
 
+  // Methods to declare the block of a virtual page as a superpage,
+  // or to split it back into single pages
+  void setSuperPage(uint64_t virtualPage);
+  void clearSuperPage(uint64_t virtualPage);
+  bool isSuperPage(uint64_t virtualPage);
+
 private:
   // Maximum number of pages that can be translated
   uint64_t maxNumPages;
 
+  // Mask giving the first virtual page of the block of a virtual page
+  uint64_t superPageMask;
+
+  // Entry holding the U and M bits of a virtual page
+  uint64_t usageEntry(uint64_t virtualPage);
+
   // Page table entries
   PageTableEntry *pageTable;
 };
@@ -143,6 +159,11 @@ public:
   /*! This bit is set by the system every time the
     page is occupied in a input-output.  */
   bool io;
+
+  /*! If this bit is set, the entry is the first one of a superpage:
+    the virtual pages of its block are mapped to the physical pages
+    following physicalPage, with the same access rights. */
+  bool superPage;
 };
 
 #endif   // TTABLE_H
@@ -0,0 +1,116 @@
+/* acia_bench.c
+ *    Throughput test of the serial line (ACIA) between two Nachos.
+ *
+ *    The same program runs on both Nachos instances. A sender thread
+ *    pushes NB_MSG messages of MSG_LEN characters while a receiver
+ *    thread gets the NB_MSG messages of the other side, then the
+ *    simulated time of the transfer and the throughput are printed.
+ *
+ *    Both instances run on the same host, through the loopback UDP
+ *    interface. Use two configuration files which only differ by
+ *    their swapped port numbers, for instance:
+ *
+ *      first nachos:   NumPortLoc = 32009   NumPortDist = 32010
+ *      second nachos:  NumPortLoc = 32010   NumPortDist = 32009
+ *
+ *    with in both files:
+ *
+ *      TargetMachineName = localhost
+ *      UseACIA           = Interrupt   (or BusyWaiting)
+ *      FileToCopy        = test/acia_bench /acia_bench
+ *      ProgramToRun      = /acia_bench
+ *
+ *    and start them with "nachos -f <cfg_file>" in two shells.
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+// Nachos system calls
+#include "userlib/syscall.h"
+#include "userlib/libnachos.h"
+
+#define NB_MSG  50
+#define MSG_LEN 64
+
+// Set by the receiver as soon as the other Nachos is known to be up
+volatile int peer_up = 0;
+
+int received_bytes = 0;
+int lost_msg = 0;
+
+void sender()
+{
+  char msg[MSG_LEN + 1];
+  int i;
+
+  // The other side may not be started yet: UDP drops what is sent to
+  // a closed port, so announce ourself until it answers.
+  while (!peer_up) {
+    TtySend("sync");
+    Yield();
+  }
+
+  for (i = 0; i < MSG_LEN; i++)
+    msg[i] = 'a' + (i % 26);
+  msg[MSG_LEN] = '\0';
+
+  for (i = 0; i < NB_MSG; i++)
+    TtySend(msg);
+}
+
+void receiver()
+{
+  char buff[MSG_LEN + 1];
+  int n = 0;
+  int lg;
+
+  while (n < NB_MSG) {
+    lg = TtyReceive(buff, MSG_LEN);
+    peer_up = 1;
+    if (n_strcmp(buff, "sync") == 0)
+      continue;
+    if (lg != MSG_LEN)
+      lost_msg++;
+    received_bytes += lg + 1;
+    n++;
+  }
+}
+
+int main()
+{
+  Nachos_Time start, end;
+  long nanos;
+
+  ThreadId recv_th = threadCreate("acia receiver", &receiver);
+  ThreadId send_th = threadCreate("acia sender", &sender);
+
+  while (!peer_up)
+    Yield();
+  SysTime(&start);
+
+  Join(send_th);
+  Join(recv_th);
+  SysTime(&end);
+
+  nanos = (end.seconds - start.seconds) * 1000000000 +
+          (end.nanos - start.nanos);
+  n_printf("ACIA bench: sent %d bytes, received %d bytes in %d messages\n",
+           NB_MSG * (MSG_LEN + 1), received_bytes, NB_MSG);
+  n_printf("ACIA bench: %d truncated messages\n", lost_msg);
+  n_printf("ACIA bench: %d us of simulated time, %d bytes/ms\n",
+           (int) (nanos / 1000),
+           (int) ((long) received_bytes * 1000000 / (nanos > 0 ? nanos : 1)));
+  return 0;
+}
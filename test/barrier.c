@@ -0,0 +1,65 @@
+/* barrier.c
+ *    A bulk-synchronous job, to check the kernel barriers.
+ *
+ *    NB_THREADS threads compute NB_PHASES phases, and meet at a barrier
+ *    at the end of each of them: a single BarrierWait per thread and
+ *    per phase, the last thread to arrive releasing all the others.
+ *    With PrintStat = 1, the time spent at the barrier is printed when
+ *    it is destroyed.
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+// Nachos system calls
+#include "userlib/syscall.h"
+#include "userlib/libnachos.h"
+
+#define NB_THREADS 4
+#define NB_PHASES  10
+#define NB_LOOPS   1000
+
+BarrierId barrier;
+int results[NB_THREADS];
+int next_id = 0;
+
+void worker()
+{
+  int id = next_id++;
+  int phase, i;
+
+  for (phase = 0; phase < NB_PHASES; phase++) {
+    // Unbalanced phases: the last threads have more to do
+    for (i = 0; i < NB_LOOPS * (id + 1); i++)
+      results[id] += i % 7;
+    BarrierWait(barrier);
+  }
+}
+
+int main()
+{
+  ThreadId th[NB_THREADS];
+  int i;
+
+  barrier = BarrierCreate("phase barrier", NB_THREADS);
+  for (i = 0; i < NB_THREADS; i++)
+    th[i] = threadCreate("barrier worker", &worker);
+  for (i = 0; i < NB_THREADS; i++)
+    Join(th[i]);
+  BarrierDestroy(barrier);
+
+  for (i = 0; i < NB_THREADS; i++)
+    n_printf("barrier: worker %d computed %d\n", i, results[i]);
+  return 0;
+}
@@ -0,0 +1,63 @@
+/* batch.c
+ *    A multi-threaded CPU-bound job, to check the fair-share scheduling.
+ *
+ *    NB_THREADS threads compute in parallel without ever blocking. With
+ *    the Fifo policy, the process gets NB_THREADS times the CPU of a
+ *    single-threaded one. With
+ *
+ *      TimeSharing      = 1
+ *      SchedulingPolicy = FairShare
+ *
+ *    it only gets the share given by its weight, so that the shell or
+ *    other programs started at the same time keep their own. Compare
+ *    the "CPU share" lines printed at the end of the run.
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+// Nachos system calls
+#include "userlib/syscall.h"
+#include "userlib/libnachos.h"
+
+#define NB_THREADS 8
+#define NB_LOOPS   20000
+
+int results[NB_THREADS];
+int next_id = 0;
+
+void worker()
+{
+  int id = next_id++;
+  int i, sum = 0;
+
+  for (i = 0; i < NB_LOOPS; i++)
+    sum += i % 7;
+  results[id] = sum;
+}
+
+int main()
+{
+  ThreadId th[NB_THREADS];
+  int i;
+
+  for (i = 0; i < NB_THREADS; i++)
+    th[i] = threadCreate("batch worker", &worker);
+  for (i = 0; i < NB_THREADS; i++)
+    Join(th[i]);
+
+  for (i = 0; i < NB_THREADS; i++)
+    n_printf("batch: worker %d computed %d\n", i, results[i]);
+  return 0;
+}
@@ -0,0 +1,88 @@
+/* condbench.c
+ *    A benchmark of the condition variables, to check the wait morphing.
+ *
+ *    NB_WAITERS threads wait on a condition with a lock, and the main
+ *    thread wakes them all up with a broadcast, NB_ROUNDS times. Without
+ *    wait morphing, each woken up waiter runs only to block again on
+ *    the lock held by the others. With
+ *
+ *      WaitMorphing = 1
+ *
+ *    the waiters are moved to the lock at once, and each of them runs
+ *    once it gets the lock. Compare the "Context switches" lines printed
+ *    at the end of the run with WaitMorphing = 0 and 1.
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+// Nachos system calls
+#include "userlib/syscall.h"
+#include "userlib/libnachos.h"
+
+#define NB_WAITERS 8
+#define NB_ROUNDS  100
+
+LockId lock;
+CondId wake_up;       // signalled by the main thread at each generation
+CondId all_waiting;   // signalled when all the waiters are waiting
+int waiting = 0;
+int generation = 0;
+
+void waiter()
+{
+  int r;
+
+  LockAcquire(lock);
+  while (generation < NB_ROUNDS) {
+    r = generation;
+    if (++waiting == NB_WAITERS)
+      CondSignal(all_waiting);
+    while (generation == r)
+      CondWait(wake_up, lock);
+  }
+  LockRelease(lock);
+}
+
+int main()
+{
+  ThreadId th[NB_WAITERS];
+  int i;
+
+  lock = LockCreate("condbench lock");
+  wake_up = CondCreate("condbench wake up");
+  all_waiting = CondCreate("condbench all waiting");
+
+  for (i = 0; i < NB_WAITERS; i++)
+    th[i] = threadCreate("condbench waiter", &waiter);
+
+  LockAcquire(lock);
+  for (i = 0; i < NB_ROUNDS; i++) {
+    while (waiting < NB_WAITERS)
+      CondWait(all_waiting, lock);
+    waiting = 0;
+    generation++;
+    CondBroadcast(wake_up);
+  }
+  LockRelease(lock);
+
+  for (i = 0; i < NB_WAITERS; i++)
+    Join(th[i]);
+
+  CondDestroy(wake_up);
+  CondDestroy(all_waiting);
+  LockDestroy(lock);
+  n_printf("condbench: %d rounds with %d waiters\n", NB_ROUNDS, NB_WAITERS);
+  return 0;
+}
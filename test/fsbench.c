@@ -0,0 +1,367 @@
+/* fsbench.c
+ *    A benchmark suite for the file system, the yardstick for any change
+ *    to FileSystem, OpenFile, Directory or the disk driver.
+ *
+ *    Runs in turn:
+ *    - create, stat (open and close) and remove storms, with all the
+ *      files in one directory, then spread over NB_DIRS directories,
+ *    - sequential and random writes and reads of a FILE_SIZE file,
+ *      with records of 16, 128 and 1024 bytes,
+ *    - an append-only log, reopened for each record,
+ *    - a mixed workload of NB_WORKERS threads creating, writing,
+ *      reading back and removing their own files.
+ *
+ *    For each benchmark, the driver prints the number of operations, the
+ *    operations per second and MB/s of simulated time, and the disk
+ *    reads and writes per operation of the process (see GetStats).
+ *    The files are created in the /fsb directory, which must not exist.
+ *    The disk seeks of the whole run are given by the statistics printed
+ *    at exit, to compare layouts (see the Defragment option).
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+// Nachos system calls
+#include "userlib/syscall.h"
+#include "userlib/libnachos.h"
+
+#define NB_FILES    24     // files of the metadata storms
+#define NB_DIRS     4      // directories of the spread storms
+#define FILE_SIZE   8192   // size of the file of the read/write benchmarks
+#define MAX_RECORD  1024
+#define LOG_RECORDS 64
+#define LOG_RECORD  100
+#define NB_WORKERS  4
+#define NB_ROUNDS   4
+#define WORKER_SIZE 2048
+
+typedef struct {
+  char *name;
+  int (*run)(int);   // returns the number of operations
+  int param;
+} Benchmark;
+
+char buffer[MAX_RECORD];
+unsigned long bytes;      // bytes read or written by the current benchmark
+unsigned long seed = 1;   // pseudo-random record numbers
+int failures = 0;
+
+int next_random(int n)
+{
+  seed = seed * 1103515245 + 12345;
+  return (int) ((seed >> 16) % n);
+}
+
+// Name of the file i of a storm spread over nb_dirs directories
+void file_name(char *name, int i, int nb_dirs)
+{
+  n_snprintf(name, 64, "/fsb/d%d/f%d", i % nb_dirs, i);
+}
+
+void check(int ok, char *what)
+{
+  if (!ok) {
+    failures++;
+    PError(what);
+  }
+}
+
+//----------------------------------------------------------------------
+// Metadata storms
+//----------------------------------------------------------------------
+
+int create_storm(int nb_dirs)
+{
+  char name[64];
+  int i;
+
+  for (i = 0; i < nb_dirs; i++) {
+    n_snprintf(name, 64, "/fsb/d%d", i);
+    check(Mkdir(name) >= 0, "fsbench: mkdir");
+  }
+  for (i = 0; i < NB_FILES; i++) {
+    file_name(name, i, nb_dirs);
+    check(Create(name, 0) >= 0, "fsbench: create");
+  }
+  return NB_FILES;
+}
+
+int stat_storm(int nb_dirs)
+{
+  char name[64];
+  OpenFileId f;
+  int i;
+
+  for (i = 0; i < NB_FILES; i++) {
+    file_name(name, i, nb_dirs);
+    f = Open(name);
+    check(f != 0, "fsbench: open");
+    if (f != 0)
+      Close(f);
+  }
+  return NB_FILES;
+}
+
+int remove_storm(int nb_dirs)
+{
+  char name[64];
+  int i;
+
+  for (i = 0; i < NB_FILES; i++) {
+    file_name(name, i, nb_dirs);
+    check(Remove(name) >= 0, "fsbench: remove");
+  }
+  for (i = 0; i < nb_dirs; i++) {
+    n_snprintf(name, 64, "/fsb/d%d", i);
+    check(Rmdir(name) >= 0, "fsbench: rmdir");
+  }
+  return NB_FILES;
+}
+
+//----------------------------------------------------------------------
+// Data transfers on /fsb/data, with records of "size" bytes
+//----------------------------------------------------------------------
+
+OpenFileId open_data()
+{
+  OpenFileId f = Open("/fsb/data");
+
+  check(f != 0, "fsbench: open /fsb/data");
+  return f;
+}
+
+int seq_write(int size)
+{
+  OpenFileId f;
+  int i;
+
+  Remove("/fsb/data");
+  check(Create("/fsb/data", 0) >= 0, "fsbench: create /fsb/data");
+  if ((f = open_data()) == 0)
+    return 0;
+  for (i = 0; i < FILE_SIZE / size; i++)
+    bytes += Write(buffer, size, f);
+  Close(f);
+  return FILE_SIZE / size;
+}
+
+int seq_read(int size)
+{
+  OpenFileId f;
+  int i;
+
+  if ((f = open_data()) == 0)
+    return 0;
+  for (i = 0; i < FILE_SIZE / size; i++)
+    bytes += Read(buffer, size, f);
+  Close(f);
+  return FILE_SIZE / size;
+}
+
+int random_write(int size)
+{
+  OpenFileId f;
+  int i;
+
+  if ((f = open_data()) == 0)
+    return 0;
+  for (i = 0; i < FILE_SIZE / size; i++) {
+    Seek(next_random(FILE_SIZE / size) * size, f);
+    bytes += Write(buffer, size, f);
+  }
+  Close(f);
+  return FILE_SIZE / size;
+}
+
+int random_read(int size)
+{
+  OpenFileId f;
+  int i;
+
+  if ((f = open_data()) == 0)
+    return 0;
+  for (i = 0; i < FILE_SIZE / size; i++) {
+    Seek(next_random(FILE_SIZE / size) * size, f);
+    bytes += Read(buffer, size, f);
+  }
+  Close(f);
+  return FILE_SIZE / size;
+}
+
+//----------------------------------------------------------------------
+// Append-only log: each record is appended after reopening the file
+//----------------------------------------------------------------------
+
+int append_log(int size)
+{
+  OpenFileId f;
+  int i;
+
+  check(Create("/fsb/log", 0) >= 0, "fsbench: create /fsb/log");
+  for (i = 0; i < LOG_RECORDS; i++) {
+    f = Open("/fsb/log");
+    check(f != 0, "fsbench: open /fsb/log");
+    if (f == 0)
+      break;
+    Seek(i * size, f);
+    bytes += Write(buffer, size, f);
+    Close(f);
+  }
+  Remove("/fsb/log");
+  return i;
+}
+
+//----------------------------------------------------------------------
+// Mixed workload: each worker creates, writes, reads back, stats and
+// removes its own file, NB_ROUNDS times
+//----------------------------------------------------------------------
+
+// Each worker counts its own operations and bytes, summed by mixed
+// once they have all finished
+LockId worker_lock;
+int next_worker;
+int worker_ops[NB_WORKERS];
+unsigned long worker_bytes[NB_WORKERS];
+
+void worker()
+{
+  char name[64];
+  char data[WORKER_SIZE / 4];
+  OpenFileId f;
+  int id, n, i;
+
+  LockAcquire(worker_lock);
+  id = next_worker++;
+  LockRelease(worker_lock);
+
+  n_snprintf(name, 64, "/fsb/w%d", id);
+  for (n = 0; n < NB_ROUNDS; n++) {
+    check(Create(name, 0) >= 0, "fsbench: create (worker)");
+    if ((f = Open(name)) == 0)
+      continue;
+    for (i = 0; i < 4; i++)
+      worker_bytes[id] += Write(data, WORKER_SIZE / 4, f);
+    Seek(0, f);
+    for (i = 0; i < 4; i++)
+      worker_bytes[id] += Read(data, WORKER_SIZE / 4, f);
+    Close(f);
+    if ((f = Open(name)) != 0)
+      Close(f);
+    check(Remove(name) >= 0, "fsbench: remove (worker)");
+    worker_ops[id] += 12;
+  }
+}
+
+int mixed(int nb_workers)
+{
+  ThreadId th[NB_WORKERS];
+  int i, ops = 0;
+
+  worker_lock = LockCreate("fsbench workers");
+  next_worker = 0;
+  for (i = 0; i < nb_workers; i++) {
+    worker_ops[i] = 0;
+    worker_bytes[i] = 0;
+  }
+  for (i = 0; i < nb_workers; i++)
+    th[i] = threadCreate("fsbench worker", &worker);
+  for (i = 0; i < nb_workers; i++)
+    Join(th[i]);
+  for (i = 0; i < nb_workers; i++) {
+    ops += worker_ops[i];
+    bytes += worker_bytes[i];
+  }
+  LockDestroy(worker_lock);
+  return ops;
+}
+
+//----------------------------------------------------------------------
+// Driver
+//----------------------------------------------------------------------
+
+Benchmark benchmarks[] = {
+    {"create 1 dir", create_storm, 1},
+    {"stat 1 dir", stat_storm, 1},
+    {"remove 1 dir", remove_storm, 1},
+    {"create 4 dirs", create_storm, NB_DIRS},
+    {"stat 4 dirs", stat_storm, NB_DIRS},
+    {"remove 4 dirs", remove_storm, NB_DIRS},
+    {"seq write 16", seq_write, 16},
+    {"seq read 16", seq_read, 16},
+    {"rand write 16", random_write, 16},
+    {"rand read 16", random_read, 16},
+    {"seq write 128", seq_write, 128},
+    {"seq read 128", seq_read, 128},
+    {"rand write 128", random_write, 128},
+    {"rand read 128", random_read, 128},
+    {"seq write 1024", seq_write, 1024},
+    {"seq read 1024", seq_read, 1024},
+    {"rand write 1024", random_write, 1024},
+    {"rand read 1024", random_read, 1024},
+    {"append log", append_log, LOG_RECORD},
+    {"mixed", mixed, NB_WORKERS},
+};
+
+#define NB_BENCHMARKS ((int) (sizeof(benchmarks) / sizeof(Benchmark)))
+
+// Print num / den with two decimals
+void print_ratio(unsigned long num, unsigned long den)
+{
+  unsigned long hundredths;
+
+  if (den == 0)
+    den = 1;
+  hundredths = (num * 100) / den;
+  n_printf("%d.%d%d", (int) (hundredths / 100), (int) ((hundredths / 10) % 10),
+           (int) (hundredths % 10));
+}
+
+int main()
+{
+  ProcessStats before, after;
+  unsigned long cycles;
+  int b, ops;
+
+  for (b = 0; b < MAX_RECORD; b++)
+    buffer[b] = 'a' + (b % 26);
+  check(Mkdir("/fsb") >= 0, "fsbench: mkdir /fsb");
+
+  n_printf("fsbench: benchmark\tops\tops/s\tMB/s\treads/op\twrites/op\n");
+  for (b = 0; b < NB_BENCHMARKS; b++) {
+    bytes = 0;
+    GetStats(0, &before);
+    ops = benchmarks[b].run(benchmarks[b].param);
+    GetStats(0, &after);
+
+    cycles = after.now - before.now;
+    if (cycles == 0)
+      cycles = 1;
+    n_printf("fsbench: %s\t%d\t%d\t", benchmarks[b].name, ops,
+             (int) ((ops * after.frequency * 1000000UL) / cycles));
+    // Bytes per microsecond are MB per second
+    print_ratio(bytes * after.frequency, cycles);
+    n_printf("\t");
+    print_ratio(after.disk_reads - before.disk_reads, ops);
+    n_printf("\t");
+    print_ratio(after.disk_writes - before.disk_writes, ops);
+    n_printf("\n");
+  }
+
+  Remove("/fsb/data");
+  Rmdir("/fsb");
+  if (failures > 0)
+    n_printf("fsbench: %d operations failed\n", failures);
+  return 0;
+}
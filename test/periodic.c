@@ -0,0 +1,118 @@
+/* periodic.c
+ *    Periodic real-time threads, to check the EDF scheduling class.
+ *
+ *    Two periodic threads, a fast sampling loop and a slower protocol
+ *    handler with a deadline shorter than its period, run NB_JOBS jobs
+ *    each, while a background thread computes without stopping. Each
+ *    periodic thread prints the worst response time of its jobs, which
+ *    must stay within its deadline. A third periodic thread, asking for
+ *    more CPU than is left, must be rejected by the admission control.
+ *    The deadline misses and budget overruns are in the statistics
+ *    printed at exit.
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+// Nachos system calls
+#include "userlib/syscall.h"
+#include "userlib/libnachos.h"
+
+#define NB_JOBS 20
+
+typedef struct {
+  char *name;
+  int period;     // microseconds
+  int budget;     // microseconds
+  int deadline;   // microseconds, 0 for the end of the period
+  int work;       // iterations of each job
+} Task;
+
+Task tasks[2] = {
+    {"sampler", 2000, 400, 0, 100},
+    {"handler", 5000, 1500, 4000, 400},
+};
+
+int next_task = 0;
+int running = 2;
+unsigned long background_loops = 0;
+
+int compute(int n)
+{
+  int i, x = 0;
+
+  for (i = 0; i < n; i++)
+    x = x * 31 + i;
+  return x;
+}
+
+void periodic()
+{
+  Task *t = &tasks[next_task++];
+  ProcessStats st;
+  unsigned long release, response, worst = 0;
+  int job;
+
+  if (SetPeriodic(t->period, t->budget, t->deadline) < 0) {
+    PError("periodic: SetPeriodic");
+    running--;
+    return;
+  }
+  GetStats(0, &st);
+  release = st.now;
+  for (job = 0; job < NB_JOBS; job++) {
+    compute(t->work);
+    GetStats(0, &st);
+    response = (st.now - release) / st.frequency;
+    if (response > worst)
+      worst = response;
+    WaitPeriod();
+    release += t->period * st.frequency;
+  }
+  n_printf("periodic: %s, worst response %d us, deadline %d us\n", t->name,
+           (int) worst, t->deadline ? t->deadline : t->period);
+  running--;
+}
+
+void background()
+{
+  while (running > 0) {
+    compute(100);
+    background_loops++;
+    Yield();   // without time sharing
+  }
+}
+
+int main()
+{
+  ThreadId th[3];
+  int i;
+
+  th[0] = threadCreate("background", &background);
+  th[1] = threadCreate("sampler", &periodic);
+  th[2] = threadCreate("handler", &periodic);
+
+  // The two threads above reserve 20% and 37.5% of the CPU: this one
+  // would need 50% more
+  Yield();
+  if (SetPeriodic(1000, 500, 0) >= 0)
+    n_printf("periodic: admission control failed\n");
+  else
+    PError("periodic: rejected as expected");
+
+  for (i = 0; i < 3; i++)
+    Join(th[i]);
+  n_printf("periodic: %d background loops\n", (int) background_loops);
+  return 0;
+}
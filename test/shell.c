@@ -41,8 +41,9 @@ main()
       // Write the prompt
       Write(prompt, 2, output);
  
-      // Wait for a command
-      Read(buffer, 60, input); 
+      // Wait for a command, stop at the end of the input
+      if (Read(buffer, 60, input) == 0)
+        break;
       
 	i=0;
 	bg=0;
@@ -66,6 +67,19 @@ main()
 	if (n_strcmp(buffer,"exit")==0) {
 	    break;
 	  }
+
+	// Print a file, copied to the console by the kernel
+	if (n_memcmp(buffer,"cat ",4)==0) {
+	  OpenFileId f = Open(buffer+4);
+	  if (f == -1) {
+	    n_printf("\nUnable to open %s\n", buffer+4);
+	  }
+	  else {
+	    while (SendFile(f, output, 1024) > 0) {};
+	    Close(f);
+	  }
+	  continue;
+	}
 	    
 	// Execute the command
 	// In the case it is a background command, don't wait for its completion
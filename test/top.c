@@ -0,0 +1,69 @@
+/* top.c
+ *    A process monitor, to check the GetStats system call.
+ *
+ *    Start the programs given in the progs array in the background,
+ *    then print every PERIOD milliseconds the CPU share, page faults,
+ *    and disk and console I/O of each of them since the last report,
+ *    until they have all finished.
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+// Nachos system calls
+#include "userlib/syscall.h"
+#include "userlib/libnachos.h"
+
+#define NB_PROGS 2
+#define PERIOD   1   // milliseconds of simulated time
+
+char *progs[NB_PROGS] = {"/matmult", "/sort"};
+
+int main()
+{
+  ThreadId th[NB_PROGS];
+  ProcessStats last[NB_PROGS], cur;
+  unsigned long ids[1];
+  int i, running;
+
+  for (i = 0; i < NB_PROGS; i++) {
+    th[i] = Exec(progs[i]);
+    GetStats(th[i], &last[i]);
+  }
+
+  // Nobody posts on this semaphore: WaitAny only returns on timeout
+  ids[0] = SemCreate("top sleep", 0);
+
+  do {
+    WaitAny(ids, 1, PERIOD);
+    running = 0;
+    n_printf("top: program\tcpu%%\tfaults\tdreads\tdwrites\tchars\n");
+    for (i = 0; i < NB_PROGS; i++) {
+      if (GetStats(th[i], &cur) < 0)
+        continue;   // finished
+      running++;
+      n_printf("top: %s\t%d\t%d\t%d\t%d\t%d\n", progs[i],
+               (int) (((cur.cpu_time - last[i].cpu_time) * 100) /
+                      (cur.now - last[i].now)),
+               (int) (cur.page_faults - last[i].page_faults),
+               (int) (cur.disk_reads - last[i].disk_reads),
+               (int) (cur.disk_writes - last[i].disk_writes),
+               (int) (cur.console_writes - last[i].console_writes));
+      n_memcpy(&last[i], &cur, sizeof(cur));
+    }
+  } while (running > 0);
+
+  SemDestroy(ids[0]);
+  return 0;
+}
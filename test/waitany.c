@@ -0,0 +1,77 @@
+/* waitany.c
+ *    An event-driven loop, to check the WaitAny system call.
+ *
+ *    A single thread waits at the same time for the lines typed on the
+ *    console and for the events posted on a semaphore by a worker
+ *    thread, with a timeout. It never polls: it is only woken up when
+ *    one of them is ready, or when nothing happened for TIMEOUT
+ *    milliseconds.
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+// Nachos system calls
+#include "userlib/syscall.h"
+#include "userlib/libnachos.h"
+
+#define NB_EVENTS   5
+#define NB_TIMEOUTS 3
+#define TIMEOUT     1
+#define NB_LOOPS    10000
+
+SemId events;
+
+void worker()
+{
+  int e, i, sum = 0;
+
+  for (e = 0; e < NB_EVENTS; e++) {
+    for (i = 0; i < NB_LOOPS; i++)
+      sum += i % 7;
+    V(events);
+  }
+}
+
+int main()
+{
+  unsigned long ids[2];
+  char line[80];
+  int nb_events = 0, nb_timeouts = 0;
+  int r;
+  ThreadId th;
+
+  events = SemCreate("events", 0);
+  ids[0] = CONSOLE_INPUT;
+  ids[1] = events;
+  th = threadCreate("waitany worker", &worker);
+
+  while ((nb_events < NB_EVENTS) || (nb_timeouts < NB_TIMEOUTS)) {
+    r = WaitAny(ids, 2, TIMEOUT);
+    if (r == 0) {
+      Read(line, 80, CONSOLE_INPUT);
+      n_printf("waitany: console line %s", line);
+    } else if (r == 1) {
+      nb_events++;
+      n_printf("waitany: event %d\n", nb_events);
+    } else {
+      nb_timeouts++;
+      n_printf("waitany: timeout %d\n", nb_timeouts);
+    }
+  }
+
+  Join(th);
+  SemDestroy(events);
+  return 0;
+}
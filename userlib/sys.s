@@ -341,3 +341,66 @@ Debug:
 	jr ra
 
 	
+
+	.globl SetWeight
+	.type	__SetWeight, @function
+SetWeight:
+	addi a7,zero,SC_SET_WEIGHT
+	ecall
+	jr ra
+
+	.globl SendFile
+	.type	__SendFile, @function
+SendFile:
+	addi a7,zero,SC_SEND_FILE
+	ecall
+	jr ra
+
+	.globl BarrierCreate
+	.type	__BarrierCreate, @function
+BarrierCreate:
+	addi a7,zero,SC_BARRIER_CREATE
+	ecall
+	jr ra
+
+	.globl BarrierWait
+	.type	__BarrierWait, @function
+BarrierWait:
+	addi a7,zero,SC_BARRIER_WAIT
+	ecall
+	jr ra
+
+	.globl BarrierDestroy
+	.type	__BarrierDestroy, @function
+BarrierDestroy:
+	addi a7,zero,SC_BARRIER_DESTROY
+	ecall
+	jr ra
+
+	.globl WaitAny
+	.type	__WaitAny, @function
+WaitAny:
+	addi a7,zero,SC_WAIT_ANY
+	ecall
+	jr ra
+
+	.globl GetStats
+	.type	__GetStats, @function
+GetStats:
+	addi a7,zero,SC_GET_STATS
+	ecall
+	jr ra
+
+	.globl SetPeriodic
+	.type	__SetPeriodic, @function
+SetPeriodic:
+	addi a7,zero,SC_SET_PERIODIC
+	ecall
+	jr ra
+
+	.globl WaitPeriod
+	.type	__WaitPeriod, @function
+WaitPeriod:
+	addi a7,zero,SC_WAIT_PERIOD
+	ecall
+	jr ra
@@ -72,6 +72,15 @@
 #define SC_SYS_TIME       32
 #define SC_MMAP           33
 #define SC_DEBUG          34
+#define SC_SET_WEIGHT     35
+#define SC_SEND_FILE      36
+#define SC_BARRIER_CREATE  37
+#define SC_BARRIER_WAIT    38
+#define SC_BARRIER_DESTROY 39
+#define SC_WAIT_ANY        40
+#define SC_GET_STATS       41
+#define SC_SET_PERIODIC    42
+#define SC_WAIT_PERIOD     43
 
 #ifndef IN_ASM
 
@@ -121,6 +130,62 @@ t_error Join(ThreadId id);
  */
 void Yield();
 
+/* Set the weight of the current process (1024 by default). With the
+ * fair-share scheduling policy, the processes get the CPU in proportion
+ * of their weight, whatever their number of threads.
+ * Return a negative number if an error ocurred.
+ */
+t_error SetWeight(int weight);
+
+/* Make the calling thread a periodic real-time task: it runs a job every
+ * "period" microseconds, each job using at most "budget" microseconds of
+ * CPU and being due "deadline" microseconds after the start of its
+ * period (at the end of the period if deadline is 0). The periodic
+ * threads run before the others, the one with the earliest deadline
+ * first. A job using more than its budget goes on with the other threads
+ * until the next period. A period of 0 makes the thread a normal one
+ * again.
+ * Return a negative number if the parameters are invalid, or if the
+ * periodic threads would need more than the whole CPU.
+ */
+t_error SetPeriodic(int period, int budget, int deadline);
+
+/* End the current job of the calling periodic thread, and wait for the
+ * start of its next period.
+ * Return a negative number if the thread is not periodic.
+ */
+t_error WaitPeriod();
+
+/* Statistics of a process or a thread, filled by GetStats. The times
+ * are in cycles of the simulated processor.
+ */
+typedef struct {
+  unsigned long now;               /* current time of the machine */
+  unsigned long instructions;      /* instructions executed */
+  unsigned long user_time;         /* time spent executing user code */
+  unsigned long system_time;       /* time spent executing kernel code */
+  unsigned long cpu_time;          /* time it was running */
+  unsigned long fair_time;         /* time it should have been running
+                                      (fair-share policy, 0 otherwise) */
+  unsigned long weight;            /* weight of the process (SetWeight) */
+  unsigned long memory_accesses;   /* memory accesses */
+  unsigned long page_faults;       /* virtual memory page faults */
+  unsigned long disk_reads;        /* disk read requests */
+  unsigned long disk_writes;       /* disk write requests */
+  unsigned long console_reads;     /* characters read from the console */
+  unsigned long console_writes;    /* characters written to the console */
+  unsigned long frequency;         /* processor frequency (MHz), to turn
+                                      the times into microseconds */
+} ProcessStats;
+
+/* Fill "stats" with the current statistics of the calling process when
+ * "id" is 0, or else of the thread "id": its instructions, user, system
+ * and CPU time and disk requests. The other fields, only counted per
+ * process, are those of the process of the thread.
+ * Return a negative number if an error ocurred.
+ */
+t_error GetStats(ThreadId id, ProcessStats *stats);
+
 /*! Print the last error message with the personalized one "mess" */
 void PError(char *mess);
 
@@ -166,6 +231,15 @@ t_error Read(char *buffer, int size, OpenFileId id);
 /* Seek to a specified offset into an opened file */
 t_error Seek(int offset, OpenFileId id);
 
+/* Copy at most "size" bytes from the open file "in" to the open file
+ * "out", or to the console when "out" is CONSOLE_OUTPUT. The data is
+ * moved inside the kernel and never goes through the memory of the
+ * program. The positions of both files are advanced.
+ * Return the number of bytes actually copied, which is smaller than
+ * "size" at the end of "in", or a negative number if an error ocurred.
+ */
+t_error SendFile(OpenFileId in, OpenFileId out, int size);
+
 #ifndef SYSDEP_H
 /* Close the file, we're done reading and writing to it. */
 t_error Close(OpenFileId id);
@@ -203,7 +277,8 @@ typedef unsigned long SemId;
 SemId SemCreate(char *debug_name, int count);
 
 /* Destroy a semaphore identified by sema.
-   Return a negative number if an error occured during the destruction */
+   Return a negative number if an error occured during the destruction,
+   or if threads are still waiting for the semaphore (P or WaitAny) */
 t_error SemDestroy(SemId sema);
 
 /* Do the operation P() on the semaphore sema */
@@ -221,7 +296,8 @@ LockId LockCreate(char *debug_name);
 
 /* Destroy a lock.
    Return a negative number if an error ocurred
-   during the destruction. */
+   during the destruction, or if threads are still waiting for the
+   lock (LockAcquire or WaitAny). */
 t_error LockDestroy(LockId id);
 
 /* Do the operation Acquire on the lock id.
@@ -244,10 +320,12 @@ CondId CondCreate(char *debug_name);
 */
 t_error CondDestroy(CondId id);
 
-/* Do the operation Wait on a condition variable.
+/* Do the operation Wait on a condition variable: release the lock,
+   which must be held, wait until the condition is signalled and
+   acquire the lock again before returning.
    Returns a negative number if an error ocurred.
 */
-t_error CondWait(CondId cond);
+t_error CondWait(CondId cond, LockId lock);
 
 /* Do the operation Signal on a condition variable (wake up only one thread).
    Return a negative number if an error ocurred.
@@ -259,6 +337,48 @@ t_error CondSignal(CondId cond);
 */
 t_error CondBroadcast(CondId cond);
 
+/* System calls concerning barriers. */
+typedef unsigned long BarrierId;
+
+/* Create a new barrier for nb_threads threads.
+   Return a negative number if an error ocurred.
+*/
+BarrierId BarrierCreate(char *debug_name, int nb_threads);
+
+/* Destroy a barrier.
+   Return a negative number if an error ocurred, or if threads are
+   still waiting at the barrier.
+*/
+t_error BarrierDestroy(BarrierId id);
+
+/* Wait until nb_threads threads have called BarrierWait, all of them
+   being released at once by the last one.
+   Return a negative number if an error ocurred.
+*/
+t_error BarrierWait(BarrierId id);
+
+/* System call waiting for several objects. */
+
+/* Identifier of the ACIA reception for WaitAny (see CONSOLE_INPUT) */
+#define ACIA_INPUT 2
+
+/* Maximum number of objects given to WaitAny */
+#define MAX_WAIT_OBJECTS 64
+
+/* Wait until one of the nb objects whose identifiers are in ids is
+   ready, or until timeout milliseconds have elapsed (forever when
+   timeout is negative, no wait when it is 0). The objects may be
+   semaphores, locks, open files, CONSOLE_INPUT or ACIA_INPUT:
+   - a semaphore is ready when P would not block, and P is done,
+   - a lock is ready when it is free, and it is acquired,
+   - the console and the ACIA are ready when a Read or a TtyReceive
+     would not block, nothing is read,
+   - a file is always ready.
+   Return the index in ids of the ready object, or a negative number if
+   an error occurred or the timeout expired.
+*/
+int WaitAny(unsigned long *ids, int nb, int timeout);
+
 /******************************************************************/
 /* System calls concerning serial port and console */
 
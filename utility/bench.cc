@@ -0,0 +1,328 @@
+/*! \file bench.cc
+//  \brief Host micro-benchmarks of the kernel data structures
+//
+//  A host program (make bench), not part of the kernel, that drives
+//  the containers the kernel relies on the most: List (ready list,
+//  waiting queues), the PendingInterrupt queue, BitMap (free sectors
+//  and frames) and ObjAddr (system call object ids). Each benchmark
+//  runs at a realistic size and at a scaled one, checks its results,
+//  and prints the host time and the heap allocations per operation,
+//  so that replacing one of these structures can be backed by numbers
+//  rather than by whole simulations.
+
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#include <new>
+
+#include "machine/disk.h"
+#include "machine/interrupt.h"
+#include "utility/bitmap.h"
+#include "utility/list.h"
+#include "utility/objaddr.h"
+#include "utility/utility.h"
+
+//! Minimum host time of a benchmark, to smooth out the clock resolution
+#define MIN_NANOS 50000000
+
+//! Heap allocations made since the start of the program
+static uint64_t numAllocs = 0;
+
+// Count the allocations of the whole program, the kernel structures
+// included
+void *
+operator new(size_t size) {
+  void *ptr = malloc(size == 0 ? 1 : size);
+
+  if (ptr == NULL)
+    throw std::bad_alloc();
+  numAllocs++;
+  return ptr;
+}
+
+void *
+operator new[](size_t size) {
+  return operator new(size);
+}
+
+void
+operator delete(void *ptr) noexcept {
+  free(ptr);
+}
+
+void
+operator delete[](void *ptr) noexcept {
+  free(ptr);
+}
+
+void
+operator delete(void *ptr, size_t) noexcept {
+  free(ptr);
+}
+
+void
+operator delete[](void *ptr, size_t) noexcept {
+  free(ptr);
+}
+
+//! A benchmark: runs once on "size" elements, returns its operations
+typedef int (*BenchFunction)(int size);
+
+typedef struct {
+  const char *name;
+  BenchFunction run;
+  int size;
+} Benchmark;
+
+// Items put on the lists: only their addresses matter
+static char items[65536];
+
+//----------------------------------------------------------------------
+// ListFifo
+/*!	Append "size" items to a list and remove them from the front, as
+//	the ready list and the waiting queues of the semaphores do.
+*/
+//----------------------------------------------------------------------
+static int
+ListFifo(int size) {
+  List<int> list;
+  int i;
+
+  for (i = 0; i < size; i++)
+    list.Append(&items[i]);
+  for (i = 0; i < size; i++)
+    ASSERT(list.Remove() == &items[i]);
+  ASSERT(list.IsEmpty());
+  return 2 * size;
+}
+
+//----------------------------------------------------------------------
+// ListSorted
+/*!	Insert "size" items with random keys in a sorted list, then
+//	remove them all, checking that they come out in key order.
+*/
+//----------------------------------------------------------------------
+static int
+ListSorted(int size) {
+  ListTime list;
+  Time key, prev = 0;
+  int i;
+
+  for (i = 0; i < size; i++)
+    list.SortedInsert(&items[i], Random() % (8 * size));
+  for (i = 0; i < size; i++) {
+    ASSERT(list.SortedRemove(&key) != NULL);
+    ASSERT(key >= prev);
+    prev = key;
+  }
+  ASSERT(list.IsEmpty());
+  return 2 * size;
+}
+
+//----------------------------------------------------------------------
+// ListSearchRemove
+/*!	Fill a list with "size" items, then look up each of them and
+//	remove it from the list, in a scattered order.
+*/
+//----------------------------------------------------------------------
+static int
+ListSearchRemove(int size) {
+  List<int> list;
+  int i, which;
+
+  for (i = 0; i < size; i++)
+    list.Append(&items[i]);
+  // Stride through the items, size being a power of two
+  for (i = 0; i < size; i++) {
+    which = (i * 7) & (size - 1);
+    ASSERT(list.Search(&items[which]));
+    list.RemoveItem(&items[which]);
+  }
+  ASSERT(list.IsEmpty());
+  return 2 * size;
+}
+
+//----------------------------------------------------------------------
+// PendingQueue
+/*!	Keep "size" interrupts pending and, as Interrupt::OneTick does,
+//	repeatedly take the earliest one and schedule a new one a bit
+//	later, checking that the time never goes backwards.
+*/
+//----------------------------------------------------------------------
+static int
+PendingQueue(int size) {
+  ListTime pending;
+  PendingInterrupt *toOccur;
+  Time when, now = 0;
+  int i;
+
+  for (i = 0; i < size; i++) {
+    when = Random() % 1000;
+    pending.SortedInsert(new PendingInterrupt(NULL, 0, when, TIMER_INT), when);
+  }
+  for (i = 0; i < 4096; i++) {
+    toOccur = (PendingInterrupt *) pending.SortedRemove(&when);
+    ASSERT(toOccur != NULL && when >= now && toOccur->when == when);
+    now = when;
+    delete toOccur;
+    when = now + 1 + Random() % 1000;
+    pending.SortedInsert(new PendingInterrupt(NULL, 0, when, DISK_INT), when);
+  }
+  while (!pending.IsEmpty())
+    delete (PendingInterrupt *) pending.Remove();
+  return 4096;
+}
+
+//----------------------------------------------------------------------
+// BitMapFind
+/*!	Free and allocate again random bits of a full "size" bits map,
+//	as the frame and sector allocators do once the memory or the
+//	disk is full.
+*/
+//----------------------------------------------------------------------
+static int
+BitMapFind(int size) {
+  BitMap map(size);
+  int i, which;
+
+  for (i = 0; i < size; i++)
+    map.Mark(i);
+  ASSERT(map.Find() == -1);
+  for (i = 0; i < 256; i++) {
+    which = Random() % size;
+    map.Clear(which);
+    ASSERT(map.Find() == which);
+  }
+  return 256;
+}
+
+//----------------------------------------------------------------------
+// BitMapCount
+/*!	Count the clear bits of a half-full "size" bits map, as the file
+//	system does before each allocation.
+*/
+//----------------------------------------------------------------------
+static int
+BitMapCount(int size) {
+  BitMap map(size);
+  int i;
+
+  for (i = 0; i < size; i += 2)
+    map.Mark(i);
+  for (i = 0; i < 64; i++)
+    ASSERT(map.NumClear() == size / 2);
+  return 64;
+}
+
+//----------------------------------------------------------------------
+// ObjAddrChurn
+/*!	Keep "size" objects registered and, as a program creating and
+//	destroying semaphores does, repeatedly register a new object,
+//	look it up and remove the oldest one by id.
+*/
+//----------------------------------------------------------------------
+static int
+ObjAddrChurn(int size) {
+  ObjAddr objs;
+  int32_t first, id;
+  int i;
+
+  first = objs.AddObject(&items[0]);
+  for (i = 1; i < size; i++)
+    objs.AddObject(&items[i]);
+  for (i = 0; i < 4096; i++) {
+    id = objs.AddObject(&items[(size + i) & 0xffff]);
+    ASSERT(objs.SearchObject(id) == &items[(size + i) & 0xffff]);
+    objs.RemoveObject(first + i);
+    ASSERT(objs.SearchObject(first + i) == NULL);
+  }
+  return 3 * 4096;
+}
+
+//----------------------------------------------------------------------
+// ObjAddrRemovePtr
+/*!	Register "size" objects, then remove them by address, as the
+//	destruction of an object does.
+*/
+//----------------------------------------------------------------------
+static int
+ObjAddrRemovePtr(int size) {
+  ObjAddr objs;
+  int32_t first;
+  int i;
+
+  first = objs.AddObject(&items[0]);
+  for (i = 1; i < size; i++)
+    objs.AddObject(&items[i]);
+  for (i = size - 1; i >= 0; i--)
+    objs.RemoveObject(&items[i]);
+  for (i = 0; i < size; i++)
+    ASSERT(objs.SearchObject(first + i) == NULL);
+  return size;
+}
+
+// Realistic sizes first (a few threads, NumPhysPages frames, the
+// sectors of the disk), then scaled ones
+static Benchmark benchmarks[] = {
+    {"List append/remove", ListFifo, 8},
+    {"List append/remove", ListFifo, 1024},
+    {"List sorted insert/remove", ListSorted, 8},
+    {"List sorted insert/remove", ListSorted, 1024},
+    {"List search/remove item", ListSearchRemove, 8},
+    {"List search/remove item", ListSearchRemove, 1024},
+    {"PendingInterrupt queue", PendingQueue, 4},
+    {"PendingInterrupt queue", PendingQueue, 256},
+    {"BitMap find", BitMapFind, 400},
+    {"BitMap find", BitMapFind, NUM_SECTORS},
+    {"BitMap find", BitMapFind, 65536},
+    {"BitMap count", BitMapCount, NUM_SECTORS},
+    {"BitMap count", BitMapCount, 65536},
+    {"ObjAddr churn", ObjAddrChurn, 16},
+    {"ObjAddr churn", ObjAddrChurn, 4096},
+    {"ObjAddr remove by address", ObjAddrRemovePtr, 16},
+    {"ObjAddr remove by address", ObjAddrRemovePtr, 4096},
+};
+
+#define NB_BENCHMARKS ((int) (sizeof(benchmarks) / sizeof(Benchmark)))
+
+//----------------------------------------------------------------------
+// main
+/*!	Run each benchmark until it has lasted MIN_NANOS, and print its
+//	host time and allocations per operation.
+*/
+//----------------------------------------------------------------------
+int
+main(int argc, char **argv) {
+  uint64_t start, elapsed, allocs, ops;
+  int b;
+
+  RandomInit(1);
+  printf("%-28s %8s %12s %12s\n", "benchmark", "size", "ns/op", "allocs/op");
+  for (b = 0; b < NB_BENCHMARKS; b++) {
+    ops = 0;
+    allocs = numAllocs;
+    start = HostNanos();
+    do {
+      ops += benchmarks[b].run(benchmarks[b].size);
+      elapsed = HostNanos() - start;
+    } while (elapsed < MIN_NANOS);
+    allocs = numAllocs - allocs;
+
+    printf("%-28s %8d %12.1f %12.2f\n", benchmarks[b].name,
+           benchmarks[b].size, (double) elapsed / ops, (double) allocs / ops);
+  }
+  return 0;
+}
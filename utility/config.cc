@@ -49,6 +49,9 @@ Config::Config(char *configname) {
   SectorSize = 128;
   PageSize = 128;
   NumPhysPages = 20;
+  HugePages = false;
+  SuperPageSize = 1;
+  ZeroPoolSize = 0;
   MaxVirtPages = 1024;
   UserStackSize = 8 * 1024;
   ProcessorFrequency = 100;
@@ -57,8 +60,10 @@ Config::Config(char *configname) {
   NumDirEntries = 10;
   NumPortLoc = 32009;
   NumPortDist = 32009;
+  NumDataDisks = 1;
   PrintStat = false;
   FormatDisk = false;
+  Defragment = false;
   ListDir = false;
   PrintFileSyst = false;
   Print = false;
@@ -66,6 +71,19 @@ Config::Config(char *configname) {
   MakeDir = false;
   RemoveDir = false;
   ACIA = ACIA_NONE;
+  DiskOverlay = OVERLAY_NONE;
+  TimeSharing = false;
+  SchedPolicy = POLICY_FIFO;
+  SchedAffinity = 0;
+  WaitMorphing = false;
+  SkipSpinLoops = false;
+  DiskType = DISK_ROTATING;
+  SwapDiskType = DISK_ROTATING;
+  FlashChannels = 4;
+  FlashDiesPerChannel = 2;
+  FlashPagesPerBlock = 32;
+  FlashOverProvision = 10;
+  FlashQueueDepth = 8;
   strcpy(ProgramToRun, "");
 
   uint32_t nblignes = 0;
@@ -104,6 +122,32 @@ Config::Config(char *configname) {
           continue;
         }
 
+        if (strcmp(commande, "HugePages") == 0) {
+          uint32_t v;
+          if (sscanf(ligne, " %s = %" PRIu32 " ", commande, &v) == 2) {
+            if (v == 0)
+              HugePages = false;
+            else
+              HugePages = true;
+          } else
+            fail(nblignes, configname, ligne);
+          continue;
+        }
+
+        if (strcmp(commande, "SuperPageSize") == 0) {
+          if (sscanf(ligne, " %s = %" PRIu64 " ", commande, &SuperPageSize) !=
+              2)
+            fail(nblignes, configname, ligne);
+          continue;
+        }
+
+        if (strcmp(commande, "ZeroPoolSize") == 0) {
+          if (sscanf(ligne, " %s = %" PRIu64 " ", commande, &ZeroPoolSize) !=
+              2)
+            fail(nblignes, configname, ligne);
+          continue;
+        }
+
         if (strcmp(commande, "NumPhysPages") == 0) {
           if (sscanf(ligne, " %s = %" PRIu64 " ", commande, &NumPhysPages) != 2)
             fail(nblignes, configname, ligne);
@@ -163,6 +207,63 @@ Config::Config(char *configname) {
           continue;
         }
 
+        if (strcmp(commande, "TimeSharing") == 0) {
+          uint32_t v;
+          if (sscanf(ligne, " %s = %" PRIu32 " ", commande, &v) == 2) {
+            if (v == 0)
+              TimeSharing = false;
+            else
+              TimeSharing = true;
+          } else
+            fail(nblignes, configname, ligne);
+          continue;
+        }
+
+        if (strcmp(commande, "WaitMorphing") == 0) {
+          uint32_t v;
+          if (sscanf(ligne, " %s = %" PRIu32 " ", commande, &v) == 2) {
+            if (v == 0)
+              WaitMorphing = false;
+            else
+              WaitMorphing = true;
+          } else
+            fail(nblignes, configname, ligne);
+          continue;
+        }
+
+        if (strcmp(commande, "SkipSpinLoops") == 0) {
+          uint32_t v;
+          if (sscanf(ligne, " %s = %" PRIu32 " ", commande, &v) == 2) {
+            if (v == 0)
+              SkipSpinLoops = false;
+            else
+              SkipSpinLoops = true;
+          } else
+            fail(nblignes, configname, ligne);
+          continue;
+        }
+
+        if (strcmp(commande, "SchedAffinity") == 0) {
+          if (sscanf(ligne, " %s = %" PRIu32 " ", commande, &SchedAffinity) !=
+              2)
+            fail(nblignes, configname, ligne);
+          continue;
+        }
+
+        if (strcmp(commande, "SchedulingPolicy") == 0) {
+          char policy[MAXSTRLEN];
+          if (sscanf(ligne, " %s = %s ", commande, policy) == 2) {
+            if (strcmp(policy, "Fifo") == 0)
+              SchedPolicy = POLICY_FIFO;
+            else if (strcmp(policy, "FairShare") == 0)
+              SchedPolicy = POLICY_FAIR_SHARE;
+            else
+              fail(nblignes, configname, ligne);
+          } else
+            fail(nblignes, configname, ligne);
+          continue;
+        }
+
         if (strcmp(commande, "FormatDisk") == 0) {
           uint32_t v;
           if (sscanf(ligne, " %s = %" PRIu32 " ", commande, &v) == 2) {
@@ -175,6 +276,18 @@ Config::Config(char *configname) {
           continue;
         }
 
+        if (strcmp(commande, "Defragment") == 0) {
+          uint32_t v;
+          if (sscanf(ligne, " %s = %" PRIu32 " ", commande, &v) == 2) {
+            if (v == 0)
+              Defragment = false;
+            else
+              Defragment = true;
+          } else
+            fail(nblignes, configname, ligne);
+          continue;
+        }
+
         if (strcmp(commande, "ListDir") == 0) {
           uint32_t v;
           if (sscanf(ligne, " %s = %" PRIu32 " ", commande, &v) == 2) {
@@ -241,6 +354,14 @@ Config::Config(char *configname) {
           continue;
         }
 
+        if (strcmp(commande, "NumDataDisks") == 0) {
+          if ((sscanf(ligne, " %s = %" PRIu32 " ", commande, &NumDataDisks) !=
+               2) ||
+              (NumDataDisks == 0))
+            fail(nblignes, configname, ligne);
+          continue;
+        }
+
         if (strcmp(commande, "NumDirEntries") == 0) {
           if (sscanf(ligne, " %s = %" PRIu32 " ", commande, &NumDirEntries) !=
               2)
@@ -264,6 +385,78 @@ Config::Config(char *configname) {
           continue;
         }
 
+        if (strcmp(commande, "DiskOverlay") == 0) {
+          char overlay_mode[MAXSTRLEN];
+          if (sscanf(ligne, " %s = %s ", commande, overlay_mode) == 2) {
+            if (strcmp(overlay_mode, "None") == 0)
+              DiskOverlay = OVERLAY_NONE;
+            else if (strcmp(overlay_mode, "Discard") == 0)
+              DiskOverlay = OVERLAY_DISCARD;
+            else if (strcmp(overlay_mode, "Commit") == 0)
+              DiskOverlay = OVERLAY_COMMIT;
+            else
+              fail(nblignes, configname, ligne);
+          } else
+            fail(nblignes, configname, ligne);
+          continue;
+        }
+
+        if ((strcmp(commande, "DiskType") == 0) ||
+            (strcmp(commande, "SwapDiskType") == 0)) {
+          char disk_type[MAXSTRLEN];
+          uint8_t *type =
+              (strcmp(commande, "DiskType") == 0) ? &DiskType : &SwapDiskType;
+          if (sscanf(ligne, " %s = %s ", commande, disk_type) == 2) {
+            if (strcmp(disk_type, "Rotating") == 0)
+              *type = DISK_ROTATING;
+            else if (strcmp(disk_type, "Flash") == 0)
+              *type = DISK_FLASH;
+            else
+              fail(nblignes, configname, ligne);
+          } else
+            fail(nblignes, configname, ligne);
+          continue;
+        }
+
+        if (strcmp(commande, "FlashChannels") == 0) {
+          if ((sscanf(ligne, " %s = %" PRIu32 " ", commande, &FlashChannels) !=
+               2) ||
+              (FlashChannels == 0))
+            fail(nblignes, configname, ligne);
+          continue;
+        }
+
+        if (strcmp(commande, "FlashDiesPerChannel") == 0) {
+          if ((sscanf(ligne, " %s = %" PRIu32 " ", commande,
+                      &FlashDiesPerChannel) != 2) ||
+              (FlashDiesPerChannel == 0))
+            fail(nblignes, configname, ligne);
+          continue;
+        }
+
+        if (strcmp(commande, "FlashPagesPerBlock") == 0) {
+          if ((sscanf(ligne, " %s = %" PRIu32 " ", commande,
+                      &FlashPagesPerBlock) != 2) ||
+              (FlashPagesPerBlock == 0))
+            fail(nblignes, configname, ligne);
+          continue;
+        }
+
+        if (strcmp(commande, "FlashOverProvision") == 0) {
+          if (sscanf(ligne, " %s = %" PRIu32 " ", commande,
+                     &FlashOverProvision) != 2)
+            fail(nblignes, configname, ligne);
+          continue;
+        }
+
+        if (strcmp(commande, "FlashQueueDepth") == 0) {
+          if ((sscanf(ligne, " %s = %" PRIu32 " ", commande,
+                      &FlashQueueDepth) != 2) ||
+              (FlashQueueDepth == 0))
+            fail(nblignes, configname, ligne);
+          continue;
+        }
+
         if (strcmp(commande, "NumPortLoc") == 0) {
           if (sscanf(ligne, " %s = %" PRIu32 " ", commande, &NumPortLoc) != 2)
             fail(nblignes, configname, ligne);
@@ -298,6 +491,12 @@ Config::Config(char *configname) {
     exit(ERROR);
   }
 
+  if ((SuperPageSize == 0) || !power_of_two(SuperPageSize)) {
+    printf("Configuration error : SuperPageSize should be a power of two, "
+           "exiting\n");
+    exit(ERROR);
+  }
+
   NumDirect = ((SectorSize - 4 * sizeof(uint32_t)) / sizeof(uint32_t));
   MagicNumber = 0x456789ab;
   MagicSize = sizeof(uint32_t);
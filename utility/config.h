@@ -36,6 +36,19 @@
 #define ACIA_BUSY_WAITING 1
 #define ACIA_INTERRUPT    2
 
+/* Copy-on-write overlay modes of the disk images */
+#define OVERLAY_NONE    0   //!< Disk images are modified in place
+#define OVERLAY_DISCARD 1   //!< Modified sectors are dropped at exit
+#define OVERLAY_COMMIT  2   //!< Modified sectors are written back at exit
+
+/* Scheduling policies */
+#define POLICY_FIFO       0   //!< Threads run in the order they become ready
+#define POLICY_FAIR_SHARE 1   //!< Processes share the CPU by weight
+
+/* Kinds of block devices */
+#define DISK_ROTATING 0   //!< Rotating disk (see machine/disk.h)
+#define DISK_FLASH    1   //!< Flash disk (see machine/flashdisk.h)
+
 /*! \brief Defines Nachos hardware and software configuration
  *
  * Used to avoid recompiling Nachos when a change in the configuration
@@ -50,12 +63,33 @@ public:
   uint32_t PageSize;       //!< Page size in bytes
   uint64_t NumPhysPages;   //!< Number of pages in the memory of the simulated
                            //!< MIPS machine
+  bool HugePages;   //!< Ask the host for transparent huge pages to back
+                    //!< the memory of the simulated machine
+  uint64_t SuperPageSize;   //!< Number of pages of a superpage, 1 when
+                            //!< superpages are not used
+  uint64_t ZeroPoolSize;   //!< Number of free pages kept filled with
+                           //!< zeroes, refilled while idle
   uint32_t SectorSize;   //!< Disk sector size in bytes (should be equal to the
                          //!< page size)
   uint32_t ProcessorFrequency;   //!< Frequency of the processor (MHz) used for
                                  //!< having statistics
   uint32_t DiskSize;             //!< Total size of the disk (number of sectors)
+  uint32_t NumDataDisks;   //!< Number of data disks the file system volume
+                           //!< is striped over
   uint8_t ACIA;   //!< Use ACIA if USE_ACIA, don't use it if ACIA_NONE
+  uint8_t DiskOverlay;   //!< Keep the disk images read-only and put the
+                         //!< modified sectors in an overlay file if not
+                         //!< OVERLAY_NONE
+  uint8_t DiskType;       //!< Kind of the data disks, DISK_ROTATING or
+                          //!< DISK_FLASH
+  uint8_t SwapDiskType;   //!< Kind of the swap disk
+  uint32_t FlashChannels;         //!< Number of channels of a flash disk
+  uint32_t FlashDiesPerChannel;   //!< Number of dies on each channel
+  uint32_t FlashPagesPerBlock;    //!< Number of pages in an erase block
+  uint32_t FlashOverProvision;    //!< Flash pages in excess of the sectors,
+                                  //!< in percent
+  uint32_t FlashQueueDepth;   //!< Number of requests a flash disk accepts
+                              //!< at the same time
 
   // File system configuration
   uint32_t NumDirect;   //!< Number of data sectors storable in the first header
@@ -73,8 +107,16 @@ public:
   // Kernel (process and address space) configuration
   uint64_t
       MaxVirtPages;   //!< Maximum number of virtual pages in each address space
-  bool TimeSharing;   //!< Use the time sharing mode if true (1) - not
-                      //!< implemented in the base code
+  bool TimeSharing;   //!< Use the time sharing mode if true (1): the
+                      //!< running thread is preempted on timer interrupts
+  uint8_t SchedPolicy;   //!< POLICY_FIFO or POLICY_FAIR_SHARE
+  uint32_t SchedAffinity;   //!< Elections in a row a thread of the running
+                            //!< process may overtake the ready list (0: no
+                            //!< address space affinity)
+  bool WaitMorphing;     //!< Move the threads signalled on a condition
+                         //!< to the wait queue of its lock (1)
+  bool SkipSpinLoops;    //!< Jump to the next interrupt instead of
+                         //!< simulating the spin loops (1)
   uint32_t MagicNumber;     //!< 0x456789ab
   uint32_t MagicSize;       //!< Size of an integer
   uint32_t UserStackSize;   //!< Stack size of user threads in bytes
@@ -85,6 +127,7 @@ public:
   bool PrintFileSyst;   //!< Print all the files in the file system if true
   bool PrintStat;       //!< Print the statistics if true
   bool FormatDisk;      //!< Format the disk if true
+  bool Defragment;      //!< Defragment the file system at startup if true
   bool Print;           //!< Print  FileToPrint if true
   bool Remove;          //!< Remove FileToRemove if true
   bool MakeDir;         //!< Make DirToMake if true
@@ -297,9 +297,40 @@ public:
   */
   //----------------------------------------------------------------------
   void RemoveItem(void *item) {
-    void *temp;
-    while ((temp = this->Remove()) != item)
-      this->Append(temp);
+    ListElement<T> *prev = NULL;
+    for (ListElement<T> *ptr = first; ptr != NULL; ptr = ptr->next) {
+      if (ptr->item == item) {
+        if (prev == NULL)
+          first = ptr->next;
+        else
+          prev->next = ptr->next;
+        if (last == ptr)
+          last = prev;
+        delete ptr;
+        return;
+      }
+      prev = ptr;
+    }
+  }
+
+  //----------------------------------------------------------------------
+  // List::Concat
+  /*!      Move all the elements of another list at the end of this
+  //	one, in constant time. The other list becomes empty.
+  //
+  // \param
+  //    other: the list whose elements are moved
+  */
+  //----------------------------------------------------------------------
+  void Concat(List<T> *other) {
+    if (other->IsEmpty())
+      return;
+    if (IsEmpty())
+      first = other->first;
+    else
+      last->next = other->first;
+    last = other->last;
+    other->first = other->last = NULL;
   }
 
   //----------------------------------------------------------------------
@@ -42,20 +42,28 @@ using namespace std;
 //
 // A method allows to detect of an object corresponding to a given
 // identifier exists; this is used to check the parameters of system
-// calls.
+// calls. The type of an object can be recorded with it, to tell the
+// objects of different classes apart without reading them.
 */
 class ObjAddr {
 private:
+  //! An object and its type, INVALID_TYPE if not given
+  typedef struct {
+    void *ptr;
+    ObjectType type;
+  } ObjEntry;
+
   int last_id;
-  map<const int32_t, void *> ids;
+  map<const int32_t, ObjEntry> ids;
 
 public:
   ObjAddr() { last_id = 3; /* 0, 1 and 2 used for file descriptors */ }
   ~ObjAddr() { ids.clear(); };
 
-  int32_t AddObject(void *ptr) {
+  int32_t AddObject(void *ptr, ObjectType type = INVALID_TYPE) {
     int32_t res = last_id++;
-    ids[res] = ptr;
+    ids[res].ptr = ptr;
+    ids[res].type = type;
     if (res < 0) {
       printf("**** Nachos kernel panic, not enough object identifiers\n");
       extern void Cleanup();
@@ -65,19 +73,28 @@ public:
   }
 
   void *SearchObject(int32_t id) {
-    if (ids.find(id) == ids.end()) {
+    map<const int32_t, ObjEntry>::iterator it = ids.find(id);
+    if (it == ids.end()) {
       return (void *) NULL;
     }
-    return ids[id];
+    return it->second.ptr;
+  }
+
+  ObjectType SearchType(int32_t id) {
+    map<const int32_t, ObjEntry>::iterator it = ids.find(id);
+    if (it == ids.end()) {
+      return INVALID_TYPE;
+    }
+    return it->second.type;
   }
 
   void RemoveObject(int32_t id) { ids.erase(id); }
 
   void RemoveObject(void *ptr) {
     int32_t id = -1;
-    for (map<const int32_t, void *>::iterator it = ids.begin(); it != ids.end();
-         ++it) {
-      if (it->second == ptr) {
+    for (map<const int32_t, ObjEntry>::iterator it = ids.begin();
+         it != ids.end(); ++it) {
+      if (it->second.ptr == ptr) {
         id = it->first;
         break;
       }
@@ -0,0 +1,67 @@
+/*! \file profile.cc
+//  \brief Host-time profiling zones: counters and breakdown
+//
+//  See profile.h. Nothing is compiled here unless PROFILE_ZONES is
+//  defined.
+
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#include "utility/profile.h"
+
+#ifdef PROFILE_ZONES
+
+int g_profile_zone = PROFILE_OUTSIDE;
+uint64_t g_profile_last = PROFILE_COUNTER();
+uint64_t g_profile_calls[NB_PROFILE_ZONES];
+uint64_t g_profile_self[NB_PROFILE_ZONES];
+
+static const char *zoneNames[NB_PROFILE_ZONES] = {
+    "OneInstruction", "MMU::Translate", "Interrupt::OneTick",
+    "SwitchTo",       "Disk read",      "OpenFile::ReadAt",
+    "Exceptions",     "Outside zones"};
+
+//----------------------------------------------------------------------
+// ProfilePrint
+/*!	Print the host time spent in each zone since the start of the
+//	simulator, with its share of the whole run.
+*/
+//----------------------------------------------------------------------
+void
+ProfilePrint() {
+  uint64_t total = 0;
+  int z;
+
+  // Charge the time elapsed up to now
+  ProfileSwitchZone(g_profile_zone);
+
+  for (z = 0; z < NB_PROFILE_ZONES; z++)
+    total += g_profile_self[z];
+  if (total == 0)
+    total = 1;
+
+  printf("\nHost time breakdown (self time, in " PROFILE_UNIT ") :\n");
+  for (z = 0; z < NB_PROFILE_ZONES; z++) {
+    printf("   %-20s %12" PRIu64 " calls %16" PRIu64 " %6.2f%%", zoneNames[z],
+           g_profile_calls[z], g_profile_self[z],
+           100.0 * g_profile_self[z] / total);
+    if (g_profile_calls[z] != 0)
+      printf(" %10" PRIu64 " per call", g_profile_self[z] / g_profile_calls[z]);
+    printf("\n");
+  }
+}
+
+#endif   // PROFILE_ZONES
@@ -0,0 +1,113 @@
+/*! \file profile.h
+    \brief Host-time profiling zones
+
+    A profiling zone is a region of the simulator (a function, most of
+    the time) whose host execution time is measured, to know where the
+    time of a run really goes: decoding and executing the user
+    instructions, translating their addresses, simulating the devices,
+    or running the kernel itself.
+
+    A zone is entered by declaring PROFILE_ZONE(zone) at the top of a
+    block, and left at the end of that block. The time is counted as
+    self time: it is charged to the innermost zone active when it
+    elapses, so that the zones of the breakdown printed at exit add up
+    to the whole run. Each thread keeps its own chain of zones on its
+    stack, so a context switch does not mix them up.
+
+    Zones cost a counter read (rdtsc on x86) on entry and on exit. They
+    are compiled out unless PROFILE_ZONES is defined (make PROFILE=1),
+    PROFILE_ZONE then expanding to nothing.
+
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "utility/utility.h"
+
+/*! Profiling zones. PROFILE_OUTSIDE gets the time spent outside of
+    any other zone. */
+enum ProfileZone {
+  PROFILE_INSTRUCTION,   //!< Machine::OneInstruction
+  PROFILE_TRANSLATE,     //!< MMU::Translate
+  PROFILE_TICK,          //!< Interrupt::OneTick, including the handlers
+  PROFILE_SWITCH,        //!< Scheduler::SwitchTo
+  PROFILE_DISK,          //!< Disk::ReadRequest, FlashDisk::ReadRequest
+  PROFILE_READAT,        //!< OpenFile::ReadAt
+  PROFILE_EXCEPTION,     //!< ExceptionHandler (system calls, page faults)
+  PROFILE_OUTSIDE,       //!< everything else
+  NB_PROFILE_ZONES
+};
+
+#ifdef PROFILE_ZONES
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROFILE_COUNTER() __rdtsc()
+#define PROFILE_UNIT      "host cycles"
+#else
+#define PROFILE_COUNTER() HostNanos()
+#define PROFILE_UNIT      "host nanos"
+#endif
+
+extern int g_profile_zone;        //!< innermost active zone
+extern uint64_t g_profile_last;   //!< counter value when last charged
+extern uint64_t g_profile_calls[NB_PROFILE_ZONES];
+extern uint64_t g_profile_self[NB_PROFILE_ZONES];
+
+//----------------------------------------------------------------------
+// ProfileSwitchZone
+/*!	Charge the time elapsed since the last switch to the active zone,
+//	and make "zone" the active one.
+*/
+//----------------------------------------------------------------------
+inline void
+ProfileSwitchZone(int zone) {
+  uint64_t now = PROFILE_COUNTER();
+
+  g_profile_self[g_profile_zone] += now - g_profile_last;
+  g_profile_last = now;
+  g_profile_zone = zone;
+}
+
+/*! \brief Scoped profiling zone: active from its construction to its
+    destruction, the zone active before being restored at that time. */
+class ProfileScope {
+public:
+  ProfileScope(ProfileZone zone) : prev(g_profile_zone) {
+    g_profile_calls[zone]++;
+    ProfileSwitchZone(zone);
+  }
+  ~ProfileScope() { ProfileSwitchZone(prev); }
+
+private:
+  int prev;   //!< zone to go back to
+};
+
+extern void ProfilePrint();
+
+#define PROFILE_ZONE(zone)     ProfileScope profileScope(zone)
+#define PROFILE_THREAD_START() ProfileSwitchZone(PROFILE_OUTSIDE)
+
+#else   // PROFILE_ZONES
+
+#define PROFILE_ZONE(zone)
+#define PROFILE_THREAD_START()
+
+#endif   // PROFILE_ZONES
+
+#endif   // PROFILE_H
@@ -23,6 +23,7 @@
 #include "utility/stats.h"
 #include "kernel/copyright.h"
 #include "kernel/system.h"
+#include "utility/profile.h"
 
 //----------------------------------------------------------------------
 // Statistics::Statistics
@@ -33,6 +34,14 @@
 Statistics::Statistics() {
   allStatistics = new Listint;
   idleTicks = totalTicks = 0;
+  numHandlers = handlerNanos = 0;
+  numDeferred = deferredNanos = 0;
+  numSwitches = 0;
+  numSameSpace = 0;
+  numSpinSkips = spinTicks = 0;
+  numSeeks = seekTracks = 0;
+  numJobs = numMisses = numOverruns = 0;
+  numZeroFills = numZeroReady = numIdleZeroed = 0;
 }
 
 //----------------------------------------------------------------------
@@ -70,6 +79,27 @@ Statistics::Print() {
          totalTicks, g_cfg->ProcessorFrequency,
          cycle_to_sec(totalTicks, g_cfg->ProcessorFrequency),
          cycle_to_nano(totalTicks, g_cfg->ProcessorFrequency));
+  printf("   Context switches : \t%" PRIu64 " (%" PRIu64
+         " same address space, %" PRIu64 " cross address spaces)\n",
+         numSwitches, numSameSpace, numSwitches - numSameSpace);
+  printf("   Periodic jobs : \t%" PRIu64 " jobs, %" PRIu64
+         " deadline misses, %" PRIu64 " budget overruns\n",
+         numJobs, numMisses, numOverruns);
+  printf("   Zero-filled pages : \t%" PRIu64 " (%" PRIu64
+         " already zeroed, %" PRIu64 " zeroed while idle)\n",
+         numZeroFills, numZeroReady, numIdleZeroed);
+  printf("   Spin loops skipped : \t%" PRIu64 " times, %" PRIu64 " cycles\n",
+         numSpinSkips, spinTicks);
+  printf("   Disk seeks : \t\t%" PRIu64 " seeks, %" PRIu64 " tracks\n", numSeeks,
+         seekTracks);
+  printf("   Interrupt handlers : \t%" PRIu64 " calls, %" PRIu64
+         " host micros\n",
+         numHandlers, handlerNanos / 1000);
+  printf("   Deferred work : \t%" PRIu64 " items, %" PRIu64 " host micros\n",
+         numDeferred, deferredNanos / 1000);
+#ifdef PROFILE_ZONES
+  ProfilePrint();
+#endif
 }
 
 ProcessStat *
@@ -109,6 +139,37 @@ ProcessStat::ProcessStat(char *processName) {
   numConsoleCharsRead = numConsoleCharsWritten = 0;
   numMemoryAccess = numPageFaults = 0;
   systemTicks = userTicks = 0;
+  weight = 0;
+  cpuTicks = fairTicks = 0;
+  threadStats = new Listint;
+}
+
+//----------------------------------------------------------------------
+// ProcessStat::~ProcessStat
+//!    De-allocate the statistics of the threads of the process
+//
+//----------------------------------------------------------------------
+ProcessStat::~ProcessStat() {
+  while (!threadStats->IsEmpty())
+    delete (ThreadStat *) threadStats->Remove();
+  delete threadStats;
+}
+
+//----------------------------------------------------------------------
+// ProcessStat::NewThreadStat
+/*!     Create the statistics of a new thread of the process. They are
+//      kept, and printed with those of the process, after the thread
+//      has finished.
+//
+//      \param threadName name of the thread
+//      \return the new statistics
+*/
+//----------------------------------------------------------------------
+ThreadStat *
+ProcessStat::NewThreadStat(char *threadName) {
+  ThreadStat *threadStat = new ThreadStat(threadName, this);
+  threadStats->Append((void *) threadStat);
+  return threadStat;
 }
 
 //----------------------------------------------------------------------
@@ -186,6 +247,76 @@ ProcessStat::Print(void) {
   printf("   Memory Management :  \t%" PRIu64 " accesses,  %" PRIu64
          " page faults\n",
          numMemoryAccess, numPageFaults);
+  if (g_cfg->SchedPolicy == POLICY_FAIR_SHARE)
+    printf("   CPU share : \t\t%" PRIu64 " cycles, fair share %" PRIu64
+           " cycles (weight %" PRIu32 ", %" PRIu64 " %% of target)\n",
+           cpuTicks, fairTicks, weight,
+           (fairTicks == 0) ? 0 : (cpuTicks * 100) / fairTicks);
+  else
+    printf("   CPU share : \t\t%" PRIu64 " cycles\n", cpuTicks);
+
+  // Break the totals down by thread, when there were several of them
+  ListElement<int> *t = threadStats->getFirst();
+  if ((t != NULL) && (t->next != NULL))
+    for (; t != NULL; t = t->next)
+      ((ThreadStat *) t->item)->Print();
 
   printf("------------------------------------------------------------\n");
 }
+
+//----------------------------------------------------------------------
+// ThreadStat::ThreadStat
+/*!     Initializes the statistics of a thread to zero
+.
+//      \param threadName name of the thread
+//      \param processStat statistics of the process of the thread,
+//             the counters are rolled up into
+*/
+//----------------------------------------------------------------------
+ThreadStat::ThreadStat(char *threadName, ProcessStat *processStat) {
+  snprintf(name, sizeof(name), "%s", threadName);
+  process = processStat;
+  systemTicks = userTicks = cpuTicks = 0;
+  numInstruction = numDiskReads = numDiskWrites = 0;
+  numVoluntarySwitches = numInvoluntarySwitches = 0;
+  for (int i = 0; i < NB_BLOCK_REASONS; i++)
+    blockedTicks[i] = 0;
+}
+
+//----------------------------------------------------------------------
+// ThreadStat::incrMemoryAccess(void)
+/*!     Updates stats concerning a memory access (thread and process level)
+.
+*/
+//----------------------------------------------------------------------
+void
+ThreadStat::incrMemoryAccess(void) {
+  userTicks += MEMORY_TICKS;
+  process->incrMemoryAccess();
+}
+
+//----------------------------------------------------------------------
+// ThreadStat::Print
+/*!     Prints per-thread statistics, after those of its process
+.
+*/
+//----------------------------------------------------------------------
+void
+ThreadStat::Print(void) {
+  printf("   Thread %s : \n", name);
+  printf("      Instructions : \t\t%" PRIu64 ", user time %" PRIu64
+         " cycles, system time %" PRIu64 " cycles\n",
+         numInstruction, userTicks, systemTicks);
+  printf("      Context switches : \t%" PRIu64 " voluntary, %" PRIu64
+         " involuntary\n",
+         numVoluntarySwitches, numInvoluntarySwitches);
+  printf("      Disk Input/Output : \treads  %" PRIu64 ", writes  %" PRIu64
+         "\n",
+         numDiskReads, numDiskWrites);
+  printf("      Blocked (cycles) : \tsemaphore %" PRIu64 ", lock %" PRIu64
+         ", condition %" PRIu64 ", barrier %" PRIu64 ", WaitAny %" PRIu64
+         ", period %" PRIu64 "\n",
+         blockedTicks[BLOCKED_SEMAPHORE], blockedTicks[BLOCKED_LOCK],
+         blockedTicks[BLOCKED_CONDITION], blockedTicks[BLOCKED_BARRIER],
+         blockedTicks[BLOCKED_WAITANY], blockedTicks[BLOCKED_PERIOD]);
+}
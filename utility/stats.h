@@ -33,6 +33,7 @@
 */
 
 class ProcessStat;
+class ThreadStat;
 
 class Statistics {
 private:
@@ -40,6 +41,22 @@ private:
                             //!< when they are finished.
   Time totalTicks;          //!< Total time spent running Nachos
   Time idleTicks;           //!< Time spent idle (no thread to run)
+  uint64_t numHandlers;     //!< Number of interrupt handlers run
+  uint64_t handlerNanos;    //!< Host time spent in interrupt handlers
+  uint64_t numDeferred;     //!< Number of deferred work items run
+  uint64_t deferredNanos;   //!< Host time spent in deferred work
+  uint64_t numSwitches;     //!< Number of context switches
+  uint64_t numSameSpace;    //!< Those between threads of the same process
+  uint64_t numSpinSkips;    //!< Number of spin loops skipped
+  Time spinTicks;           //!< Time skipped in spin loops
+  uint64_t numSeeks;        //!< Number of disk head moves
+  uint64_t seekTracks;      //!< Number of tracks crossed by the heads
+  uint64_t numJobs;         //!< Number of jobs of the periodic threads
+  uint64_t numMisses;       //!< Those done after their deadline
+  uint64_t numOverruns;     //!< Those which used up their budget
+  uint64_t numZeroFills;    //!< Number of pages given filled with zeroes
+  uint64_t numZeroReady;    //!< Those already zeroed when given
+  uint64_t numIdleZeroed;   //!< Number of pages zeroed while idle
 
 public:
   Statistics();    // initialyses everything to zero
@@ -56,6 +73,40 @@ public:
   void setTotalTicks(Time val) { totalTicks = val; }
   Time getTotalTicks(void) { return totalTicks; }
   void incrIdleTicks(Time val) { idleTicks += val; }
+  Time getIdleTicks(void) { return idleTicks; }
+  void incrSwitches(bool sameSpace) {
+    numSwitches++;
+    if (sameSpace)
+      numSameSpace++;
+  }
+  void incrSpinSkips(Time val) {
+    numSpinSkips++;
+    spinTicks += val;
+  }
+  void incrJobs(bool missed) {
+    numJobs++;
+    if (missed)
+      numMisses++;
+  }
+  void incrOverruns(void) { numOverruns++; }
+  void incrZeroFills(bool ready) {
+    numZeroFills++;
+    if (ready)
+      numZeroReady++;
+  }
+  void incrIdleZeroed(void) { numIdleZeroed++; }
+  void incrSeeks(int tracks) {
+    numSeeks++;
+    seekTracks += tracks;
+  }
+  void incrHandlers(uint64_t nanos) {
+    numHandlers++;
+    handlerNanos += nanos;
+  }
+  void incrDeferred(uint64_t items, uint64_t nanos) {
+    numDeferred += items;
+    deferredNanos += nanos;
+  }
 };
 
 /*! \brief Defines statistics that concern a particular process
@@ -81,9 +132,18 @@ private:
 
   uint64_t numMemoryAccess;   //!< number of Memory accesses
   uint64_t numPageFaults;     //!< number of virtual memory page faults
+
+  uint32_t weight;   //!< weight of the process for the scheduler
+  Time cpuTicks;     //!< time its threads were running on the CPU
+  Time fairTicks;    /*!< time it should have been running, given the
+                        weights of the processes competing for the CPU */
+  Listint *threadStats;   //!< statistics of its threads
 public:
   ProcessStat(char *name); /* initialises everything to zero and
                                 initialises the name of the process */
+  ~ProcessStat();          // de-allocate the statistics of the threads
+  ThreadStat *NewThreadStat(char *name); /* create the statistics of a
+                   new thread of the process, kept until the end */
   void incrSystemTicks(Time val);
   void incrUserTicks(Time val);
   Time getUserTime(void) { return userTicks; }
@@ -95,7 +155,98 @@ public:
   void incrNumDiskReads(void) { numDiskReads++; }
   void incrNumDiskWrites(void) { numDiskWrites++; }
   void incrNumInstruction(void) { numInstruction++; }
-  int getNumInstruction(void) { return numInstruction; }
+  uint64_t getNumInstruction(void) { return numInstruction; }
+  uint64_t getNumDiskReads(void) { return numDiskReads; }
+  uint64_t getNumDiskWrites(void) { return numDiskWrites; }
+  uint64_t getNumCharRead(void) { return numConsoleCharsRead; }
+  uint64_t getNumCharWritten(void) { return numConsoleCharsWritten; }
+  uint64_t getMemoryAccess(void) { return numMemoryAccess; }
+  uint64_t getPageFaults(void) { return numPageFaults; }
+  uint32_t getWeight(void) { return weight; }
+  Time getCpuTicks(void) { return cpuTicks; }
+  Time getFairTicks(void) { return fairTicks; }
+  void setWeight(uint32_t w) { weight = w; }
+  void incrCpuTicks(Time val) { cpuTicks += val; }
+  void incrFairTicks(Time val) { fairTicks += val; }
+  void Print(void);
+};
+
+//! What a thread is blocked on (see ThreadStat)
+enum BlockReason {
+  BLOCKED_SEMAPHORE,
+  BLOCKED_LOCK,
+  BLOCKED_CONDITION,
+  BLOCKED_BARRIER,
+  BLOCKED_WAITANY,
+  BLOCKED_PERIOD,   //!< waiting for the next period (periodic threads)
+  NB_BLOCK_REASONS
+};
+
+/*! \brief Defines statistics that concern a particular thread
+//
+// The counters of the time and of the instructions and disk requests
+// of a thread are rolled up into those of its process as they are
+// incremented, so the threads of a process add up to its totals.
+// They are kept by the process when the thread is deleted.
+*/
+
+class ThreadStat {
+private:
+  char name[MAXSTRLEN];   //!< name of the thread
+  ProcessStat *process;   //!< statistics of its process
+  Time systemTicks;       //!< Time spent executing system code
+  Time userTicks;         //!< Time spent executing user code
+  Time cpuTicks;          //!< Time the thread was running
+  uint64_t numInstruction;
+  uint64_t numDiskReads;    //!< number of disk read requests
+  uint64_t numDiskWrites;   //!< number of disk write requests
+  uint64_t numVoluntarySwitches;     //!< the thread blocked or yielded
+  uint64_t numInvoluntarySwitches;   //!< the thread was preempted
+  Time blockedTicks[NB_BLOCK_REASONS]; /*!< time from blocking on an
+                        object to running again, by kind of object */
+public:
+  ThreadStat(char *name, ProcessStat *process);
+  void incrSystemTicks(Time val) {
+    systemTicks += val;
+    process->incrSystemTicks(val);
+  }
+  void incrUserTicks(Time val) {
+    userTicks += val;
+    process->incrUserTicks(val);
+  }
+  void incrMemoryAccess(void);
+  void incrNumInstruction(void) {
+    numInstruction++;
+    process->incrNumInstruction();
+  }
+  void incrNumDiskReads(void) {
+    numDiskReads++;
+    process->incrNumDiskReads();
+  }
+  void incrNumDiskWrites(void) {
+    numDiskWrites++;
+    process->incrNumDiskWrites();
+  }
+  void incrCpuTicks(Time val) {
+    cpuTicks += val;
+    process->incrCpuTicks(val);
+  }
+  Time getUserTime(void) { return userTicks; }
+  Time getSystemTime(void) { return systemTicks; }
+  Time getCpuTicks(void) { return cpuTicks; }
+  uint64_t getNumInstruction(void) { return numInstruction; }
+  uint64_t getNumDiskReads(void) { return numDiskReads; }
+  uint64_t getNumDiskWrites(void) { return numDiskWrites; }
+  ProcessStat *getProcess(void) { return process; }
+  void incrSwitches(bool involuntary) {
+    if (involuntary)
+      numInvoluntarySwitches++;
+    else
+      numVoluntarySwitches++;
+  }
+  void incrBlockedTicks(BlockReason reason, Time val) {
+    blockedTicks[reason] += val;
+  }
   void Print(void);
 };
 
@@ -109,6 +260,10 @@ public:
 // The speeds of the peripherals are not linked to those of the CPU
 #define ROTATION_TIME 1000    //!< time disk takes to rotate one sector
 #define SEEK_TIME     1000    //!< time disk takes to seek past one track
+#define FLASH_READ_TIME     500     //!< time a flash die takes to read a page
+#define FLASH_PROGRAM_TIME  4000    //!< time a flash die takes to program a page
+#define FLASH_ERASE_TIME    30000   //!< time a flash die takes to erase a block
+#define FLASH_TRANSFER_TIME 100     //!< time to move a page over a flash channel
 #define CONSOLE_TIME  1000    //!< time to read or write one character
 #define CHECK_TIME    1000    //!< time between two checks of reception register
 #define SEND_TIME     1000    //!< time to send a char via the ACIA object
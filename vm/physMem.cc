@@ -25,39 +25,34 @@
 //-----------------------------------------------------------------
 // PhysicalMemManager::PhysicalMemManager
 //
-/*! Constructor. It simply clears all the page flags and inserts them in the
-// free_page_list to indicate that the physical pages are free
+/*! Constructor. All the physical pages are free: none of them has
+// been used yet, and the stack of freed pages and the zero pool are
+// empty
 */
 //-----------------------------------------------------------------
 PhysicalMemManager::PhysicalMemManager() {
-
-  uint64_t i;
-  tpr = new struct tpr_c[g_cfg->NumPhysPages];
-
-  for (i = 0; i < g_cfg->NumPhysPages; i++) {
-    tpr[i].free = true;
-    tpr[i].locked = false;
-    tpr[i].owner = NULL;
-    free_page_list.Append((void *) i);
-  }
+  tpr = (struct tpr_c *) AllocZeroedMemory(
+      g_cfg->NumPhysPages * sizeof(struct tpr_c), false);
+  free_stack = INVALID_PAGE;
+  never_used = 0;
+  free_runs = INVALID_PAGE;
+  zero_pool = INVALID_PAGE;
+  pool_size = 0;
   i_clock = -1;
 }
 
 PhysicalMemManager::~PhysicalMemManager() {
-  // Empty free page list
-  while (!free_page_list.IsEmpty())
-    free_page_list.Remove();
-
   // Delete physical page table
-  delete[] tpr;
+  DeallocZeroedMemory((int8_t *) tpr,
+                      g_cfg->NumPhysPages * sizeof(struct tpr_c));
 }
 
 //-----------------------------------------------------------------
 // PhysicalMemManager::RemovePhysicalToVitualMapping
 //
 /*! This method releases an unused physical page by clearing the
-//  corresponding bit in the page_flags bitmap structure, and adding
-//  it in the free_page_list.
+//  corresponding bit in the page_flags bitmap structure, and pushing
+//  it on the stack of freed pages.
 //
 //  \param num_page is the number of the real page to free
 */
@@ -68,15 +63,84 @@ PhysicalMemManager::RemovePhysicalToVirtualMapping(uint64_t num_page) {
   // Check that the page is not already free
   ASSERT(!tpr[num_page].free);
 
+  // A superpage losing one of its pages is split into single pages
+  if (tpr[num_page].runHead != INVALID_PAGE)
+    SplitRun(tpr[num_page].runHead);
+
   // Update the physical page table entry
   tpr[num_page].free = true;
   tpr[num_page].locked = false;
+  tpr[num_page].zeroed = false;
   if (tpr[num_page].owner->translationTable != NULL)
     tpr[num_page].owner->translationTable->clearBitValid(
         tpr[num_page].virtualPage);
 
-  // Insert the page in the free list
-  free_page_list.Prepend((void *) num_page);
+  // Push the page on the stack of freed pages
+  tpr[num_page].nextFree = free_stack;
+  free_stack = num_page;
+}
+
+//-----------------------------------------------------------------
+// PhysicalMemManager::RemoveSuperPageMapping
+//
+/*! This method releases the run of physical pages of a superpage,
+//  and deletes the mapping of all its pages. The run is kept whole
+//  for another superpage.
+//
+//  \param num_page is the number of the first real page of the run
+*/
+//-----------------------------------------------------------------
+void
+PhysicalMemManager::RemoveSuperPageMapping(uint64_t num_page) {
+  AddrSpace *owner = tpr[num_page].owner;
+
+  // Check that the page starts a run in use
+  ASSERT(tpr[num_page].runHead == (int64_t) num_page);
+  DEBUG('a', (char *) "Freeing the run of physical pages %" PRIu64 "\n",
+        num_page);
+
+  if (owner->translationTable != NULL)
+    owner->translationTable->clearSuperPage(tpr[num_page].virtualPage);
+
+  // Update the physical page table entries
+  for (uint64_t page = num_page; page < num_page + g_cfg->SuperPageSize;
+       page++) {
+    ASSERT(!tpr[page].free);
+    tpr[page].free = true;
+    tpr[page].locked = false;
+    tpr[page].zeroed = false;
+    if (owner->translationTable != NULL)
+      owner->translationTable->clearBitValid(tpr[page].virtualPage);
+  }
+
+  // Push the run on the stack of free runs
+  tpr[num_page].nextFree = free_runs;
+  free_runs = num_page;
+}
+
+//-----------------------------------------------------------------
+// PhysicalMemManager::SplitRun
+//
+/*! This method splits the superpage using a run of physical pages
+//  into single pages, the pages of the run being then handled one by
+//  one.
+//
+//  \param num_page is the number of the first real page of the run
+*/
+//-----------------------------------------------------------------
+void
+PhysicalMemManager::SplitRun(uint64_t num_page) {
+  AddrSpace *owner = tpr[num_page].owner;
+
+  DEBUG('a', (char *) "Splitting the run of physical pages %" PRIu64 "\n",
+        num_page);
+  if ((owner->translationTable != NULL) &&
+      owner->translationTable->isSuperPage(tpr[num_page].virtualPage))
+    owner->translationTable->clearSuperPage(tpr[num_page].virtualPage);
+
+  for (uint64_t page = num_page; page < num_page + g_cfg->SuperPageSize;
+       page++)
+    tpr[page].runHead = INVALID_PAGE;
 }
 
 //-----------------------------------------------------------------
@@ -99,6 +163,50 @@ PhysicalMemManager::UnlockPage(uint64_t num_page) {
   tpr[num_page].locked = false;
 }
 
+//-----------------------------------------------------------------
+// PhysicalMemManager::ZeroPage
+//
+/*! Fill a free physical page with zeroes, if it does not only hold
+//  zeroes already
+//
+//  \param num_page is the number of the real page to fill
+*/
+//-----------------------------------------------------------------
+void
+PhysicalMemManager::ZeroPage(uint64_t num_page) {
+  ASSERT(tpr[num_page].free);
+  if (!tpr[num_page].zeroed) {
+    memset(&(g_machine->mainMemory[num_page * g_cfg->PageSize]), 0,
+           g_cfg->PageSize);
+    tpr[num_page].zeroed = true;
+  }
+}
+
+//-----------------------------------------------------------------
+// PhysicalMemManager::RefillZeroPool
+//
+/*! Called when no thread is ready to run: fill freed pages with
+//  zeroes, and move them to the zero pool, until the pool holds
+//  g_cfg->ZeroPoolSize pages. The pages never used already hold only
+//  zeroes, they are not moved.
+*/
+//-----------------------------------------------------------------
+void
+PhysicalMemManager::RefillZeroPool() {
+  uint64_t page;
+
+  while ((pool_size < g_cfg->ZeroPoolSize) && (free_stack != INVALID_PAGE)) {
+    page = free_stack;
+    free_stack = tpr[page].nextFree;
+    if (!tpr[page].zeroed)
+      g_stats->incrIdleZeroed();
+    ZeroPage(page);
+    tpr[page].nextFree = zero_pool;
+    zero_pool = page;
+    pool_size++;
+  }
+}
+
 //-----------------------------------------------------------------
 // PhysicalMemManager::ChangeOwner
 //
@@ -111,7 +219,7 @@ PhysicalMemManager::UnlockPage(uint64_t num_page) {
 void
 PhysicalMemManager::ChangeOwner(uint64_t numPage, Thread *owner) {
   // Update statistics
-  g_current_thread->GetProcessOwner()->stat->incrMemoryAccess();
+  g_current_thread->stat->incrMemoryAccess();
   // Change the page owner
   tpr[numPage].owner = owner->GetProcessOwner()->addrspace;
 }
@@ -145,34 +253,139 @@ PhysicalMemManager::AddPhysicalToVirtualMapping(AddrSpace *owner,
 //
 /*! This method returns a new physical page number, if it finds one
 //  free. If not, return INVALID_PAGE. Does not run the clock algorithm.
+//  A page to fill with zeroes is taken from the zero pool first, else
+//  it is the first page never used, else the last freed page, zeroed
+//  now. Otherwise the last freed page is reused first, else the first
+//  page never used, else a page of the zero pool. The pages of a free
+//  run are only used when there is no other free page.
 //
+//  \param zero is true if the page must be filled with zeroes
 //  \return A new free physical page number.
 */
 //-----------------------------------------------------------------
 int
-PhysicalMemManager::FindFreePage() {
+PhysicalMemManager::FindFreePage(bool zero) {
   uint64_t page;
 
-  // Check that the free list is not empty
-  if (free_page_list.IsEmpty()) {
+  // Break a free run into single pages when there is no other free page
+  if ((free_stack == INVALID_PAGE) && (zero_pool == INVALID_PAGE) &&
+      (never_used == g_cfg->NumPhysPages) && (free_runs != INVALID_PAGE)) {
+    uint64_t first = free_runs;
+    free_runs = tpr[first].nextFree;
+    for (page = first + g_cfg->SuperPageSize; page > first; page--) {
+      tpr[page - 1].runHead = INVALID_PAGE;
+      tpr[page - 1].nextFree = free_stack;
+      free_stack = page - 1;
+    }
+  }
+
+  // Check that there is a free page
+  if ((free_stack == INVALID_PAGE) && (zero_pool == INVALID_PAGE) &&
+      (never_used == g_cfg->NumPhysPages)) {
     return INVALID_PAGE;
   }
 
   // Update statistics
-  g_current_thread->GetProcessOwner()->stat->incrMemoryAccess();
+  g_current_thread->stat->incrMemoryAccess();
 
-  // Get a page from the free list
-  page = (int64_t) free_page_list.Remove();
+  if ((zero_pool != INVALID_PAGE) &&
+      (zero || ((free_stack == INVALID_PAGE) &&
+                (never_used == g_cfg->NumPhysPages)))) {
+    // Pop the last page of the zero pool
+    page = zero_pool;
+    zero_pool = tpr[page].nextFree;
+    pool_size--;
+  } else if ((free_stack != INVALID_PAGE) &&
+             (!zero || (never_used == g_cfg->NumPhysPages))) {
+    // Pop the last freed page
+    page = free_stack;
+    free_stack = tpr[page].nextFree;
+  } else {
+    // Initialize the entry of a page never used
+    page = never_used++;
+    tpr[page].free = true;
+    tpr[page].locked = false;
+    tpr[page].owner = NULL;
+    tpr[page].runHead = INVALID_PAGE;
+    tpr[page].zeroed = true;
+  }
 
   // Check that the page is really free
   ASSERT(tpr[page].free);
 
+  if (zero) {
+    g_stats->incrZeroFills(tpr[page].zeroed);
+    ZeroPage(page);
+  }
+
   // Update the physical page table
   tpr[page].free = false;
 
   return page;
 }
 
+//-----------------------------------------------------------------
+// PhysicalMemManager::FindFreeRun
+//
+/*! This method returns the first page of a run of g_cfg->SuperPageSize
+//  free physical pages, aligned on its size, if it finds one. If not,
+//  return INVALID_PAGE. The last freed run is reused first, else the
+//  first aligned run of pages never used.
+//
+//  \param zero is true if the pages must be filled with zeroes
+//  \return The first page of a new run.
+*/
+//-----------------------------------------------------------------
+int
+PhysicalMemManager::FindFreeRun(bool zero) {
+  uint64_t first;
+  uint64_t size = g_cfg->SuperPageSize;
+
+  if (free_runs != INVALID_PAGE) {
+    // Pop the last freed run
+    first = free_runs;
+    free_runs = tpr[first].nextFree;
+  } else {
+    first = divRoundUp(never_used, size) * size;
+    if ((size == 1) || (first + size > g_cfg->NumPhysPages))
+      return INVALID_PAGE;
+
+    // The pages never used before the run are pushed on the stack of
+    // freed pages
+    for (; never_used < first; never_used++) {
+      tpr[never_used].free = true;
+      tpr[never_used].locked = false;
+      tpr[never_used].owner = NULL;
+      tpr[never_used].runHead = INVALID_PAGE;
+      tpr[never_used].zeroed = true;
+      tpr[never_used].nextFree = free_stack;
+      free_stack = never_used;
+    }
+    for (; never_used < first + size; never_used++) {
+      tpr[never_used].free = true;
+      tpr[never_used].locked = false;
+      tpr[never_used].owner = NULL;
+      tpr[never_used].zeroed = true;
+    }
+  }
+
+  // Update statistics
+  g_current_thread->stat->incrMemoryAccess();
+
+  // Update the physical page table
+  for (uint64_t page = first; page < first + size; page++) {
+    ASSERT(tpr[page].free);
+    if (zero) {
+      g_stats->incrZeroFills(tpr[page].zeroed);
+      ZeroPage(page);
+    }
+    tpr[page].free = false;
+    tpr[page].runHead = first;
+  }
+
+  return first;
+}
+
 //-----------------------------------------------------------------
 // PhysicalMemManager::EvictPage
 //
@@ -192,7 +405,8 @@ PhysicalMemManager::EvictPage() {
 //-----------------------------------------------------------------
 // PhysicalMemManager::Print
 //
-/*! print the current status of the table of physical pages
+/*! print the current status of the table of physical pages, the pages
+//  never used being summed up on a single line
 //
 //  \param rpage number of real page
 */
@@ -203,7 +417,7 @@ PhysicalMemManager::Print(void) {
   uint64_t i;
 
   printf("Contents of TPR (%" PRIu64 " pages)\n", g_cfg->NumPhysPages);
-  for (i = 0; i < g_cfg->NumPhysPages; i++) {
+  for (i = 0; i < never_used; i++) {
     printf("Page %" PRIu64 " free=%d locked=%d virtpage=%" PRIu64
            " owner=%lx U=%d M=%d\n",
            i, tpr[i].free, tpr[i].locked, tpr[i].virtualPage,
@@ -215,4 +429,7 @@ PhysicalMemManager::Print(void) {
                ? tpr[i].owner->translationTable->getBitM(tpr[i].virtualPage)
                : 0);
   }
+  if (never_used < g_cfg->NumPhysPages)
+    printf("Pages %" PRIu64 " to %" PRIu64 " never used\n", never_used,
+           g_cfg->NumPhysPages - 1);
 }
@@ -44,6 +44,26 @@ class PhysicalMemManager;
    there is no page available. It requires an access to the thread list
    in order to choose which page will be swapped using the SwapManager
    class.
+
+   The cost of the manager does not depend on the number of physical
+   pages: the table of the physical pages is only backed by the host as
+   it gets used, and the pages are first allocated in increasing
+   order. The entries of the pages from never_used onwards are not
+   initialized yet, these pages are free. The pages freed later are
+   kept in a stack, chained by the nextFree field of their entries.
+
+   The pages handed out for anonymous memory (bss, stacks) must be
+   filled with zeroes. The manager knows which free pages already are:
+   the pages never used, and those it zeroes while the CPU would
+   otherwise be idle (RefillZeroPool), kept in a pool of at most
+   g_cfg->ZeroPoolSize pages. Zero-fill requests are served from them
+   first, the other requests from the pages freed since.
+
+   A superpage gets a run of g_cfg->SuperPageSize contiguous physical
+   pages, aligned on its size. The pages of a run know its first page
+   (runHead). A superpage is freed as a whole, and its run kept in a
+   stack of free runs; freeing a single page of a superpage (eviction)
+   splits it into single pages first.
 */
 //-----------------------------------------------------------------
 
@@ -58,13 +78,19 @@ public:
   void RemovePhysicalToVirtualMapping(
       uint64_t
           numPage);   //!< Frees the page and deletes the existing page mapping
+  void RemoveSuperPageMapping(
+      uint64_t numPage);   //!< Frees the run of pages of a superpage
   void ChangeOwner(uint64_t numPage,
                    Thread *owner);     //!< Change the page owner
   void UnlockPage(uint64_t numPage);   //!< Unlock physical page
+  void RefillZeroPool();               //!< Zero free pages ahead of time
   void Print(void);                    //!< Print the contents of a page
 
 private:
-  int FindFreePage();   //!< Return a free page if there is one
+  int FindFreePage(bool zero);   //!< Return a free page if there is one
+  int FindFreeRun(bool zero);    //!< Return a free run of pages if there is one
+  void ZeroPage(uint64_t numPage);   //!< Fill a free page with zeroes
+  void SplitRun(uint64_t numPage);   //!< Split the run of a superpage
   int EvictPage();      //!< Return a free page when there is none
 
   /*! \brief Describes the allocation of physical pages. Bits U
@@ -77,11 +103,23 @@ private:
     uint64_t virtualPage;   //!< Number of the virtualPage which references this
                             //!< real page
     AddrSpace *owner;       //!< Address space of the owner process
+    int64_t nextFree;       //!< Next page in the stack of freed pages
+                            //!< (or of free runs)
+    int64_t runHead;        //!< First page of the run of the page,
+                            //!< INVALID_PAGE if not in a run
+    bool zeroed;            //!< true if the page is free and known to
+                            //!< hold only zeroes
   };
 
   struct tpr_c *tpr;   //!< RealPage Array to know the state of each real page
 
-  Listint free_page_list;   //!< List of available (unused) real page numbers
+  int64_t free_stack;    //!< Last freed page, INVALID_PAGE if none
+  uint64_t never_used;   //!< First page never allocated so far
+  int64_t free_runs;     //!< First page of the last freed run,
+                         //!< INVALID_PAGE if none
+  int64_t zero_pool;     //!< Last page zeroed ahead of time,
+                         //!< INVALID_PAGE if none
+  uint64_t pool_size;    //!< Number of pages in the zero pool
 
   uint64_t i_clock;   //!< Index for clock_algorithm
 
@@ -37,8 +37,7 @@
 //-----------------------------------------------------------------
 SwapManager::SwapManager() {
 
-  swap_disk = new DriverDisk((char *) "sem swap disk",
-                             (char *) "lock swap disk", g_machine->diskSwap);
+  swap_disk = new DriverDisk((char *) "swap disk", g_machine->diskSwap);
   page_flags = new BitMap(NUM_SECTORS);
 }
 